@@ -1,6 +1,7 @@
 #include "Actuators.h"
+#include "Logger.h"
 
-Actuator::Actuator(String name, MessageID messID)
+Actuator::Actuator(const char *name, MessageID messID)
 {
     this->messID = messID;
     this->name = name;
@@ -38,8 +39,7 @@ Actuator_State Pavillon::Update()
     /*Serial.println("Pavillon");
     Serial.println(int(etat));
     Serial.println(String(currentOrder));*/
-    Serial.print("etat :");
-    Serial.println(int(etat));
+    LOG_DEBUGLN("etat :", int(etat));
     switch (etat)
     {
     case Actuator_State::NewMess:
@@ -112,11 +112,11 @@ void Bras::Init(uint8_t pinServo, MessageID ID, int posRentre, int posSortie)
     switch (messID)
     {
     case MessageID::BrasD_M:
-        name += "D";
+        name = "BrasD";
         break;
 
     case MessageID::BrasG_M:
-        name += "G";
+        name = "BrasG";
         break;
     
     default:
@@ -144,15 +144,15 @@ void Pince::Init(uint8_t pinServo, uint8_t pinDir, uint8_t pinStep, uint8_t pinS
     switch (messID)
     {
     case MessageID::PinceArr_M:
-        name += "Arr";
+        name = "PinceArr";
         break;
 
     case MessageID::PinceAvD_M:
-        name += "AvD";
+        name = "PinceAvD";
         break;
 
     case MessageID::PinceAvG_M:
-        name += "AvG";
+        name = "PinceAvG";
         break;
     
     default:
@@ -22,7 +22,7 @@ enum class Actuator_State
 class Actuator
 {
 public:
-    Actuator(String name = "Actuator", MessageID messID = MessageID::Empty_M);
+    Actuator(const char *name = "Actuator", MessageID messID = MessageID::Empty_M);
     
     // A appeler a chaque boucle, commande les actionneurs et mise a jour de l'etat.
     virtual Actuator_State Update();
@@ -33,12 +33,12 @@ public:
     // Genere le message de validation de l'action dedie au donneur d'ordre
     Message OrderCompleted(){return newMessage(messID,currentOrder,0,0,0);}
 
-    String GetName(){return name;}
+    const char *GetName(){return name;}
     Actuator_State GetEtat(){return etat;}
     Actuator_Order GetOrder(){return currentOrder;}
     MessageID GetID(){return messID;}
 protected:
-    String name;
+    const char *name; //Chaine constante
     Actuator_State etat;
     Actuator_Order currentOrder;
     MessageID messID = MessageID::Empty_M;
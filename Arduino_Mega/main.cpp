@@ -7,6 +7,9 @@
 #include "Communication.h"
 #include "Actuators.h"
 #include "Actuators_Manager.h"
+#include "Logger.h"
+#include "Clock.h"
+#include "Memory.h"
 
 #define DELAY 10
 uint32_t lastMillis = 0;
@@ -17,17 +20,20 @@ void setup()
 {
   Serial.begin(115200);
   Serial2.begin(115200);
+  Logger::setup(&Serial, &Serial, &Serial, false, true, false); //debug : true pour suivre l'etat des actionneurs
   Serial.println("STARTED");
+  Memory::print("boot");
   manager = new Manager(&Serial2, &Serial);
-  lastMillis = millis();
+  Memory::print("setup");
+  lastMillis = Clock::millis();
   
 }
 
 void loop()
 {
-  if (millis() - lastMillis > DELAY)
+  if (Clock::millis() - lastMillis > DELAY)
   {
-    lastMillis = millis();
+    lastMillis = Clock::millis();
 
     manager->Update();
   }
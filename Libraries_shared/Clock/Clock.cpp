@@ -0,0 +1,48 @@
+#include "Clock.h"
+
+static HardwareClock hardwareClock;
+Clock *Clock::current = &hardwareClock;
+
+void Clock::use(Clock *clock)
+{
+    current = (clock != nullptr) ? clock : &hardwareClock;
+}
+
+Clock *Clock::get()
+{
+    return current;
+}
+
+uint64_t HardwareClock::now()
+{
+    uint32_t raw = ::micros();
+    if (raw < lastRaw)
+        overflows++;
+    lastRaw = raw;
+    return ((uint64_t)overflows << 32) | raw;
+}
+
+VirtualClock::VirtualClock(uint64_t start)
+{
+    time = start;
+}
+
+uint64_t VirtualClock::now()
+{
+    return time;
+}
+
+void VirtualClock::advance(uint64_t us)
+{
+    time += us;
+}
+
+void VirtualClock::advanceSeconds(float seconds)
+{
+    time += (uint64_t)round(seconds * CLOCK_US_PER_S);
+}
+
+void VirtualClock::set(uint64_t us)
+{
+    time = us;
+}
@@ -0,0 +1,67 @@
+/**   Ensmasteel Library - Monotonic clock
+ * note : Toutes les decisions temporelles (timeouts, antispam, anti-rebond des erreurs, temps du match...) passent par Clock
+ *        plutot que par millis() : temps entier en microsecondes sur 64 bits (pas de perte de precision en fin de match,
+ *        pas de rebouclage), et horloge remplaçable par une VirtualClock pour simuler un match plus vite que le temps reel.
+ *        Les mesures de temps de calcul (bancs, profilage) restent sur l'horloge materielle.
+*/
+
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#include "Arduino.h"
+
+#define CLOCK_US_PER_S 1000000ULL
+
+class Clock
+{
+public:
+    virtual uint64_t now() = 0; // [...] = us, depuis le demarrage de l'horloge
+    virtual uint32_t nowFromISR() { return now(); } //Poids faible de now(), sans modifier l'horloge : appelable en interruption
+
+    // GOAL / Select the clock used by the whole program (HardwareClock by default)
+    // IN   / Clock *clock : must live as long as the program (static or global)
+    static void use(Clock *clock);
+    static Clock *get();
+
+    static inline uint64_t micros() { return current->now(); }
+    static inline uint32_t millis() { return current->now() / 1000; }
+    static inline uint32_t microsFromISR() { return current->nowFromISR(); } // [...] = us, reboucle toutes les 71 minutes
+    static inline float seconds() { return current->now() / (float)CLOCK_US_PER_S; } //Pour l'affichage : calculer les durées avec secondsSince
+    static inline float secondsSince(uint64_t start) { return (int64_t)(current->now() - start) / (float)CLOCK_US_PER_S; }
+
+private:
+    static Clock *current;
+};
+
+/*
+* micros() de l'arduino etendu a 64 bits (now doit etre appelé au moins une fois toutes les 71 minutes, hors interruption)
+*/
+class HardwareClock : public Clock
+{
+public:
+    uint64_t now();
+    uint32_t nowFromISR() { return ::micros(); }
+    constexpr HardwareClock() : lastRaw(0), overflows(0) {} //constexpr : utilisable par les constructeurs des objets globaux
+
+private:
+    uint32_t lastRaw;
+    uint32_t overflows;
+};
+
+/*
+* Horloge de simulation : n'avance que quand on le lui demande
+*/
+class VirtualClock : public Clock
+{
+public:
+    uint64_t now();
+    void advance(uint64_t us);
+    void advanceSeconds(float seconds);
+    void set(uint64_t us);
+    VirtualClock(uint64_t start = 0);
+
+private:
+    uint64_t time;
+};
+
+#endif // !CLOCK_H_
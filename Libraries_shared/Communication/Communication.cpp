@@ -2,14 +2,13 @@
 
 #include "Arduino.h"
 #include "Logger.h"
+#include "Clock.h"
 #ifdef TEENSY35
 #include <cstring>
 #else
 #include <string.h>
 #endif
 
-#define MESSAGE_BOX_SIZE 10 //Taille des boites d'envoie et reception
-
 typedef struct
 {
     uint8_t x;
@@ -96,26 +95,11 @@ Actuator_Order extractOrder(Message message){
 
 //////////Start MessageBox Class//////////
 
-class MessageBox
-{
-public:
-    Message pull();
-    Message peek();
-    void push(Message message);
-    int size();
-    bool empty = true;
-
-private:
-    Message box[MESSAGE_BOX_SIZE];
-    uint8_t iFirstEntry = 0;
-    uint8_t iNextEntry = 0;
-};
-
 Message MessageBox::pull()
 {
     if (empty)
     {
-        Logger::infoln("The mailbox is empty");
+        LOG_INFOLN("The mailbox is empty");
         //Dans ce cas on renvoie le message vide
         return newMessage(MessageID::Empty_M, 0);
     }
@@ -133,7 +117,7 @@ Message MessageBox::peek()
 {
     if (empty)
     {
-        Logger::infoln("The mailbox is empty");
+        LOG_INFOLN("The mailbox is empty");
         //Dans ce cas on renvoie le message vide
         return newMessage(MessageID::Empty_M, 0);
     }
@@ -144,7 +128,7 @@ Message MessageBox::peek()
 void MessageBox::push(Message message)
 {
     if ((iFirstEntry == iNextEntry) && !empty)
-        Logger::infoln("The mailbox is full");
+        LOG_INFOLN("The mailbox is full");
     //Dans ce cas on n'empile pas
     else
     {
@@ -174,7 +158,7 @@ void Communication::update()
 {
     //RECEPTION
     if (port->available()>0)
-        Logger::debugln(String(port->available())+" bytes available");
+        LOG_DEBUGLN(port->available()," bytes available");
     if (port->available() >= 6) //On attend de voir 6 octets dans le buffer pour lire le message entier d'un coup
     {
         uint8_t in[6];
@@ -182,65 +166,77 @@ void Communication::update()
             in[i] = port->read();
         Message out;
         memcpy(&out, in, sizeof(out)); //On convertit les octets en message
-        receiveBox->push(out);
+        receiveBox.push(out);
     }
     if (inWaitingRx()>0)
-        Logger::debugln("received ID " + String(extractID(peekOldestMessage())));
+        LOG_DEBUGLN("received ID ", extractID(peekOldestMessage()));
 
     //EMISSION
-    if (!sendingBox->empty && ((millis() - millisLastSend) > ANTISPAM_MS))
+    if (!sendingBox.empty && ((Clock::millis() - millisLastSend) > ANTISPAM_MS))
     {
-        Message toSend = sendingBox->pull();
+        Message toSend = sendingBox.pull();
         uint8_t out[6];
         memcpy(out, &toSend, sizeof(out)); //On convertit le message en octet
         for (int i = 0; i < 6; i++)
             port->write(out[i]);
-        millisLastSend = millis();
+        millisLastSend = Clock::millis();
     }
 }
 
 void Communication::send(Message message)
 {
-    sendingBox->push(message);
+    sendingBox.push(message);
+}
+
+void Communication::dump(MessageID id, const uint8_t *data, uint16_t size)
+{
+    Message header = newMessage(id, (int32_t)size);
+    uint8_t out[6];
+    memcpy(out, &header, sizeof(out));
+    port->write(out, sizeof(out));
+    port->write(data, size);
+    uint8_t checksum = 0;
+    for (uint16_t i = 0; i < size; i++)
+        checksum += data[i];
+    port->write(checksum);
 }
 
 void Communication::popOldestMessage()
 {
-    receiveBox->pull();
+    receiveBox.pull();
 }
 
 Message Communication::peekOldestMessage()
 {
-    return receiveBox->peek();
+    return receiveBox.peek();
 }
 
 uint8_t Communication::inWaitingRx()
 {
-    return receiveBox->size();
+    return receiveBox.size();
 }
 
 uint8_t Communication::inWaitingTx()
 {
-    return sendingBox->size();
+    return sendingBox.size();
 }
 
 Communication::Communication(Stream* port)
 {
     this->port=port;
-    this->receiveBox = new MessageBox();
-    this->sendingBox = new MessageBox();
     //On vide les caractères qui pourrait trainer
     while (port->available() > 0){
         port->read();
     }
-    millisLastSend = millis();
+    millisLastSend = Clock::millis();
 }
 
 void Communication::operator=(const Communication &other)
 {
     this->port=other.port;
-    this->receiveBox=new MessageBox();
-    this->sendingBox=new MessageBox();
+    this->millisLastSend=other.millisLastSend;
+    this->receiveBox=MessageBox(); //Boites vides : les messages ne sont pas dupliqués
+    this->sendingBox=MessageBox();
 }
 
 
@@ -248,7 +244,7 @@ void Communication::operator=(const Communication &other)
 void Communication::toTelemetry()
 {
     if (inWaitingRx()>0)
-        Logger::toTelemetry("messId",String(extractID(peekOldestMessage())));
+        LOG_TELEMETRY("messId",extractID(peekOldestMessage()));
 }
 
 //////////End Communication Class//////////
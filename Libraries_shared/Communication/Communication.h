@@ -2,14 +2,13 @@
 #define COMMUNICATION_H
 
 #define ANTISPAM_MS 300 //Nombre de milliseconde entre deux envoi de message
+#define MESSAGE_BOX_SIZE 10 //Taille des boites d'envoie et reception
 
 #include "Arduino.h"
 #include "MessageID.h"
 #include <Stream.h>
 #include "Vector.h"
 
-class MessageBox;
-
 struct FourBytes
 {
     uint8_t byte0,byte1,byte2,byte3;
@@ -32,23 +31,42 @@ int32_t extractInt32(Message message);
 Vector extractVectorE(Message message);
 Actuator_Order extractOrder(Message message);
 
+//File circulaire de messages (taille fixe, stockée dans la Communication : pas d'allocation)
+class MessageBox
+{
+public:
+    Message pull();
+    Message peek();
+    void push(Message message);
+    int size();
+    bool empty = true;
+
+private:
+    Message box[MESSAGE_BOX_SIZE];
+    uint8_t iFirstEntry = 0;
+    uint8_t iNextEntry = 0;
+};
+
 class Communication
 {
 public:
     void send(Message message); //Envoie un message sur le port de communication (Attention: Asynchrone)
+    //Envoie immediatement (sans antispam) un en-tete (id, size) suivi de size octets bruts et d'un octet de checksum (somme)
+    //A n'utiliser que hors du match : bloque le temps de l'envoi
+    void dump(MessageID id, const uint8_t *data, uint16_t size);
     void popOldestMessage(); //Supprime le dernier message de la boite de reception
     Message peekOldestMessage(); //Renvoie le message le plus ancien (sachant qu'a chaque tour, un message est supprimé de la boite au lettre)
     uint8_t inWaitingRx(); //Renvoie le nombre de message en attente dans la boite de reception
     uint8_t inWaitingTx(); //Renvoie le nombre de message en attente dans la boite d'envoie
     void update(); //Doit etre appelé régulièrement. Mets a jours les boites d'envoie et de reception
     Communication(Stream* port=&Serial); //port : Le port a utiliser pour les communications.
-    void operator=(const Communication &other); //Pour eviter d'avoir des pointeurs vers des variables locales...
+    void operator=(const Communication &other); //Copie le port, les boites de la copie sont vides
     void toTelemetry();
 
 private:
     Stream* port;
     uint32_t millisLastSend;
-    MessageBox* sendingBox;
-    MessageBox* receiveBox;
+    MessageBox sendingBox;
+    MessageBox receiveBox;
 };
 #endif
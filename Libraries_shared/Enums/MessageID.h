@@ -29,7 +29,14 @@ enum MessageID : uint16_t
     BrasD_M,        //[Teensy -> Mega]:     Rentrer ou sortir bras    | byte0 = Actuator_Order |
     PinceAvG_M,     //[Teensy -> Mega]:     Monter, Descendre, ouvrir, fermer pince    | byte0 = Actuator_Order |
     PinceAvD_M,     //[Teensy -> Mega]:     Monter, Descendre, ouvrir, fermer pince    | byte0 = Actuator_Order |
-    PinceArr_M      //[Teensy -> Mega]:     Monter, Descendre, ouvrir, fermer pince    | byte0 = Actuator_Order |
+    PinceArr_M,     //[Teensy -> Mega]:     Monter, Descendre, ouvrir, fermer pince    | byte0 = Actuator_Order |
+    Score_History_M,//[Aux -> Teensy]:      Demande l'historique des scores | [Teensy -> Aux]: en-tete du dump | DATA: taille du dump en octets
+    Profile_M,      //[Aux -> Teensy]:      Demande les temps d'execution (build PROFILING) | [Teensy -> Aux]: en-tete du dump | DATA: taille du dump en octets
+    Program_Begin_M,//[Aux -> Teensy]:      Debut d'un programme de sequence (cf Program.h) | byte0 = sequence | byte1..2 = taille | byte3 = flags |
+    Program_Chunk_M,//[Aux -> Teensy]:      Morceau du programme | byte0 = numero (modulo 256) | byte1..3 = octets du programme |
+    Program_End_M,  //[Aux -> Teensy]:      Fin du programme | DATA: CRC32 du programme
+    Program_Ack_M,  //[Teensy -> Aux]:      Resultat du televersement | byte0 = ProgramStatus | byte1..2 = adresse de l'instruction fautive |
+    __NBMESSAGES__
 };
 
 // Complements d'ordres //
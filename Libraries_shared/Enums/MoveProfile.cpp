@@ -1,16 +1,16 @@
 #include "MoveProfile.h"
-#define RATIOPID 1000.0
 #define mm 0.001
 #define s 1.0
 
 MoveProfile MoveProfiles::profiles[2 * __NBPROFILES__];
 
-void MoveProfile::set(float KP,float KI,float KD,float KA,float epsilon,float dEpsilon,float maxErr,float speedRamps,float cruisingSpeed)
+void MoveProfile::set(float KP,float KI,float KD,float KA,float epsilon,float dEpsilon,float maxErr,float speedRamps,float cruisingSpeed,float KF)
 {
     this->KP = KP/RATIOPID;
     this->KI = KI/RATIOPID;
     this->KD = KD/RATIOPID;
     this->KA = KA;
+    this->KF = KF;
     this->epsilon = epsilon;
     this->dEpsilon = dEpsilon;
     this->maxErr = maxErr;
@@ -21,11 +21,11 @@ void MoveProfile::set(float KP,float KI,float KD,float KA,float epsilon,float dE
 //un degré = 0.017 rad
 
 void MoveProfiles::setup() {
-    get(off,true)->set(0,0,0,1,100,100,100,0.001,0.001);
-    get(off,false)->set(0,0,0,1,100,100,100,0.003,0.003);
+    get(off,true)->set(0,0,0,1,100,100,100,0.001,0.001,0);
+    get(off,false)->set(0,0,0,1,100,100,100,0.003,0.003,0);
     
-    get(brake,true)->set(0,0,0.01,0,10,0.0005,100,0.001,0.001); //On est pas regardant quant a la position (monnitored by epsilon) mais on regarde la vitesse (monitored by dEpsilon)
-    get(brake,false)->set(0,0,0.01,0,10,0.01,100,0.003,0.003); //On est pas regardant quant a la position (monnitored by epsilon) mais on regarde la vitesse (monitored by dEpsilon)
+    get(brake,true)->set(0,0,0.01,0,10,0.0005,100,0.001,0.001,0); //On est pas regardant quant a la position (monnitored by epsilon) mais on regarde la vitesse (monitored by dEpsilon)
+    get(brake,false)->set(0,0,0.01,0,10,0.01,100,0.003,0.003,0); //On est pas regardant quant a la position (monnitored by epsilon) mais on regarde la vitesse (monitored by dEpsilon)
 
     get(accurate,true)->set(34000,0.01,0.01,1,1*mm,0.5*mm/s,20*mm,0.3,200*mm/s);
     get(accurate,false)->set(4500,0.01,0.01,1, 1*DEG_TO_RAD, 1*DEG_TO_RAD/s, 15*DEG_TO_RAD,1.5,90*DEG_TO_RAD/s);
@@ -44,6 +44,11 @@ MoveProfile* MoveProfiles::get(MoveProfileName name, bool translation) {
     return &profiles[2*(int)name + ((translation)?0:1)];
 }
 
+void MoveProfiles::setLaw(MoveProfileName name, ControlLaw law) {
+    get(name,true)->law = law;
+    get(name,false)->law = law;
+}
+
 float MoveProfiles::tweak(MoveProfile* profile,bool incr,int whichOne) {
     float coeff=(incr)?(1.10):(0.90);
     if (whichOne==0){
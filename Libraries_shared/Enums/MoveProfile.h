@@ -2,6 +2,8 @@
 #define MOVEPROFILE_H_
 #include "Arduino.h"
 
+#define RATIOPID 1000.0 //Les gains KP, KI, KD sont donnés x1000 dans MoveProfiles::setup
+
 enum MoveProfileName
 {
     off,
@@ -13,17 +15,27 @@ enum MoveProfileName
     __NBPROFILES__
 };
 
+//Loi de commande utilisée par Asservissement::compute pour ce profil
+enum ControlLaw
+{
+    PID_LAW, //PID + feedforward dynamique
+    MPC_LAW, //Commande predictive (cf MPC.h)
+    RAMSETE_LAW //Suivi non lineaire : corrige aussi l'erreur laterale (cf Asservissement::computeRamsete)
+};
+
 class MoveProfile
 {
 public:
     float KP, KI, KD, KA;        //Proportionel, Intégrateur, Dérivateur, Anticipateur
+    float KF;                //Part du feedforward dynamique (cf DynamicModel) ajoutée a la sortie du PID
     float epsilon, dEpsilon; //delta et delta de derivee en dessous de laquelle on considère qu'on est bon.
     float maxErr;            //Erreur maximal avant de considérer qu'on est trop loin.
     float speedRamps;   //Accélération/Deceleration en m.s-2 ou rad.s-2
     float cruisingSpeed; //Vitesse max en m/s ou rad/s
+    ControlLaw law = PID_LAW; //Seul celui de la translation est lu, pour les deux axes (cf Asservissement::compute et setLaw)
 
 private:
-    void set(float KP,float KI,float KD,float KA,float epsilon,float dEpsilon,float maxErr,float speedRamps,float cruisingSpeed);
+    void set(float KP,float KI,float KD,float KA,float epsilon,float dEpsilon,float maxErr,float speedRamps,float cruisingSpeed,float KF=1.0);
     friend class MoveProfiles;
 };
 
@@ -34,6 +46,7 @@ private:
 public:
     static void setup();
     static MoveProfile* get(MoveProfileName name, bool translation);
+    static void setLaw(MoveProfileName name, ControlLaw law); //Pour la translation et la rotation, gardées identiques
     static float tweak(MoveProfile* profile,bool incr,int whichOne);
 };
 
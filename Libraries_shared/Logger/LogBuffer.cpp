@@ -0,0 +1,153 @@
+#include "LogBuffer.h"
+
+#define LOG_BUFFER_MASK (LOG_BUFFER_SIZE - 1)
+#define LOG_ENDS_MASK (LOG_MAX_MESSAGES - 1)
+static_assert((LOG_BUFFER_SIZE & LOG_BUFFER_MASK) == 0, "LOG_BUFFER_SIZE must be a power of 2");
+static_assert((LOG_MAX_MESSAGES & LOG_ENDS_MASK) == 0 && LOG_MAX_MESSAGES <= 128, "LOG_MAX_MESSAGES must be a power of 2, at most 128");
+
+LogBuffer::LogBuffer(Print *port)
+{
+    this->port = port;
+    head = 0;
+    tail = 0;
+    writeIndex = 0;
+    endsHead = 0;
+    endsTail = 0;
+    partial = false;
+    inMessage = false;
+    discarding = false;
+    logClass = INFO_LOG;
+    policy = DROP_NEWEST;
+    resetStats();
+}
+
+void LogBuffer::resetStats()
+{
+    for (int i = 0; i < __NBLOGCLASSES__; i++)
+        droppedMessages[i] = 0;
+    evictedMessages = 0;
+    highWater = 0;
+}
+
+uint16_t LogBuffer::pending()
+{
+    return (uint16_t)(head - tail);
+}
+
+int LogBuffer::availableForWrite()
+{
+    return LOG_BUFFER_SIZE - (uint16_t)(writeIndex - tail);
+}
+
+void LogBuffer::beginMessage(LogClass logClass, LogPolicy policy)
+{
+    this->logClass = logClass;
+    this->policy = policy;
+    writeIndex = head; //Un message precedent non terminé est abandonné
+    inMessage = true;
+    discarding = false;
+}
+
+void LogBuffer::endMessage()
+{
+    if (!discarding)
+        publish(); //Publication du message entier
+    inMessage = false;
+    discarding = false;
+}
+
+void LogBuffer::publish()
+{
+    if (writeIndex == head)
+        return;
+    ends[endsHead & LOG_ENDS_MASK] = writeIndex;
+    endsHead++;
+    head = writeIndex;
+}
+
+bool LogBuffer::hasRoom(uint16_t size)
+{
+    return availableForWrite() >= size && (uint8_t)(endsHead - endsTail) < LOG_MAX_MESSAGES;
+}
+
+bool LogBuffer::makeRoom(uint16_t size)
+{
+    if (size > LOG_BUFFER_SIZE)
+        return false;
+    switch (policy)
+    {
+    case DROP_OLDEST:
+        //On ne peut écraser que des messages publiés, pas celui que drain a commencé a envoyer
+        while (!hasRoom(size) && endsTail != endsHead && !partial)
+        {
+            tail = ends[endsTail & LOG_ENDS_MASK];
+            endsTail++;
+            evictedMessages++;
+        }
+        break;
+    case BLOCK:
+    {
+        uint32_t start = micros(); //Temps reel : on attend le port serie, pas le match
+        while (!hasRoom(size) && endsTail != endsHead && micros() - start < LOG_BLOCK_TIMEOUT)
+            drain();
+        break;
+    }
+    case DROP_NEWEST:
+    default:
+        break;
+    }
+    return hasRoom(size);
+}
+
+size_t LogBuffer::write(const uint8_t *data, size_t size)
+{
+    if (discarding)
+        return size; //Le reste d'un message abandonné
+    if (!hasRoom(size) && !makeRoom(size))
+    {
+        droppedMessages[logClass]++;
+        writeIndex = head;
+        discarding = inMessage; //Hors message, seule cette ecriture est perdue
+        return size;
+    }
+    for (size_t i = 0; i < size; i++)
+        buffer[(writeIndex++) & LOG_BUFFER_MASK] = data[i];
+    highWater = max(highWater, (uint16_t)(writeIndex - tail));
+    if (!inMessage)
+        publish(); //Ecriture hors message : un message a elle seule
+    return size;
+}
+
+size_t LogBuffer::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+uint16_t LogBuffer::drain()
+{
+    int room = port->availableForWrite();
+    uint16_t sent = 0;
+    while (endsTail != endsHead && room > 0)
+    {
+        uint16_t end = ends[endsTail & LOG_ENDS_MASK];
+        uint16_t length = end - tail; //Reste du plus vieux message (un long message peut etre deja entamé)
+        if (length > room)
+        {
+            if (length <= LOG_ATOMIC_MAX)
+                break; //On attend que le message entier passe
+            length = room;
+        }
+        uint16_t start = tail & LOG_BUFFER_MASK;
+        uint16_t first = min(length, (uint16_t)(LOG_BUFFER_SIZE - start)); //L'anneau reboucle
+        port->write(buffer + start, first);
+        if (first < length)
+            port->write(buffer, length - first);
+        tail += length;
+        partial = (tail != end);
+        if (!partial)
+            endsTail++;
+        room -= length;
+        sent += length;
+    }
+    return sent;
+}
@@ -0,0 +1,91 @@
+/**   Ensmasteel Library - Non blocking output of the Logger
+ * note : Anneau d'octets entre le Logger (producteur) et le port serie (consommateur) : les logs ne bloquent plus la boucle de controle
+ *        quand le buffer d'emission du port (USB, HC05) est plein.
+ *        Le Logger ecrit un message entier entre beginMessage et endMessage : il n'est publié (visible par drain) qu'a la fin,
+ *        un message qui ne rentre pas est donc abandonné en entier, jamais coupé.
+ *        La fin de chaque message publié est gardée dans un second anneau (ends) : les messages binaires (LOG_BINARY) peuvent
+ *        contenir des '\n', les frontieres ne sont jamais cherchées dans les octets.
+ *        drain() n'envoie que ce que port->availableForWrite() accepte, par messages entiers tant qu'ils font
+ *        moins de LOG_ATOMIC_MAX octets : une trame de Communication sur le meme port ne s'intercale pas au milieu d'un message.
+ *        Un seul producteur (tete) et un seul consommateur (queue), indices libres sur 16 bits, taille en puissance de 2 :
+ *        pas de verrou. Seul DROP_OLDEST fait avancer la queue depuis le producteur, drain ne doit donc pas etre appelé
+ *        depuis une interruption (c'est une tache du Scheduler).
+*/
+
+#ifndef LOGBUFFER_H_
+#define LOGBUFFER_H_
+
+#include "Arduino.h"
+#include <Print.h>
+
+#ifdef __AVR__
+#define LOG_BUFFER_SIZE 256    //Puissance de 2
+#define LOG_MAX_MESSAGES 16    //Puissance de 2, messages publiés en attente au plus
+#else
+#define LOG_BUFFER_SIZE 4096   //Puissance de 2
+#define LOG_MAX_MESSAGES 128   //Puissance de 2, messages publiés en attente au plus
+#endif
+#define LOG_ATOMIC_MAX 64      // [...] = octets, plus petit buffer d'emission des ports (UART de la Mega, paquet USB)
+#define LOG_BLOCK_TIMEOUT 2000 // [...] = us, attente maximale d'un message BLOCK avant de l'abandonner
+
+enum LogClass
+{
+    TELEMETRY_LOG,
+    INFO_LOG,
+    DEBUG_LOG,
+    __NBLOGCLASSES__
+};
+
+enum LogPolicy
+{
+    DROP_OLDEST, //Les plus vieux messages non envoyés sont écrasés (telemetrie : seule la derniere valeur compte)
+    DROP_NEWEST, //Le nouveau message est abandonné (l'historique deja en attente reste dans l'ordre)
+    BLOCK        //On vide l'anneau sur le port jusqu'a avoir la place (au plus LOG_BLOCK_TIMEOUT) : messages critiques, hors boucle de controle
+};
+
+class LogBuffer : public Print
+{
+public:
+    uint32_t droppedMessages[__NBLOGCLASSES__]; //Messages abandonnés (DROP_NEWEST, BLOCK trop long, message plus grand que l'anneau)
+    uint32_t evictedMessages;                   //Messages écrasés par DROP_OLDEST
+    uint16_t highWater;                         // [...] = octets, remplissage maximal
+
+    size_t write(uint8_t c);
+    size_t write(const uint8_t *buffer, size_t size);
+    using Print::write;
+    int availableForWrite();
+
+    // GOAL / Frame a message of the Logger : nothing is visible by drain before endMessage
+    // IN   / LogClass logClass : for the counters
+    //        LogPolicy policy : what to do if the message does not fit
+    void beginMessage(LogClass logClass, LogPolicy policy);
+    void endMessage();
+
+    // GOAL / Send on the port what it can accept without blocking
+    // OUT  / uint16_t : number of bytes sent
+    uint16_t drain();
+
+    uint16_t pending(); // [...] = octets publiés, pas encore envoyés
+    void resetStats();
+
+    LogBuffer(Print *port);
+
+private:
+    Print *port;
+    uint8_t buffer[LOG_BUFFER_SIZE];
+    volatile uint16_t head; //Fin des messages publiés (ecrit par le producteur)
+    volatile uint16_t tail; //Prochain octet a envoyer (ecrit par drain, et par DROP_OLDEST)
+    uint16_t writeIndex;    //Fin du message en cours d'ecriture (producteur seulement)
+    uint16_t ends[LOG_MAX_MESSAGES]; //Fin (indice libre) de chaque message publié, du plus vieux au plus recent
+    volatile uint8_t endsHead, endsTail;
+    bool partial;           //Le plus vieux message est entamé sur le port (plus long que LOG_ATOMIC_MAX) : DROP_OLDEST ne le coupe pas
+    bool inMessage, discarding;
+    LogClass logClass;
+    LogPolicy policy;
+
+    bool hasRoom(uint16_t size); //Octets et une frontiere libres
+    bool makeRoom(uint16_t size);
+    void publish();              //Le message jusqu'a writeIndex devient visible par drain
+};
+
+#endif // !LOGBUFFER_H_
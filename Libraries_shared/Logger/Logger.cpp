@@ -8,30 +8,10 @@ bool Logger::telemetryEnabled;
 bool Logger::infoEnabled;
 bool Logger::debugEnabled;
 
-void Logger::debug(const String &message)
-{
-    if (debugEnabled)
-        debugPort->print(message);
-}
-
-void Logger::debugln(const String &message)
-{
-    if (debugEnabled)
-        debugPort->println(message);
-}
-
-void Logger::toTelemetry(const String &name, const String &value) 
-{
-    if (telemetryEnabled)
-        telemetryPort->print("@"+name+"|"+value+"\n");
-}
-
-void Logger::infoln(const String &message)
-{
-    if (infoEnabled)
-        infoPort->print("#"+message+"\n");
-}
-
+LogBuffer* Logger::telemetryBuffer = nullptr;
+LogBuffer* Logger::infoBuffer = nullptr;
+LogBuffer* Logger::debugBuffer = nullptr;
+LogPolicy Logger::policies[__NBLOGCLASSES__] = {DROP_OLDEST, DROP_NEWEST, DROP_NEWEST};
 
 void Logger::setup(Print* telemetryPort_,Print* infoPort_,Print* debugPort_,bool telemetry,bool info,bool debug)
 {
@@ -41,4 +21,20 @@ void Logger::setup(Print* telemetryPort_,Print* infoPort_,Print* debugPort_,bool
     telemetryEnabled=telemetry;
     infoEnabled=info;
     debugEnabled=debug;
+    telemetryBuffer=nullptr;
+    infoBuffer=nullptr;
+    debugBuffer=nullptr;
+}
+
+void Logger::setup(LogBuffer* telemetryBuffer_,LogBuffer* infoBuffer_,LogBuffer* debugBuffer_,bool telemetry,bool info,bool debug)
+{
+    setup((Print*)telemetryBuffer_,(Print*)infoBuffer_,(Print*)debugBuffer_,telemetry,info,debug);
+    telemetryBuffer=telemetryBuffer_;
+    infoBuffer=infoBuffer_;
+    debugBuffer=debugBuffer_;
+}
+
+void Logger::setPolicy(LogClass logClass, LogPolicy policy)
+{
+    policies[logClass]=policy;
 }
\ No newline at end of file
@@ -6,13 +6,34 @@ Pour faire un message d'info
 Logger::infoln("That's what she said")
 
 Et pour rajouter une variable a la telemetry
-Logger::toTelemetry("dickSize",String(dick->size))
+Logger::toTelemetry("dickSize",dick->size)
+
+Les messages sont une liste de morceaux imprimés a la suite (texte, entiers, flottants), sans String ni allocation :
+LOG_INFOLN("Action ", index, " failed (", name, ")");
+Pour choisir le nombre de decimales d'un flottant : decimals(x, 4) (2 par defaut, comme String(x))
 
 En sortie:
 Entre un # et un \n tu as un message informatif
 Entre un @ et un | tu as un nom de parametre
 Entre un | et un \n tu as sa valeur
 Tout ce qui est avant un @ ou un # est du debug
+
+Dans le code du match, preferer les macros LOG_DEBUG, LOG_DEBUGLN, LOG_INFOLN, LOG_TELEMETRY :
+les arguments ne sont evalués que si le niveau est actif.
+Un niveau au dessus de LOG_LEVEL (build_flags = -DLOG_LEVEL=LOG_LEVEL_INFO par ex.) ne compile rien du tout,
+les niveaux en dessous restent activables a l'execution (Logger::setup).
+
+Avec -DLOG_BINARY (env teensy35_binlog), les macros n'envoient plus de texte mais une trame LogFrame : l'identifiant 16 bits
+du message (hash de "fonction:" + texte brut des arguments de la macro, calculé a la compilation) puis les arguments qui ne sont pas des chaines litterales.
+Le nom d'une telemetrie fait partie de l'identifiant, meme quand son prefixe est un parametre (LOG_TELEMETRY(prefix, "x", _x) de Vector::toTelemetry) :
+le prefixe est haché avec le message au lieu d'etre envoyé. Il doit alors etre une chaine litterale passée a une methode toTelemetry("R")
+pour que tools/extract_logs.py le connaisse.
+tools/extract_logs.py construit le dictionnaire identifiant -> format a la compilation, tools/decode_logs.py refait le texte sur PC.
+Les appels directs a Logger::infoln... (rapports du Scheduler, du Profiler) restent en texte.
+Un tableau de char qui n'est pas une chaine litterale doit etre passé en (const char *).
+
+Pour ne jamais bloquer sur le port serie, passer des LogBuffer a Logger::setup (cf LogBuffer.h) et appeler LogBuffer::drain
+regulierement : chaque classe de message (telemetrie, info, debug) a sa politique quand l'anneau est plein (Logger::setPolicy).
 */
 
 
@@ -20,8 +41,201 @@ Tout ce qui est avant un @ ou un # est du debug
 #define LOGGER_H_
 #include <Print.h>
 #include "Arduino.h"
+#include "LogBuffer.h"
+#include <string.h>
+
+#define nameValue(a) #a "= ", (a) //A utiliser dans un message : LOG_DEBUGLN(nameValue(x));
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_TELEMETRY 2
+#define LOG_LEVEL_DEBUG 3
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+#ifdef LOG_BINARY
+#define LOG_MESSAGE(enabled, logClass, kind, text, ...) do { if (Logger::enabled()) { constexpr uint32_t logState = logFnv(text); Logger::binary(logClass, logState, __VA_ARGS__); } } while (0)
+#else
+#define LOG_MESSAGE(enabled, logClass, kind, text, ...) do { if (Logger::enabled()) Logger::kind(__VA_ARGS__); } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) LOG_MESSAGE(isDebugEnabled, DEBUG_LOG, debug, "debug:" #__VA_ARGS__, __VA_ARGS__)
+#define LOG_DEBUGLN(...) LOG_MESSAGE(isDebugEnabled, DEBUG_LOG, debugln, "debugln:" #__VA_ARGS__, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do { } while (0)
+#define LOG_DEBUGLN(...) do { } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_TELEMETRY
+#define LOG_TELEMETRY(...) LOG_MESSAGE(isTelemetryEnabled, TELEMETRY_LOG, toTelemetry, "toTelemetry:" #__VA_ARGS__, __VA_ARGS__)
+#else
+#define LOG_TELEMETRY(...) do { } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFOLN(...) LOG_MESSAGE(isInfoEnabled, INFO_LOG, infoln, "infoln:" #__VA_ARGS__, __VA_ARGS__)
+#else
+#define LOG_INFOLN(...) do { } while (0)
+#endif
+
+/*
+* Flottant imprimé avec un nombre de decimales choisi (remplace String(value, digits))
+*/
+struct Decimals
+{
+    double value;
+    uint8_t digits;
+};
+
+inline Decimals decimals(double value, uint8_t digits)
+{
+    Decimals out;
+    out.value = value;
+    out.digits = digits;
+    return out;
+}
+
+//========================================LOG BINAIRE========================================
+#define LOG_FRAME_SYNC 0xF5 //Jamais dans un texte ASCII
+#define LOG_FRAME_HEADER 4  //Sync, identifiant (2 octets), taille des arguments
+#define LOG_FRAME_MAX 64    //Les arguments au dela sont coupés
+#define LOG_NAME_SEPARATOR '@' //Entre le texte du message et le prefixe d'un nom de telemetrie haché (meme valeur dans tools/extract_logs.py)
+
+constexpr uint32_t logFnv(const char *text, uint32_t hash = 2166136261UL)
+{
+    return (*text == 0) ? hash : logFnv(text + 1, (hash ^ (uint8_t)*text) * 16777619UL);
+}
+
+constexpr uint16_t logFold(uint32_t hash)
+{
+    return (uint16_t)(hash ^ (hash >> 16));
+}
+
+//Identifiant d'un message : FNV-1a 32 bits replié sur 16 bits (meme calcul dans tools/extract_logs.py)
+constexpr uint16_t logHash(const char *text)
+{
+    return logFold(logFnv(text));
+}
+
+/*
+* Trame d'un message binaire, little endian :
+*   [0] LOG_FRAME_SYNC  [1..2] identifiant  [3] taille des arguments
+*   puis pour chaque argument un type et sa valeur, dans la forme la plus courte :
+*   'b' int8, 'h' int16, 'i' int32, 'u' uint32 (entiers)
+*   'A'..'J' int16 = valeur * 10^n a afficher avec n decimales, '0'..'9' float avec n decimales (s'il ne rentre pas dans un int16)
+*   'c' char, 's' longueur (1 octet) + caracteres ('f' float, 2 decimales : ancien format, toujours decodé)
+*   et enfin '\n' : une trame est une ligne pour LogBuffer (jamais coupée) et le decodeur verifie qu'il est bien calé.
+* Les chaines litterales sont dans le dictionnaire et ne sont pas envoyées. 0xF5 n'apparait jamais dans du texte UTF-8.
+* Une trame pleine (LOG_FRAME_MAX) perd ses derniers arguments, le decodeur affiche "?" a leur place.
+*/
+class LogFrame
+{
+public:
+    LogFrame(uint16_t id)
+    {
+        frame[0] = LOG_FRAME_SYNC;
+        frame[1] = id & 0xFF;
+        frame[2] = id >> 8;
+        size = LOG_FRAME_HEADER;
+        full = false;
+    }
 
-#define nameValue(a) #a+"= "+String(a)
+    template <size_t N>
+    void add(const char (&)[N]) {} //Chaine litterale : deja dans le dictionnaire
+    template <typename C>
+    void add(const C *const &text)
+    {
+        uint8_t length = strnlen((const char *)text, LOG_FRAME_MAX);
+        length = min(length, (uint8_t)max(LOG_FRAME_MAX - 1 - size - 2, 0));
+        put('s', &length, 1);
+        put(0, text, length);
+    }
+    void add(const Decimals &number)
+    {
+        static const float scales[10] = {1, 10, 100, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+        uint8_t digits = min(number.digits, (uint8_t)9);
+        float value = number.value;
+        float scaled = value * scales[digits];
+        if (scaled > -32767.5f && scaled < 32767.5f) //Faux aussi pour NaN
+        {
+            int16_t fixed = (scaled >= 0) ? scaled + 0.5f : scaled - 0.5f;
+            put('A' + digits, &fixed, sizeof(fixed));
+        }
+        else
+            put('0' + digits, &value, sizeof(value));
+    }
+    void add(double number) { add(decimals(number, 2)); } //2 decimales, comme Print
+    void add(float number) { add(decimals(number, 2)); }
+    void add(char character) { put('c', &character, 1); }
+    void add(bool number) { add((unsigned long)number); }
+    void add(signed char number) { add((long)number); }
+    void add(short number) { add((long)number); }
+    void add(int number) { add((long)number); }
+    void add(long number)
+    {
+        int32_t value = number;
+        if (value >= -128 && value <= 127)
+        {
+            int8_t small = value;
+            put('b', &small, 1);
+        }
+        else if (value >= -32768 && value <= 32767)
+        {
+            int16_t medium = value;
+            put('h', &medium, sizeof(medium));
+        }
+        else
+            put('i', &value, sizeof(value));
+    }
+    void add(long long number) { add((long)number); }
+    void add(unsigned char number) { add((unsigned long)number); }
+    void add(unsigned short number) { add((unsigned long)number); }
+    void add(unsigned int number) { add((unsigned long)number); }
+    void add(unsigned long number)
+    {
+        uint32_t value = number;
+        if (value <= 32767)
+            add((long)value);
+        else
+            put('u', &value, sizeof(value));
+    }
+    void add(unsigned long long number) { add((unsigned long)number); }
+
+    inline void addAll() {}
+    template <typename T, typename... Rest>
+    inline void addAll(const T &part, const Rest &... rest)
+    {
+        add(part);
+        addAll(rest...);
+    }
+
+    void send(Print *port)
+    {
+        frame[3] = size - LOG_FRAME_HEADER;
+        frame[size] = '\n';
+        port->write(frame, size + 1);
+    }
+
+private:
+    uint8_t frame[LOG_FRAME_MAX];
+    uint8_t size;
+    bool full;
+
+    void put(uint8_t type, const void *data, uint8_t length)
+    {
+        if (full || size + length + (type != 0) > LOG_FRAME_MAX - 1) //Place du '\n'
+        {
+            full = true; //Les arguments suivants sont perdus aussi, pour ne pas les decaler
+            return;
+        }
+        if (type != 0)
+            frame[size++] = type;
+        memcpy(frame + size, data, length);
+        size += length;
+    }
+};
 
 
 class Logger
@@ -35,21 +249,141 @@ private:
     static bool infoEnabled;
     static bool debugEnabled;
 
+    static LogBuffer* telemetryBuffer;      //nullptr si le port est ecrit directement
+    static LogBuffer* infoBuffer;
+    static LogBuffer* debugBuffer;
+    static LogPolicy policies[__NBLOGCLASSES__];
+
+    static inline void beginMessage(LogBuffer *buffer, LogClass logClass)
+    {
+        if (buffer != nullptr)
+            buffer->beginMessage(logClass, policies[logClass]);
+    }
+    static inline void endMessage(LogBuffer *buffer)
+    {
+        if (buffer != nullptr)
+            buffer->endMessage();
+    }
+
+    static inline void printPart(Print *port, const Decimals &part) { port->print(part.value, part.digits); }
+    template <typename T>
+    static inline void printPart(Print *port, const T &part) { port->print(part); }
+
+    static inline void printParts(Print *) {}
+    template <typename T, typename... Rest>
+    static inline void printParts(Print *port, const T &part, const Rest &... rest)
+    {
+        printPart(port, part);
+        printParts(port, rest...);
+    }
+
+    template <typename... Parts>
+    static void sendFrame(LogClass logClass, uint16_t id, const Parts &... parts)
+    {
+        Print *ports[__NBLOGCLASSES__] = {telemetryPort, infoPort, debugPort};
+        LogBuffer *buffers[__NBLOGCLASSES__] = {telemetryBuffer, infoBuffer, debugBuffer};
+        LogFrame frame(id);
+        frame.addAll(parts...);
+        beginMessage(buffers[logClass], logClass);
+        frame.send(ports[logClass]);
+        endMessage(buffers[logClass]);
+    }
+
 public:
     //Affiche un message d'une pertinance approximative sur le debugPort
-    static void debug(const String& message);
+    template <typename... Parts>
+    static void debug(const Parts &... parts)
+    {
+        if (debugEnabled)
+        {
+            beginMessage(debugBuffer, DEBUG_LOG);
+            printParts(debugPort, parts...);
+            endMessage(debugBuffer);
+        }
+    }
 
     //Affiche un message d'une pertinance approximative sur le debugPort et passe a la ligne
-    static void debugln(const String& message);
+    template <typename... Parts>
+    static void debugln(const Parts &... parts)
+    {
+        if (debugEnabled)
+        {
+            beginMessage(debugBuffer, DEBUG_LOG);
+            printParts(debugPort, parts..., '\n');
+            endMessage(debugBuffer);
+        }
+    }
 
     //Affiche un message important sur le infoPort et passe a la ligne (obligatoire)
-    static void infoln(const String& message);
+    template <typename... Parts>
+    static void infoln(const Parts &... parts)
+    {
+        if (infoEnabled)
+        {
+            beginMessage(infoBuffer, INFO_LOG);
+            printParts(infoPort, '#', parts..., '\n');
+            endMessage(infoBuffer);
+        }
+    }
 
     //Envoie un parametre nommé a la telemetry
-    static void toTelemetry(const String& name, const String& value);           
+    template <typename T>
+    static void toTelemetry(const char *name, const T &value)
+    {
+        if (telemetryEnabled)
+        {
+            beginMessage(telemetryBuffer, TELEMETRY_LOG);
+            printParts(telemetryPort, '@', name, '|', value, '\n');
+            endMessage(telemetryBuffer);
+        }
+    }
+
+    //Envoie un parametre dont le nom est en deux morceaux (prefixe + suffixe ou indice) : toTelemetry("R", "x", 0.5) => @Rx|0.50
+    template <typename N, typename T>
+    static void toTelemetry(const char *prefix, const N &suffix, const T &value)
+    {
+        if (telemetryEnabled)
+        {
+            beginMessage(telemetryBuffer, TELEMETRY_LOG);
+            printParts(telemetryPort, '@', prefix, suffix, '|', value, '\n');
+            endMessage(telemetryBuffer);
+        }
+    }
+
+    //Envoie une trame LogFrame (macros LOG_ avec -DLOG_BINARY), state : logFnv du texte du message
+    template <typename... Parts>
+    static void binary(LogClass logClass, uint32_t state, const Parts &... parts)
+    {
+        sendFrame(logClass, logFold(state), parts...);
+    }
+
+    //Telemetrie dont le nom commence par un parametre (pas une chaine litterale) : le prefixe est haché dans l'identifiant au lieu d'etre envoyé
+    template <typename C, typename... Parts>
+    static void binary(LogClass logClass, uint32_t state, const C *const &prefix, const Parts &... parts)
+    {
+        if (logClass != TELEMETRY_LOG)
+        {
+            sendFrame(logClass, logFold(state), prefix, parts...);
+            return;
+        }
+        state = (state ^ (uint8_t)LOG_NAME_SEPARATOR) * 16777619UL;
+        for (const char *c = (const char *)prefix; *c != 0; c++)
+            state = (state ^ (uint8_t)*c) * 16777619UL;
+        sendFrame(logClass, logFold(state), parts...);
+    }
+
+    static inline bool isDebugEnabled() { return debugEnabled; }
+    static inline bool isInfoEnabled() { return infoEnabled; }
+    static inline bool isTelemetryEnabled() { return telemetryEnabled; }
 
     //Attention, les port doivent déja être ouvert avant d'etre passé en argument de cette fonction
     static void setup(Print* telemetryPort=&Serial,Print* infoPort=&Serial,Print* debugPort=&Serial,bool telemetry=true,bool info=true,bool debug=false);
+
+    //Meme chose a travers des anneaux non bloquants (drain a appeler regulierement)
+    static void setup(LogBuffer* telemetryBuffer,LogBuffer* infoBuffer,LogBuffer* debugBuffer,bool telemetry=true,bool info=true,bool debug=false);
+
+    //Que faire d'un message qui ne rentre pas dans son LogBuffer. Par defaut : telemetrie DROP_OLDEST, info et debug DROP_NEWEST
+    static void setPolicy(LogClass logClass, LogPolicy policy);
 };
 
 #endif // !LOGGER_H_
\ No newline at end of file
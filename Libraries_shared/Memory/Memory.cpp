@@ -0,0 +1,50 @@
+#include "Memory.h"
+#include "Logger.h"
+
+#if defined(__AVR__)
+struct __freelist
+{
+    size_t sz;
+    struct __freelist *nx;
+};
+extern char *__brkval;
+extern char __heap_start;
+extern struct __freelist *__flp;
+#elif defined(__arm__)
+#include <malloc.h>
+extern "C" char *sbrk(int incr);
+#endif
+
+MemoryStatus Memory::status()
+{
+    MemoryStatus out;
+    out.freeRam = 0;
+    out.heapUsed = 0;
+    out.heapFree = 0;
+    out.freeBlocks = 0;
+#if defined(__AVR__)
+    char top;
+    char *heapEnd = (__brkval == nullptr) ? &__heap_start : __brkval;
+    for (struct __freelist *block = __flp; block != nullptr; block = block->nx)
+    {
+        out.heapFree += block->sz + sizeof(size_t);
+        out.freeBlocks++;
+    }
+    out.freeRam = &top - heapEnd;
+    out.heapUsed = heapEnd - &__heap_start - out.heapFree;
+#elif defined(__arm__)
+    char top;
+    struct mallinfo info = mallinfo();
+    out.freeRam = &top - sbrk(0);
+    out.heapUsed = info.uordblks;
+    out.heapFree = info.fordblks;
+    out.freeBlocks = info.ordblks;
+#endif
+    return out;
+}
+
+void Memory::print(const char *when)
+{
+    MemoryStatus memory = status();
+    Logger::infoln("RAM ", when, " : free ", memory.freeRam, " heap used ", memory.heapUsed, " heap holes ", memory.heapFree, " in ", memory.freeBlocks, " blocks");
+}
@@ -0,0 +1,39 @@
+/**   Ensmasteel Library - Free RAM and heap fragmentation report
+ * note : Photo de la RAM a un instant donné, sur les deux cartes :
+ *          freeRam    : octets libres entre le haut du tas et la pile
+ *          heapUsed   : octets alloués dans le tas
+ *          heapFree   : octets libres a l'interieur du tas (trous laissés par les free, reutilisables seulement par des blocs plus petits)
+ *          freeBlocks : nombre de trous. Beaucoup de petits trous = tas fragmenté
+ *        Sur la teensy, heapUsed/heapFree/freeBlocks viennent de mallinfo, sur la Mega de la liste libre d'avr-libc.
+ *        Sur PC (outils hors ligne, -DHOST) tout reste a 0 : le tas du PC ne dit rien de celui des cartes (MEMORY_MEASURED non defini).
+ *        Un firmware sans allocation apres setup doit garder les memes valeurs tout le match.
+*/
+
+#ifndef MEMORY_H_
+#define MEMORY_H_
+
+#include "Arduino.h"
+
+#if defined(__AVR__) || defined(__arm__)
+#define MEMORY_MEASURED
+#endif
+
+struct MemoryStatus
+{
+    uint32_t freeRam;
+    uint32_t heapUsed;
+    uint32_t heapFree;
+    uint16_t freeBlocks;
+};
+
+class Memory
+{
+public:
+    static MemoryStatus status();
+
+    // GOAL / Print the status on Logger::info
+    // IN   / const char *when : label of the report ("boot", "setup"...)
+    static void print(const char *when);
+};
+
+#endif // !MEMORY_H_
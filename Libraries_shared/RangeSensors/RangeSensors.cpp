@@ -0,0 +1,106 @@
+#include "RangeSensors.h"
+#include "Clock.h"
+#ifdef TEENSY35
+#include <cstring>
+#else
+#include <string.h>
+#endif
+
+static uint8_t rangeChecksum(const uint8_t *frame)
+{
+    uint8_t sum = 0;
+    for (int i = 2; i < RANGE_FRAME_SIZE - 1; i++)
+        sum += frame[i];
+    return sum;
+}
+
+void encodeRangeFrame(uint8_t *frame, uint8_t id, uint16_t distance, uint16_t timestamp)
+{
+    frame[0] = RANGE_SYNC_0;
+    frame[1] = RANGE_SYNC_1;
+    frame[2] = id;
+    frame[3] = distance & 0xFF;
+    frame[4] = distance >> 8;
+    frame[5] = timestamp & 0xFF;
+    frame[6] = timestamp >> 8;
+    frame[7] = rangeChecksum(frame);
+}
+
+RangeSensors::RangeSensors(Stream *port)
+{
+    this->port = port;
+    this->received = 0;
+    this->nbFrames = 0;
+    this->nbChecksumErrors = 0;
+    memset(readings, 0, sizeof(readings));
+    for (int i = 0; i < RANGE_NB_SENSORS; i++)
+        sectors[i] = (i % 2 == 0) ? FORWARD_SECTOR : BACKWARD_SECTOR; //Comme l'ancien protocole : 'f' = capteur 0, 'b' = capteur 1
+}
+
+void RangeSensors::update()
+{
+    int budget = min(port->available(), RANGE_MAX_BYTES_PER_UPDATE);
+    uint32_t now = Clock::millis();
+    for (int n = 0; n < budget; n++)
+    {
+        uint8_t c = port->read();
+        if ((received == 0 && c != RANGE_SYNC_0) || (received == 1 && c != RANGE_SYNC_1))
+        {
+            received = (c == RANGE_SYNC_0) ? 1 : 0;
+            continue;
+        }
+        frame[received++] = c;
+        if (received == RANGE_FRAME_SIZE)
+            decode(now);
+    }
+}
+
+void RangeSensors::decode(uint32_t now)
+{
+    received = 0;
+    if (frame[7] != rangeChecksum(frame) || frame[2] >= RANGE_NB_SENSORS)
+    {
+        nbChecksumErrors++;
+        //On a peut etre raté le debut d'une trame : on repart du prochain octet de synchro deja reçu
+        for (int i = 1; i < RANGE_FRAME_SIZE; i++)
+            if (frame[i] == RANGE_SYNC_0)
+            {
+                received = RANGE_FRAME_SIZE - i;
+                memmove(frame, frame + i, received);
+                if (received >= 2 && frame[1] != RANGE_SYNC_1)
+                    received = 0;
+                break;
+            }
+        return;
+    }
+    RangeReading *reading = &readings[frame[2]];
+    reading->distance = frame[3] | (frame[4] << 8);
+    reading->timestamp = frame[5] | (frame[6] << 8);
+    reading->millisUpdate = max(now, (uint32_t)1);
+    nbFrames++;
+}
+
+int RangeSensors::getRange(RangeSector sector)
+{
+    int range = RANGE_NO_DATA;
+    uint32_t now = Clock::millis();
+    for (int i = 0; i < RANGE_NB_SENSORS; i++)
+    {
+        if (sectors[i] != sector || readings[i].millisUpdate == 0 || now - readings[i].millisUpdate > RANGE_TIMEOUT_MS)
+            continue;
+        if (range == RANGE_NO_DATA || readings[i].distance < range)
+            range = readings[i].distance;
+    }
+    return range;
+}
+
+const RangeReading &RangeSensors::getReading(uint8_t id)
+{
+    return readings[min(id, (uint8_t)(RANGE_NB_SENSORS - 1))];
+}
+
+void RangeSensors::setSector(uint8_t id, RangeSector sector)
+{
+    if (id < RANGE_NB_SENSORS)
+        sectors[id] = sector;
+}
@@ -0,0 +1,77 @@
+/**   Ensmasteel Library - Range sensors link (ESP32 -> Teensy)
+ * note : Trame binaire de RANGE_FRAME_SIZE octets, petit boutiste :
+ *          [0] RANGE_SYNC_0  [1] RANGE_SYNC_1
+ *          [2] id du capteur (0 .. RANGE_NB_SENSORS-1)
+ *          [3..4] distance en mm (uint16)
+ *          [5..6] timestamp de la mesure en ms (uint16, horloge de l'ESP, reboucle toutes les 65 s)
+ *          [7] checksum : somme des octets 2 a 6
+ *        Le parseur lit au plus RANGE_MAX_BYTES_PER_UPDATE octets par appel (non bloquant), n'alloue rien
+ *        et se resynchronise tout seul sur le prochain RANGE_SYNC_0 apres une trame corrompue.
+ *        Chaque capteur appartient a un secteur (avant, arriere...) : getRange renvoie la plus petite distance recente du secteur.
+*/
+
+#ifndef RANGESENSORS_H_
+#define RANGESENSORS_H_
+
+#include "Arduino.h"
+#include <Stream.h>
+
+#define RANGE_FRAME_SIZE 8
+#define RANGE_SYNC_0 0xA5
+#define RANGE_SYNC_1 0x5A
+#define RANGE_NB_SENSORS 16
+#define RANGE_MAX_BYTES_PER_UPDATE 64 //Borne le temps passé dans update (8 trames)
+#define RANGE_TIMEOUT_MS 200          //Une mesure plus vieille est ignorée (ESP muet ou capteur débranché)
+#define RANGE_NO_DATA -1              //Meme valeur qu'avant le premier message de l'ESP
+
+enum RangeSector
+{
+    FORWARD_SECTOR,
+    BACKWARD_SECTOR,
+    LEFT_SECTOR,
+    RIGHT_SECTOR,
+    __NBSECTORS__
+};
+
+struct RangeReading
+{
+    uint16_t distance;     // [...] = mm
+    uint16_t timestamp;    // [...] = ms, horloge de l'ESP
+    uint32_t millisUpdate; // [...] = ms, horloge de la teensy a la reception (0 : jamais reçu)
+};
+
+// GOAL / Build a frame (side of the ESP, or for the bench)
+// IN   / uint8_t *frame : RANGE_FRAME_SIZE bytes
+//        uint8_t id, uint16_t distance (mm), uint16_t timestamp (ms)
+void encodeRangeFrame(uint8_t *frame, uint8_t id, uint16_t distance, uint16_t timestamp);
+
+class RangeSensors
+{
+public:
+    uint32_t nbFrames;         //Trames valides reçues
+    uint32_t nbChecksumErrors; //Trames rejetées (checksum ou id invalide)
+
+    // GOAL / Read the available bytes (at most RANGE_MAX_BYTES_PER_UPDATE) and update the table of the sensors
+    void update();
+
+    // GOAL / Smallest recent distance measured in a sector
+    // OUT  / int : distance in mm, RANGE_NO_DATA if no sensor of the sector gave a measure in the last RANGE_TIMEOUT_MS
+    int getRange(RangeSector sector);
+
+    const RangeReading &getReading(uint8_t id);
+    void setSector(uint8_t id, RangeSector sector);
+
+    RangeSensors(Stream *port);
+    RangeSensors() {}
+
+private:
+    Stream *port;
+    uint8_t frame[RANGE_FRAME_SIZE];
+    uint8_t received; //Nombre d'octets de la trame en cours deja reçus
+    RangeReading readings[RANGE_NB_SENSORS];
+    RangeSector sectors[RANGE_NB_SENSORS];
+
+    void decode(uint32_t now);
+};
+
+#endif // !RANGESENSORS_H_
@@ -70,18 +70,18 @@ float Vector::distanceWith(Vector &other)
     //return operator-(other).norm()
 }
 
-void Vector::print(const String& prefix,bool info)
+void Vector::print(const char *prefix,bool info)
 {
     if (info)
-        Logger::infoln(prefix+":: x= "+String(_x)+" |y= "+String(_y));
+        LOG_INFOLN(prefix, ":: x= ", _x, " |y= ", _y);
     else
-        Logger::debugln(prefix+":: x= "+String(_x)+" |y= "+String(_y));
+        LOG_DEBUGLN(prefix, ":: x= ", _x, " |y= ", _y);
 }
 
-void Vector::toTelemetry(const String& prefix)
+void Vector::toTelemetry(const char *prefix)
 {
-    Logger::toTelemetry(prefix+"x",String(_x));
-    Logger::toTelemetry(prefix+"y",String(_y));
+    LOG_TELEMETRY(prefix,"x",_x);
+    LOG_TELEMETRY(prefix,"y",_y);
 }
 
 Vector Vector::rotate(float theta)
@@ -111,19 +111,19 @@ void VectorE::normalizeTheta()
     _theta = normalizeAngle(_theta);
 }
 
-void VectorE::print(const String& prefix,bool info)
+void VectorE::print(const char *prefix,bool info)
 {
     if (info)
-        Logger::infoln(prefix+":: x= "+String(_x)+" |y= "+String(_y)+" |Th= "+String(_theta));
+        LOG_INFOLN(prefix, ":: x= ", _x, " |y= ", _y, " |Th= ", _theta);
     else
-        Logger::debugln(prefix+":: x= "+String(_x)+" |y= "+String(_y)+" |Th= "+String(_theta));
+        LOG_DEBUGLN(prefix, ":: x= ", _x, " |y= ", _y, " |Th= ", _theta);
 }
 
-void VectorE::toTelemetry(const String& prefix)
+void VectorE::toTelemetry(const char *prefix)
 {
-    Logger::toTelemetry(prefix+"x",String(_x));
-    Logger::toTelemetry(prefix+"y",String(_y));
-    Logger::toTelemetry(prefix+"Th",String(_theta));
+    LOG_TELEMETRY(prefix,"x",_x);
+    LOG_TELEMETRY(prefix,"y",_y);
+    LOG_TELEMETRY(prefix,"Th",_theta);
 }
 
 bool VectorE::operator==(VectorE const &other)
@@ -142,21 +142,21 @@ Cinetique::Cinetique(float x, float y, float theta, float v, float w) : VectorE(
     _w = w;
 }
 
-void Cinetique::print(const String& prefix,bool info)
+void Cinetique::print(const char *prefix,bool info)
 {
     if (info)
-        Logger::infoln(prefix+":: x= "+String(_x)+" |y= "+String(_y)+" |Th= "+String(_theta)+" |v= "+String(_v)+" |w= "+String(_w));
+        LOG_INFOLN(prefix, ":: x= ", _x, " |y= ", _y, " |Th= ", _theta, " |v= ", _v, " |w= ", _w);
     else
-        Logger::debugln(prefix+":: x= "+String(_x)+" |y= "+String(_y)+" |Th= "+String(_theta)+" |v= "+String(_v)+" |w= "+String(_w));
+        LOG_DEBUGLN(prefix, ":: x= ", _x, " |y= ", _y, " |Th= ", _theta, " |v= ", _v, " |w= ", _w);
 }
 
-void Cinetique::toTelemetry(const String& prefix)
+void Cinetique::toTelemetry(const char *prefix)
 {
-    Logger::toTelemetry(prefix+"x",String(_x,3));
-    Logger::toTelemetry(prefix+"y",String(_y,3));
-    Logger::toTelemetry(prefix+"Th",String(_theta,3));
-    Logger::toTelemetry(prefix+"v",String(_v,3));
-    Logger::toTelemetry(prefix+"w",String(_w,3));
+    LOG_TELEMETRY(prefix,"x",decimals(_x,3));
+    LOG_TELEMETRY(prefix,"y",decimals(_y,3));
+    LOG_TELEMETRY(prefix,"Th",decimals(_theta,3));
+    LOG_TELEMETRY(prefix,"v",decimals(_v,3));
+    LOG_TELEMETRY(prefix,"w",decimals(_w,3));
 }
 
 bool Cinetique::operator==(Cinetique const &other)
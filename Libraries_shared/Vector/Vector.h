@@ -26,8 +26,8 @@ public:
     float norm();
     float angle();
     float distanceWith(Vector &other);
-    void print(const String& prefix="",bool info=false);
-    void toTelemetry(const String& prefix="");
+    void print(const char *prefix="",bool info=false);
+    void toTelemetry(const char *prefix="");
     Vector rotate(float theta);
 };
 
@@ -39,8 +39,8 @@ public:
     float _theta;
     VectorE(float x = 0.0, float y = 0.0, float theta = 0.0);
     void normalizeTheta();
-    void print(const String& prefix="",bool info=false);
-    void toTelemetry(const String& prefix="");
+    void print(const char *prefix="",bool info=false);
+    void toTelemetry(const char *prefix="");
     bool operator==(VectorE const &other);
 };
 
@@ -52,8 +52,8 @@ public:
     float _v;
     float _w;
     Cinetique(float x = 0.0, float y = 0.0, float theta = 0.0, float v = 0.0, float w = 0.0);
-    void print(const String& prefix="",bool info=false);
-    void toTelemetry(const String& prefix="");
+    void print(const char *prefix="",bool info=false);
+    void toTelemetry(const char *prefix="");
     bool operator==(Cinetique const &other);
 };
 
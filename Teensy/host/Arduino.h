@@ -0,0 +1,63 @@
+/**   Host target - minimal Arduino core
+ * note : Juste ce qu'utilisent les libs de Teensy/lib et Libraries_shared, pour les outils hors ligne (Tuner, Bench, Strategy)
+ *        compilés sur le PC par tools/host_build.py. Le temps est celui du PC (cf host.cpp), les broches ne font rien
+*/
+
+#ifndef HOST_ARDUINO_H_
+#define HOST_ARDUINO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include <type_traits>
+#include "Print.h"
+#include "Stream.h"
+#include "WString.h"
+
+#define PI 3.1415926535897932384626433832795
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define HIGH 1
+#define LOW 0
+#define OUTPUT 1
+#define INPUT 0
+#define INPUT_PULLUP 2
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define round(x) ((x) >= 0 ? (long)((x) + 0.5) : (long)((x)-0.5))
+template <class A, class B>
+typename std::common_type<A, B>::type min(A a, B b) { return (a < b) ? a : b; }
+template <class A, class B>
+typename std::common_type<A, B>::type max(A a, B b) { return (a > b) ? a : b; }
+template <class T>
+T abs(T x) { return (x < 0) ? -x : x; }
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+void analogWriteResolution(int bits);
+void analogWriteFrequency(int pin, float frequency);
+long random(long low, long high);
+long random(long high);
+void noInterrupts();
+void interrupts();
+
+//Serial : sortie standard, rien en entrée
+class HardwareSerial : public Stream
+{
+public:
+    size_t write(uint8_t c) override;
+    using Print::write;
+    int availableForWrite() override { return 64; }
+};
+extern HardwareSerial Serial, Serial1, Serial2, Serial3, Serial4;
+
+#endif // !HOST_ARDUINO_H_
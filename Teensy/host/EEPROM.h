@@ -0,0 +1,23 @@
+/**   Host target - EEPROM (cf Arduino.h) : toujours vierge, rien n'est gardé
+*/
+
+#ifndef HOST_EEPROM_H_
+#define HOST_EEPROM_H_
+
+#include <stdint.h>
+
+class EEPROMClass
+{
+public:
+    uint8_t read(int address) { return 0; }
+    void write(int address, uint8_t value) {}
+    void update(int address, uint8_t value) {}
+    uint16_t length() { return 4096; }
+    template <class T>
+    T &get(int address, T &t) { return t; }
+    template <class T>
+    const T &put(int address, const T &t) { return t; }
+};
+extern EEPROMClass EEPROM;
+
+#endif // !HOST_EEPROM_H_
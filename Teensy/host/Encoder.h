@@ -0,0 +1,16 @@
+/**   Host target - Encoder (cf Arduino.h) : roues immobiles
+*/
+
+#ifndef HOST_ENCODER_H_
+#define HOST_ENCODER_H_
+
+#include <stdint.h>
+
+class Encoder
+{
+public:
+    Encoder(uint8_t pinA, uint8_t pinB) {}
+    int32_t read() { return 0; }
+};
+
+#endif // !HOST_ENCODER_H_
@@ -0,0 +1,14 @@
+/**   Host target - IntervalTimer (cf Arduino.h) : jamais appelé
+*/
+
+#ifndef HOST_INTERVALTIMER_H_
+#define HOST_INTERVALTIMER_H_
+
+class IntervalTimer
+{
+public:
+    bool begin(void (*function)(), unsigned period) { return true; }
+    void end() {}
+};
+
+#endif // !HOST_INTERVALTIMER_H_
@@ -0,0 +1,52 @@
+/**   Host target - Print (cf Arduino.h)
+*/
+
+#ifndef HOST_PRINT_H_
+#define HOST_PRINT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+class String;
+class __FlashStringHelper;
+#define DEC 10
+#define HEX 16
+
+class Print
+{
+public:
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        size_t n = 0;
+        while (size--)
+            n += write(*buffer++);
+        return n;
+    }
+    size_t write(const char *str) { return write((const uint8_t *)str, strlen(str)); }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t print(const char *str) { return write(str); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(const String &str);
+    size_t print(const __FlashStringHelper *str);
+    size_t print(int n, int base = DEC);
+    size_t print(unsigned n, int base = DEC);
+    size_t print(long n, int base = DEC);
+    size_t print(unsigned long n, int base = DEC);
+    size_t print(double n, int digits = 2);
+
+    size_t println(const char *str) { return print(str) + println(); }
+    size_t println(const String &str);
+    size_t println(char c);
+    size_t println(int n, int base = DEC);
+    size_t println(unsigned n, int base = DEC);
+    size_t println(long n, int base = DEC);
+    size_t println(unsigned long n, int base = DEC);
+    size_t println(double n, int digits = 2);
+    size_t println();
+};
+
+#endif // !HOST_PRINT_H_
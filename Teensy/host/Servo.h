@@ -0,0 +1,16 @@
+/**   Host target - Servo (cf Arduino.h)
+*/
+
+#ifndef HOST_SERVO_H_
+#define HOST_SERVO_H_
+
+#include <stdint.h>
+
+class Servo
+{
+public:
+    uint8_t attach(int pin) { return 0; }
+    void write(int angle) {}
+};
+
+#endif // !HOST_SERVO_H_
@@ -0,0 +1,20 @@
+/**   Host target - Stream (cf Arduino.h), toujours vide en lecture
+*/
+
+#ifndef HOST_STREAM_H_
+#define HOST_STREAM_H_
+
+#include "Print.h"
+
+class Stream : public Print
+{
+public:
+    virtual int available() { return 0; }
+    virtual int read() { return -1; }
+    virtual int peek() { return -1; }
+    size_t write(uint8_t) override { return 1; }
+    using Print::write;
+    void begin(long baudrate) {}
+};
+
+#endif // !HOST_STREAM_H_
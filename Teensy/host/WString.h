@@ -0,0 +1,130 @@
+/**   Host target - String (cf Arduino.h)
+ * note : Comme la String d'Arduino, chaque String a son propre buffer dans le tas (meme vide), reservé a la taille exacte
+ *        et réalloué a chaque concatenation : les allocations comptées sur PC sont celles de la teensy (pas de small string optimisation)
+*/
+
+#ifndef HOST_WSTRING_H_
+#define HOST_WSTRING_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+class __FlashStringHelper;
+#define F(str) ((const __FlashStringHelper *)(str))
+
+class String
+{
+public:
+    String(const char *str = "") { copy(str, strlen(str)); }
+    String(const String &other) { copy(other.buffer, other.len); }
+    explicit String(char c) { copy(&c, 1); }
+    String(int n, unsigned char base = 10) { copyNumber((long)n, base); }
+    String(unsigned n, unsigned char base = 10) { copyNumber((unsigned long)n, base); }
+    String(long n, unsigned char base = 10) { copyNumber(n, base); }
+    String(unsigned long n, unsigned char base = 10) { copyNumber(n, base); }
+    String(float n, unsigned char digits = 2) { copyFloat(n, digits); }
+    String(double n, unsigned char digits = 2) { copyFloat(n, digits); }
+    ~String() { delete[] buffer; }
+
+    String &operator=(const String &other)
+    {
+        if (this != &other)
+        {
+            delete[] buffer;
+            copy(other.buffer, other.len);
+        }
+        return *this;
+    }
+    String &operator+=(char c) { return append(&c, 1); }
+    String &operator+=(const String &other) { return append(other.buffer, other.len); }
+    String &operator+=(const char *str) { return append(str, strlen(str)); }
+    char operator[](unsigned index) const { return (index < len) ? buffer[index] : 0; }
+    void remove(unsigned index) { remove(index, len); }
+    void remove(unsigned index, unsigned count)
+    {
+        if (index >= len)
+            return;
+        if (count > len - index)
+            count = len - index;
+        memmove(buffer + index, buffer + index + count, len - index - count + 1);
+        len -= count;
+    }
+    long toInt() const { return atol(buffer); }
+    unsigned length() const { return len; }
+    const char *c_str() const { return buffer; }
+
+private:
+    char *buffer;
+    unsigned len;
+
+    void copy(const char *str, unsigned length)
+    {
+        buffer = new char[length + 1];
+        memcpy(buffer, str, length);
+        buffer[length] = 0;
+        len = length;
+    }
+    String &append(const char *str, unsigned length)
+    {
+        char *grown = new char[len + length + 1]; //realloc d'Arduino
+        memcpy(grown, buffer, len);
+        memcpy(grown + len, str, length);
+        grown[len + length] = 0;
+        delete[] buffer;
+        buffer = grown;
+        len += length;
+        return *this;
+    }
+    void copyNumber(long n, unsigned char base)
+    {
+        if (n < 0 && base == 10)
+            copyNumber(0UL - (unsigned long)n, base, true);
+        else
+            copyNumber((unsigned long)n, base);
+    }
+    void copyNumber(unsigned long n, unsigned char base, bool negative = false)
+    {
+        char text[8 * sizeof(long) + 2];
+        char *out = text + sizeof(text) - 1;
+        *out = 0;
+        if (base < 2)
+            base = 10;
+        do
+        {
+            *--out = "0123456789abcdefghijklmnopqrstuvwxyz"[n % base];
+            n /= base;
+        } while (n > 0);
+        if (negative)
+            *--out = '-';
+        copy(out, strlen(out));
+    }
+    void copyFloat(double n, unsigned char digits)
+    {
+        char text[64];
+        snprintf(text, sizeof(text), "%.*f", digits, n);
+        copy(text, strlen(text));
+    }
+};
+
+//Une copie puis une réallocation, comme le StringSumHelper d'Arduino
+inline String operator+(const String &a, const String &b)
+{
+    String out(a);
+    out += b;
+    return out;
+}
+inline String operator+(const String &a, const char *b)
+{
+    String out(a);
+    out += b;
+    return out;
+}
+inline String operator+(const char *a, const String &b)
+{
+    String out(a);
+    out += b;
+    return out;
+}
+
+#endif // !HOST_WSTRING_H_
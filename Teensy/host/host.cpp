@@ -0,0 +1,78 @@
+#ifdef HOST
+/**   Host target - Arduino core et main (cf Arduino.h)
+ *
+ *  main appelle setup() puis loop() autant de fois que demandé en argument (0 par defaut : les outils font tout dans setup)
+*/
+#include "Arduino.h"
+#include "EEPROM.h"
+#include <chrono>
+#include <stdio.h>
+#include <string>
+
+static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+uint32_t millis()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+uint32_t micros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void delay(uint32_t ms) {} //Pas d'attente : les outils ne regardent que le temps simulé
+void pinMode(uint8_t pin, uint8_t mode) {}
+void digitalWrite(uint8_t pin, uint8_t value) {}
+int digitalRead(uint8_t pin) { return 0; }
+void analogWrite(uint8_t pin, int value) {}
+void analogWriteResolution(int bits) {}
+void analogWriteFrequency(int pin, float frequency) {}
+long random(long low, long high) { return low + rand() % (high - low); }
+long random(long high) { return rand() % high; }
+void noInterrupts() {}
+void interrupts() {}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    putchar(c);
+    return 1;
+}
+HardwareSerial Serial, Serial1, Serial2, Serial3, Serial4;
+EEPROMClass EEPROM;
+
+size_t Print::print(const String &str) { return write(str.c_str()); }
+size_t Print::print(const __FlashStringHelper *str) { return write((const char *)str); }
+size_t Print::print(int n, int base) { return write(std::to_string(n).c_str()); }
+size_t Print::print(unsigned n, int base) { return write(std::to_string(n).c_str()); }
+size_t Print::print(long n, int base) { return write(std::to_string(n).c_str()); }
+size_t Print::print(unsigned long n, int base) { return write(std::to_string(n).c_str()); }
+size_t Print::print(double n, int digits)
+{
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", digits, n);
+    return write(buffer);
+}
+size_t Print::println(const String &str) { return print(str) + println(); }
+size_t Print::println(char c) { return print(c) + println(); }
+size_t Print::println(int n, int base) { return print(n, base) + println(); }
+size_t Print::println(unsigned n, int base) { return print(n, base) + println(); }
+size_t Print::println(long n, int base) { return print(n, base) + println(); }
+size_t Print::println(unsigned long n, int base) { return print(n, base) + println(); }
+size_t Print::println(double n, int digits) { return print(n, digits) + println(); }
+size_t Print::println() { return write((uint8_t)'\n'); }
+
+extern void setup();
+extern void loop();
+
+int main(int argc, char **argv)
+{
+    setup();
+    int nbLoops = (argc > 1) ? atoi(argv[1]) : 0;
+    for (int i = 0; i < nbLoops; i++)
+        loop();
+    fflush(stdout);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,52 @@
+#include "BufferStream.h"
+
+BufferStream::BufferStream()
+{
+    room = -1;
+    clear();
+}
+
+int BufferStream::availableForWrite()
+{
+    int space = BUFFER_STREAM_SIZE - writeIndex;
+    return (room < 0) ? space : min(room, space);
+}
+
+void BufferStream::setRoom(int room)
+{
+    this->room = room;
+}
+
+int BufferStream::available()
+{
+    return writeIndex - readIndex;
+}
+
+int BufferStream::read()
+{
+    return (readIndex < writeIndex) ? buffer[readIndex++] : -1;
+}
+
+int BufferStream::peek()
+{
+    return (readIndex < writeIndex) ? buffer[readIndex] : -1;
+}
+
+size_t BufferStream::write(uint8_t c)
+{
+    if (writeIndex >= BUFFER_STREAM_SIZE)
+        return 0;
+    buffer[writeIndex++] = c;
+    return 1;
+}
+
+void BufferStream::clear()
+{
+    readIndex = 0;
+    writeIndex = 0;
+}
+
+void BufferStream::rewind()
+{
+    readIndex = 0;
+}
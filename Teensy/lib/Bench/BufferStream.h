@@ -0,0 +1,36 @@
+/**   Ensmasteel Library - Stream in memory
+ * note : Remplace un port serie dans les bancs de test : on y ecrit des octets, le code testé les lit
+ *        setRoom simule un buffer d'emission presque plein (availableForWrite)
+*/
+
+#ifndef BUFFERSTREAM_H_
+#define BUFFERSTREAM_H_
+
+#include "Arduino.h"
+#include <Stream.h>
+
+#define BUFFER_STREAM_SIZE 4096
+
+class BufferStream : public Stream
+{
+public:
+    int available();
+    int read();
+    int peek();
+    size_t write(uint8_t c);
+    using Print::write;
+    int availableForWrite();
+    void setRoom(int room); //Place annoncée par availableForWrite (-1 : toute la place restante)
+    void flush() {}
+    void clear();   //Vide le buffer
+    void rewind();  //Relit les memes octets depuis le debut
+
+    BufferStream();
+
+private:
+    uint8_t buffer[BUFFER_STREAM_SIZE];
+    uint16_t readIndex, writeIndex;
+    int room;
+};
+
+#endif // !BUFFERSTREAM_H_
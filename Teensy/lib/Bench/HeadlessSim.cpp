@@ -0,0 +1,127 @@
+#include "HeadlessSim.h"
+
+HeadlessSim::HeadlessSim(DynamicModel model, float filterFrequency, float health)
+{
+    this->model = model;
+    this->plant = model;
+    this->ilc = ILC(&translationOrder, &rotationOrder, &cinetiqueRobot, &cinetiqueGhost);
+    this->filterFrequency = filterFrequency;
+    this->health = health;
+    this->cascaded = false;
+    this->estimator = MotorEstimator(&this->model);
+    this->estimating = false;
+}
+
+void HeadlessSim::setHealth(float health)
+{
+    this->health = health;
+}
+
+void HeadlessSim::setEstimation(bool estimate, bool compensate)
+{
+    this->estimating = estimate;
+    estimator.compensate = compensate;
+}
+
+void HeadlessSim::setPlantModel(DynamicModel plant)
+{
+    this->plant = plant;
+}
+
+void HeadlessSim::setCascaded(bool cascaded)
+{
+    this->cascaded = cascaded;
+}
+
+BenchResult HeadlessSim::run(BenchMove move, MoveProfileName profile, int16_t track)
+{
+    BenchResult result;
+    Clock *previousClock = Clock::get();
+    Clock::use(&clock);
+
+    cinetiqueGhost = Cinetique(move.start._x, move.start._y, move.start._theta);
+    cinetiqueRobot = Cinetique(move.start._x + move.robotOffset._x, move.start._y + move.robotOffset._y, move.start._theta + move.robotOffset._theta);
+    translationOrder = rotationOrder = orderLeft = orderRight = 0.0;
+    ghost = Ghost(move.start);
+    controller = Asservissement(&translationOrder, &rotationOrder, &cinetiqueRobot, &cinetiqueGhost, &ghost, &model, filterFrequency);
+    simu = Simulator(plant, &cinetiqueRobot, &orderLeft, &orderRight, health);
+    velocityLeft = VelocityLoop(VELOCITY_KP, VELOCITY_KI, model.friction / model.maxMotorForce);
+    velocityRight = VelocityLoop(VELOCITY_KP, VELOCITY_KI, model.friction / model.maxMotorForce);
+
+    MoveProfile *moveProfile = MoveProfiles::get(profile, !move.pureRotation);
+    ghost.Compute_Trajectory(move.target, move.deltaCurve, moveProfile->speedRamps, moveProfile->cruisingSpeed, move.pureRotation, move.backward);
+    ghost.Lock(false);
+    controller.setCurrentProfile(profile);
+    controller.reset();
+    ErrorManager::reset();
+    if (track >= 0)
+        ilc.startTrack(0, track, ILC::signature(move.target, move.deltaCurve, profile, move.pureRotation, move.backward, ghost.Get_Duration()),
+                       ghost.Get_Duration());
+
+    float t = 0.0, tGhostFinished = -1.0;
+    result.finished = false;
+    result.maxTrackingError = 0.0;
+    result.maxComputeTime = 0;
+    uint32_t totalComputeTime = 0, nbCompute = 0;
+    while (tGhostFinished < 0 || t - tGhostFinished < HEADLESS_SETTLE_TIME)
+    {
+        //La physique avance au pas de la boucle interne, que la cascade soit active ou non
+        for (int i = 0; i < round(HEADLESS_DT / HEADLESS_INNER_DT); i++)
+        {
+            if (cascaded)
+            {
+                orderLeft = velocityLeft.compute(controller.wheelTargetLeft, cinetiqueRobot._v - cinetiqueRobot._w * model.size / 2, HEADLESS_INNER_DT);
+                orderRight = velocityRight.compute(controller.wheelTargetRight, cinetiqueRobot._v + cinetiqueRobot._w * model.size / 2, HEADLESS_INNER_DT);
+            }
+            simu.updateCinetique(HEADLESS_INNER_DT);
+            clock.advanceSeconds(HEADLESS_INNER_DT);
+        }
+        if (estimating)
+            estimator.update(orderLeft, orderRight, cinetiqueRobot, HEADLESS_DT);
+        ghost.ActuatePosition(HEADLESS_DT);
+        cinetiqueGhost = ghost.Get_Controller_Cinetique();
+        uint32_t start = micros();
+        if (cascaded)
+            controller.computeCascade(HEADLESS_DT);
+        else
+        {
+            controller.compute(HEADLESS_DT);
+            if (track >= 0)
+                ilc.apply(HEADLESS_DT);
+            orderLeft = translationOrder - rotationOrder;
+            orderRight = translationOrder + rotationOrder;
+            if (estimating)
+            {
+                orderLeft = estimator.compensateOrder(orderLeft, false, cinetiqueRobot._v - cinetiqueRobot._w * model.size / 2);
+                orderRight = estimator.compensateOrder(orderRight, true, cinetiqueRobot._v + cinetiqueRobot._w * model.size / 2);
+            }
+        }
+        uint32_t computeTime = micros() - start;
+        result.maxComputeTime = max(result.maxComputeTime, computeTime);
+        totalComputeTime += computeTime;
+        nbCompute++;
+        t += HEADLESS_DT;
+        result.maxTrackingError = max(result.maxTrackingError, (cinetiqueGhost - cinetiqueRobot).norm());
+
+        if (tGhostFinished < 0 && ghost.trajectoryIsFinished())
+            tGhostFinished = t;
+        if (tGhostFinished >= 0 && controller.close)
+        {
+            result.finished = true;
+            break;
+        }
+        if (t > 60.0) //Le ghost ne finit jamais (trajectoire impossible)
+            break;
+    }
+
+    result.duration = t;
+    result.finalError = (cinetiqueGhost - cinetiqueRobot).norm();
+    result.meanComputeTime = (float)totalComputeTime / nbCompute;
+    result.pidFail = (ErrorManager::count(PID_FAIL_ERROR) > 0);
+    if (track >= 0)
+        ilc.endTrack(result.finished);
+    result.translation = controller.getScore(true);
+    result.rotation = controller.getScore(false);
+    Clock::use(previousClock);
+    return result;
+}
@@ -0,0 +1,96 @@
+/**   Ensmasteel Library - Headless simulation bench
+ * note : Ghost + Asservissement + Simulator without any hardware (no Robot, no Serial, no pins)
+ *        The simulated time runs on a VirtualClock (timeouts, error debouncing...) : a move is simulated much faster than real time.
+ *        Compute times are still measured with the hardware clock
+ *        Used to tune and compare controllers offline
+*/
+
+#ifndef HEADLESSSIM_H_
+#define HEADLESSSIM_H_
+
+#include "Arduino.h"
+#include "Vector.h"
+#include "Ghost.h"
+#include "PID.h"
+#include "Simulator.h"
+#include "DynamicModel.h"
+#include "ErrorManager.h"
+#include "ILC.h"
+#include "Estimator.h"
+#include "Clock.h"
+
+#define HEADLESS_DT 0.01        // [...] = s, control period of the simulation
+#define HEADLESS_INNER_DT 0.001 // [...] = s, physics step and period of the cascaded velocity loop
+#define HEADLESS_SETTLE_TIME 2.0 // [...] = s, time allowed after the ghost finished for the robot to be close
+
+struct BenchMove
+{
+    VectorE start;
+    VectorE target;
+    float deltaCurve;
+    bool pureRotation;
+    bool backward;
+    VectorE robotOffset = VectorE(0, 0, 0); //Le robot part de start+robotOffset (poussé, mal recalé...), le ghost de start
+};
+
+struct BenchResult
+{
+    Score translation;
+    Score rotation;
+    float duration;   // [...] = s, until ghost finished AND controller close (or timeout)
+    bool finished;    // false if the robot never got close to the ghost
+    float maxTrackingError; // [...] = m, max distance between the robot and the ghost
+    float finalError;       // [...] = m, distance between the robot and the ghost at the end (lateral error included)
+    uint32_t maxComputeTime; // [...] = us, longest call to the outer controller
+    float meanComputeTime;   // [...] = us
+    bool pidFail;            // PID_FAIL_ERROR raised during the move
+};
+
+class HeadlessSim
+{
+public:
+    // GOAL / Run one move from move.start to move.target with the given profile
+    // IN   / BenchMove move
+    //        MoveProfileName profile
+    //        int16_t track : if >= 0, the ILC table used (and updated) for this move
+    // OUT  / BenchResult : Scores of both PID, duration and success
+    BenchResult run(BenchMove move, MoveProfileName profile, int16_t track = -1);
+
+    // GOAL / Choose the controller : single position loop (Asservissement::compute) or cascaded
+    //        (Asservissement::computeCascade at HEADLESS_DT + VelocityLoop per wheel at HEADLESS_INNER_DT)
+    void setCascaded(bool cascaded);
+
+    // GOAL / Simulate a robot which differs from the model used by the controller (default : the same)
+    void setPlantModel(DynamicModel plant);
+
+    // GOAL / Health of the simulated motors (cf Simulator)
+    void setHealth(float health);
+
+    // GOAL / Identify the motors online during the runs (the estimation is kept from one run to the next)
+    // IN   / bool estimate : run the estimator
+    //        bool compensate : correct the orders with the estimation
+    void setEstimation(bool estimate, bool compensate);
+
+    ILC ilc; //Tables apprises d'un run a l'autre (cf run, track)
+    MotorEstimator estimator;
+    VirtualClock clock; //Clock::use(&clock) pendant run
+
+    HeadlessSim(DynamicModel model, float filterFrequency = 20, float health = 1.0);
+
+private:
+    DynamicModel model, plant;
+    float filterFrequency;
+    float health;
+    bool cascaded;
+    bool estimating;
+
+    Cinetique cinetiqueRobot, cinetiqueGhost;
+    float translationOrder = 0.0, rotationOrder = 0.0;
+    float orderLeft = 0.0, orderRight = 0.0;
+    Ghost ghost;
+    Asservissement controller;
+    Simulator simu;
+    VelocityLoop velocityLeft, velocityRight;
+};
+
+#endif // !HEADLESSSIM_H_
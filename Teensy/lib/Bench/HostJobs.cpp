@@ -0,0 +1,131 @@
+#include "HostJobs.h"
+
+#ifdef HOST
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+uint16_t HostJobs::nbWorkers()
+{
+    const char *forced = getenv("HOST_JOBS"); //Comme make -j
+    long nbCores = (forced != nullptr) ? atol(forced) : sysconf(_SC_NPROCESSORS_ONLN);
+    return constrain(nbCores, 1, HOST_MAX_WORKERS);
+}
+
+//Lit tout le resultat d'un job (le pipe peut le rendre en plusieurs morceaux)
+static bool readAll(int fd, uint8_t *out, size_t size)
+{
+    size_t done = 0;
+    while (done < size)
+    {
+        ssize_t n = read(fd, out + done, size - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        done += n;
+    }
+    return true;
+}
+
+//Lance le job index dans un processus fils qui renvoie son resultat par un pipe. false : pas de processus, le job a tourné ici
+static bool startJob(HostJob job, uint16_t index, uint8_t *result, size_t resultSize, void *context, pid_t *pid, int *fd)
+{
+    int pipeFds[2] = {-1, -1};
+    fflush(stdout); //Sinon le tampon de stdout serait ecrit par chaque fils
+    *pid = (pipe(pipeFds) == 0) ? fork() : -1;
+    if (*pid == 0)
+    {
+        close(pipeFds[0]);
+        job(index, result, context);
+        fflush(stdout);
+        bool sent = (write(pipeFds[1], result, resultSize) == (ssize_t)resultSize);
+        _exit(sent ? 0 : 1);
+    }
+    if (*pid < 0)
+    {
+        if (pipeFds[0] >= 0)
+        {
+            close(pipeFds[0]);
+            close(pipeFds[1]);
+        }
+        job(index, result, context);
+        return false;
+    }
+    close(pipeFds[1]);
+    *fd = pipeFds[0];
+    return true;
+}
+
+uint16_t HostJobs::run(HostJob job, uint16_t nbJobs, void *results, size_t resultSize, void *context)
+{
+    uint8_t *out = (uint8_t *)results;
+    uint8_t *received = (uint8_t *)malloc(max(resultSize, (size_t)1)); //Un resultat n'est copié dans results que s'il est complet
+    uint16_t workers = nbWorkers();
+    pid_t pids[HOST_MAX_WORKERS];
+    struct pollfd fds[HOST_MAX_WORKERS];
+    uint16_t indexes[HOST_MAX_WORKERS];
+    uint16_t nbRunning = 0, next = 0, nbFailed = 0;
+    while (next < nbJobs || nbRunning > 0)
+    {
+        //File d'attente : chaque place libre prend le job suivant
+        while (next < nbJobs && nbRunning < workers)
+        {
+            uint16_t index = next++;
+            if (startJob(job, index, out + index * resultSize, resultSize, context, &pids[nbRunning], &fds[nbRunning].fd))
+            {
+                fds[nbRunning].events = POLLIN;
+                indexes[nbRunning] = index;
+                nbRunning++;
+            }
+        }
+        if (nbRunning == 0)
+            continue;
+
+        //On attend le premier qui finit (resultat envoyé ou processus mort : POLLIN ou POLLHUP)
+        for (uint16_t i = 0; i < nbRunning; i++)
+            fds[i].revents = 0;
+        if (poll(fds, nbRunning, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            fds[0].revents = POLLIN; //poll inutilisable : lecture bloquante du plus ancien
+        }
+        for (int i = nbRunning - 1; i >= 0; i--)
+        {
+            if (fds[i].revents == 0)
+                continue;
+            if (readAll(fds[i].fd, received, resultSize))
+                memcpy(out + indexes[i] * resultSize, received, resultSize);
+            else
+                nbFailed++;
+            close(fds[i].fd);
+            waitpid(pids[i], nullptr, 0);
+            nbRunning--; //Le dernier prend sa place
+            pids[i] = pids[nbRunning];
+            fds[i] = fds[nbRunning];
+            indexes[i] = indexes[nbRunning];
+        }
+    }
+    free(received);
+    return nbFailed;
+}
+
+#else
+
+uint16_t HostJobs::nbWorkers()
+{
+    return 1;
+}
+
+uint16_t HostJobs::run(HostJob job, uint16_t nbJobs, void *results, size_t resultSize, void *context)
+{
+    uint8_t *out = (uint8_t *)results;
+    for (uint16_t i = 0; i < nbJobs; i++)
+        job(i, out + i * resultSize, context);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,34 @@
+/**   Ensmasteel Library - Independent jobs of the offline tools
+ * note : Host build (-DHOST, cf tools/host_build.py) : un processus (fork) par job, autant que de coeurs (ou HOST_JOBS=n), HOST_MAX_WORKERS au plus.
+ *          File d'attente : des qu'un job finit, le suivant part a sa place (les jobs longs ne bloquent pas les coeurs libres).
+ *          Les simulations partagent des statiques (Clock::use, ErrorManager, MoveProfiles) : des processus et pas des threads.
+ *          Chaque job part de l'etat du parent au lancement et renvoie son resultat (resultSize octets) par un pipe.
+ *        Teensy : les jobs s'enchainent dans l'ordre, dans le meme programme (les effets de bord d'un job restent pour les suivants)
+*/
+
+#ifndef HOSTJOBS_H_
+#define HOSTJOBS_H_
+
+#include "Arduino.h"
+
+#define HOST_MAX_WORKERS 64
+
+// GOAL / One job
+// IN   / uint16_t index : index of the job in [0, nbJobs[
+//        void *result : resultSize bytes to fill
+//        void *context : shared by every job, read only
+typedef void (*HostJob)(uint16_t index, void *result, void *context);
+
+class HostJobs
+{
+public:
+    // GOAL / Run nbJobs independent jobs (in parallel on the host, one after the other on the target)
+    // IN   / void *results : nbJobs * resultSize bytes, the result of job i at i * resultSize
+    // OUT  / uint16_t : number of jobs that did not return their whole result (crash of the process, host only). Their result is left as is
+    static uint16_t run(HostJob job, uint16_t nbJobs, void *results, size_t resultSize, void *context);
+
+    // GOAL / Number of jobs run at the same time
+    static uint16_t nbWorkers();
+};
+
+#endif // !HOSTJOBS_H_
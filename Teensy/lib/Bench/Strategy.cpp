@@ -0,0 +1,398 @@
+#include "Strategy.h"
+#include "Logger.h"
+#include "Program.h"
+#include "Planner.h"
+#include "Tuner.h"
+#include <stdlib.h>
+
+Strategy::Strategy(const StrategyTask *tasks, uint8_t nbTasks, VectorE start, Vector home, const char *homeName)
+{
+    this->tasks = tasks;
+    this->nbTasks = min(nbTasks, (uint8_t)STRATEGY_MAX_TASKS);
+    this->start = start;
+    this->home = home;
+    this->homeName = homeName;
+    this->nbFinalists = 0;
+    this->bestResult = 0;
+}
+
+//========================================DUREES========================================
+
+void Strategy::estimate()
+{
+    //Memes durées que le Planner embarqué
+    spinTimes[0] = PLANNER_SETTLE_TIME;
+    for (int k = 1; k <= STRATEGY_SPIN_STEPS; k++)
+        spinTimes[k] = Planner::spinDuration(PI * k / STRATEGY_SPIN_STEPS, profile);
+
+    for (int from = 0; from <= nbTasks; from++)
+    {
+        Vector origin = (from == nbTasks) ? (Vector)start : tasks[from].target;
+        for (int to = 0; to <= nbTasks; to++)
+        {
+            Vector target = (to == nbTasks) ? home : tasks[to].target;
+            Vector delta = target - origin;
+            caps[from][to] = (delta.norm() > 1e-3) ? delta.angle() : ((from == nbTasks) ? start._theta : 0.0);
+            moves[from][to] = Planner::gotoDuration(origin, target, profile);
+        }
+    }
+}
+
+float Strategy::spinTime(float from, float to)
+{
+    float steps = fabs(normalizeAngle(to - from)) / PI * STRATEGY_SPIN_STEPS;
+    int k = min((int)steps, STRATEGY_SPIN_STEPS - 1);
+    return spinTimes[k] + (steps - k) * (spinTimes[k + 1] - spinTimes[k]);
+}
+
+float Strategy::leg(const StrategyPlan &plan, uint8_t to)
+{
+    uint8_t from = last(plan);
+    float out = spinTime(plan.heading, caps[from][to]) + moves[from][to];
+    if (to < nbTasks)
+        out += tasks[to].actuatorTime;
+    return out;
+}
+
+//========================================RECHERCHE========================================
+
+static bool better(const StrategyPlan &a, const StrategyPlan &b)
+{
+    return a.score > b.score || (a.score == b.score && a.total < b.total);
+}
+
+void Strategy::keep(const StrategyPlan &plan)
+{
+    if (nbFinalists == STRATEGY_NB_VALIDATED && !better(plan, finalists[STRATEGY_NB_VALIDATED - 1]))
+        return;
+    uint8_t i = (nbFinalists < STRATEGY_NB_VALIDATED) ? nbFinalists++ : STRATEGY_NB_VALIDATED - 1;
+    for (; i > 0 && better(plan, finalists[i - 1]); i--)
+        finalists[i] = finalists[i - 1];
+    finalists[i] = plan;
+}
+
+uint32_t Strategy::search()
+{
+    uint32_t nbCandidates = 0;
+    nbFinalists = 0;
+
+    StrategyPlan &root = beam[0];
+    root.size = 0;
+    root.done = 0;
+    root.time = 0.0;
+    root.heading = start._theta;
+    root.score = 0;
+    root.total = leg(root, nbTasks);
+    uint8_t beamSize = 1;
+    keep(root);
+
+    for (int depth = 0; depth < nbTasks && beamSize > 0; depth++)
+    {
+        uint16_t nbChildren = 0;
+        for (int p = 0; p < beamSize; p++)
+        {
+            const StrategyPlan &parent = beam[p];
+            for (int t = 0; t < nbTasks; t++)
+            {
+                if (parent.done & (1UL << t))
+                    continue;
+                nbCandidates++;
+                float time = parent.time + leg(parent, t);
+                float back = spinTime(caps[last(parent)][t], caps[t][nbTasks]) + moves[t][nbTasks];
+                if (time + back > matchDuration - margin)
+                    continue; //Plus le temps de rentrer
+                Child &child = children[nbChildren++];
+                child.done = parent.done | (1UL << t);
+                child.time = time;
+                child.score = parent.score + tasks[t].score;
+                child.rank = child.score - timeWeight * time;
+                child.parent = p;
+                child.task = t;
+            }
+        }
+
+        //Doublons (meme ensemble, meme derniere tache : le cap peut differer, on l'ignore) : on garde le plus rapide
+        qsort(children, nbChildren, sizeof(Child), [](const void *a, const void *b) {
+            const Child *ca = (const Child *)a, *cb = (const Child *)b;
+            int out = 0;
+            if (ca->done != cb->done)
+                out = (ca->done < cb->done) ? -1 : 1;
+            if (out == 0 && ca->task != cb->task)
+                out = (ca->task < cb->task) ? -1 : 1;
+            if (out == 0 && ca->time != cb->time)
+                out = (ca->time < cb->time) ? -1 : 1;
+            return out;
+        });
+        uint16_t nbUnique = 0;
+        for (int i = 0; i < nbChildren; i++)
+            if (nbUnique == 0 || children[i].done != children[nbUnique - 1].done || children[i].task != children[nbUnique - 1].task)
+                children[nbUnique++] = children[i];
+
+        qsort(children, nbUnique, sizeof(Child), [](const void *a, const void *b) {
+            float ra = ((const Child *)a)->rank, rb = ((const Child *)b)->rank;
+            return (ra > rb) ? -1 : ((ra < rb) ? 1 : 0);
+        });
+        beamSize = min(nbUnique, (uint16_t)STRATEGY_BEAM_WIDTH);
+        for (int i = 0; i < beamSize; i++)
+        {
+            const Child &child = children[i];
+            const StrategyPlan &parent = beam[child.parent];
+            StrategyPlan &plan = nextBeam[i];
+            plan = parent;
+            plan.heading = caps[last(parent)][child.task];
+            plan.order[plan.size++] = child.task;
+            plan.done = child.done;
+            plan.time = child.time;
+            plan.score = child.score;
+            plan.total = plan.time + leg(plan, nbTasks);
+            keep(plan);
+        }
+        memcpy(beam, nextBeam, beamSize * sizeof(StrategyPlan));
+    }
+    return nbCandidates;
+}
+
+//========================================BYTECODE========================================
+
+uint8_t Strategy::timeoutOf(float duration)
+{
+    return min(255, (int)ceil((2 * duration + 2.0) * 10));
+}
+
+static void put8(uint8_t *code, uint16_t &size, uint8_t value)
+{
+    if (size < PROGRAM_MAX_SIZE)
+        code[size] = value;
+    size++;
+}
+
+static void put16(uint8_t *code, uint16_t &size, uint16_t value)
+{
+    put8(code, size, value & 0xFF);
+    put8(code, size, value >> 8);
+}
+
+static inline int16_t mmOf(float meters) { return (int16_t)round(meters * 1000); }
+static inline int16_t mradOf(float radians) { return (int16_t)round(radians * 1000); }
+
+uint16_t Strategy::assemble(const StrategyPlan &plan, uint8_t *code)
+{
+    uint16_t size = 0;
+    uint8_t variables[] = {STRATEGY_SCORE_VARIABLE, STRATEGY_DONE_VARIABLE};
+    for (uint8_t variable : variables)
+    {
+        put8(code, size, OP_SET);
+        put8(code, size, variable);
+        put16(code, size, 0);
+    }
+
+    StrategyPlan current = plan;
+    current.size = 0;
+    current.heading = start._theta;
+    for (int i = 0; i <= plan.size; i++)
+    {
+        uint8_t from = last(current);
+        uint8_t to = (i < plan.size) ? plan.order[i] : nbTasks;
+        float cap = caps[from][to];
+        Vector target = (to == nbTasks) ? home : tasks[to].target;
+
+        put8(code, size, OP_SPIN);
+        put16(code, size, mradOf(cap));
+        put8(code, size, profile);
+        put8(code, size, PROGRAM_MIRROR);
+        put8(code, size, timeoutOf(spinTime(current.heading, cap)));
+
+        put8(code, size, OP_GOTO);
+        put16(code, size, mmOf(target._x));
+        put16(code, size, mmOf(target._y));
+        put16(code, size, mradOf(cap));
+        put8(code, size, round(STRATEGY_CURVE * 100));
+        put8(code, size, profile);
+        put8(code, size, PROGRAM_MIRROR);
+        put8(code, size, timeoutOf(moves[from][to]));
+        if (to == nbTasks)
+            break;
+
+        //Mouvement raté : ni actionneur ni points
+        put8(code, size, OP_JUMP_FAILED);
+        uint16_t jump = size;
+        put16(code, size, 0);
+        const StrategyTask &task = tasks[to];
+        if (task.actuator < __NBMESSAGES__)
+        {
+            put8(code, size, OP_SEND);
+            put8(code, size, 1);
+            put16(code, size, task.actuator);
+            put16(code, size, task.order);
+            put16(code, size, 0);
+            put8(code, size, OP_SLEEP);
+            put16(code, size, round(task.actuatorTime * 100));
+        }
+        put8(code, size, OP_ADD);
+        put8(code, size, STRATEGY_SCORE_VARIABLE);
+        put16(code, size, task.score);
+        put8(code, size, OP_ADD);
+        put8(code, size, STRATEGY_DONE_VARIABLE);
+        put16(code, size, 1);
+        if (jump + 1 < PROGRAM_MAX_SIZE)
+        {
+            code[jump] = size & 0xFF;
+            code[jump + 1] = size >> 8;
+        }
+
+        current.heading = cap;
+        current.order[current.size++] = to;
+    }
+
+    put8(code, size, OP_END);
+    put8(code, size, PROGRAM_LOCK_GHOST);
+    return (size <= PROGRAM_MAX_SIZE) ? size : 0;
+}
+
+//========================================VALIDATION========================================
+
+void Strategy::replay(const StrategyPlan &plan, HeadlessSim *sim, StrategyResult &result)
+{
+    static uint8_t code[PROGRAM_MAX_SIZE];
+    result.plan = plan;
+    result.score = 0;
+    result.nbDone = 0;
+    result.time = 0.0;
+    result.home = false;
+    result.size = assemble(plan, code);
+    if (result.size > 0 && Program::validate(code, result.size) != PROGRAM_OK)
+        result.size = 0;
+
+    Vector where = start;
+    float heading = start._theta;
+    for (int i = 0; i <= plan.size; i++)
+    {
+        uint8_t from = (i == 0) ? nbTasks : plan.order[i - 1];
+        uint8_t to = (i < plan.size) ? plan.order[i] : nbTasks;
+        float cap = caps[from][to];
+        Vector target = (to == nbTasks) ? home : tasks[to].target;
+        BenchMove spin = {VectorE(where._x, where._y, heading), VectorE(where._x, where._y, cap), 0.0, true, false};
+        BenchMove go = {VectorE(where._x, where._y, cap), VectorE(target._x, target._y, cap), STRATEGY_CURVE, false, false};
+        result.time += sim->run(spin, profile).duration;
+        BenchResult arrival = sim->run(go, profile);
+        result.time += arrival.duration;
+        if (to == nbTasks)
+        {
+            result.home = arrival.finished && result.time <= matchDuration;
+            break;
+        }
+        if (arrival.finished) //Sinon le programme saute l'actionneur et les points (JUMP_FAILED)
+        {
+            result.time += tasks[to].actuatorTime;
+            if (result.time <= matchDuration)
+            {
+                result.score += tasks[to].score;
+                result.nbDone++;
+            }
+        }
+        where = target;
+        heading = cap;
+    }
+}
+
+struct StrategyJobs
+{
+    Strategy *strategy;
+    HeadlessSim *sim;
+};
+
+void Strategy::replayJob(uint16_t index, void *result, void *context)
+{
+    StrategyJobs *jobs = (StrategyJobs *)context;
+    jobs->strategy->replay(jobs->strategy->finalists[index], jobs->sim, *(StrategyResult *)result);
+}
+
+void Strategy::validate(HeadlessSim *sim)
+{
+    StrategyJobs jobs = {this, sim};
+    for (int k = 0; k < nbFinalists; k++) //Resultat d'un job perdu : jamais retenu
+    {
+        results[k].plan = finalists[k];
+        results[k].size = 0;
+        results[k].home = false;
+        results[k].score = 0;
+    }
+    uint16_t nbFailed = HostJobs::run(replayJob, nbFinalists, results, sizeof(StrategyResult), &jobs);
+    if (nbFailed > 0)
+        Logger::infoln("Strategy : ", nbFailed, " replays lost");
+
+    //Rentré d'abord, puis le score, puis le plus rapide
+    bestResult = 0;
+    for (int k = 1; k < nbFinalists; k++)
+    {
+        const StrategyResult &a = results[k], &b = results[bestResult];
+        if ((a.size > 0) > (b.size > 0) || ((a.size > 0) == (b.size > 0) && (a.home > b.home || (a.home == b.home && (a.score > b.score || (a.score == b.score && a.time < b.time))))))
+            bestResult = k;
+    }
+}
+
+//========================================AFFICHAGE========================================
+
+void Strategy::printCpp(const StrategyPlan &plan)
+{
+    StrategyPlan current = plan;
+    current.size = 0;
+    current.heading = start._theta;
+    Logger::infoln("//Strategie : ", plan.score, " points estimés, retour a la base a ", decimals(plan.total, 1), "s");
+    for (int i = 0; i <= plan.size; i++)
+    {
+        uint8_t from = last(current);
+        uint8_t to = (i < plan.size) ? plan.order[i] : nbTasks;
+        float timeout = timeoutOf(spinTime(current.heading, caps[from][to]) + moves[from][to]) / 10.0;
+        Logger::infoln("mainSequence->add(new StraightTo_Action(", decimals(timeout, 1), ", ", (to == nbTasks) ? homeName : tasks[to].name, ", ",
+                       Tuner::profileName(profile), "));");
+        if (to == nbTasks)
+            break;
+        const StrategyTask &task = tasks[to];
+        if (task.actuator < __NBMESSAGES__)
+        {
+            Logger::infoln("mainSequence->add(new Send_Action(newMessage(", task.actuatorName, ", Actuator_Order::", task.orderName, ", 0, 0, 0), &commActionneurs));");
+            Logger::infoln("mainSequence->add(new Sleep_Action(", decimals(task.actuatorTime, 2), "));");
+        }
+        current.heading = caps[from][to];
+        current.order[current.size++] = to;
+    }
+    Logger::infoln("mainSequence->add(new End_Action(false, true, true));");
+}
+
+void Strategy::printAsm(const StrategyPlan &plan)
+{
+    StrategyPlan current = plan;
+    current.size = 0;
+    current.heading = start._theta;
+    const char *profileName = Tuner::profileName(profile);
+    Logger::infoln("# Strategie : ", plan.score, " points estimés, retour a la base a ", decimals(plan.total, 1), "s");
+    Logger::infoln("    set ", STRATEGY_SCORE_VARIABLE, " 0");
+    Logger::infoln("    set ", STRATEGY_DONE_VARIABLE, " 0");
+    for (int i = 0; i <= plan.size; i++)
+    {
+        uint8_t from = last(current);
+        uint8_t to = (i < plan.size) ? plan.order[i] : nbTasks;
+        float cap = mradOf(caps[from][to]) / 1000.0;
+        Vector target = (to == nbTasks) ? home : tasks[to].target;
+        Logger::infoln("# ", (to == nbTasks) ? homeName : tasks[to].name);
+        Logger::infoln("    spin ", decimals(cap, 3), " ", profileName, " timeout=", decimals(timeoutOf(spinTime(current.heading, caps[from][to])) / 10.0, 1), " mirror");
+        Logger::infoln("    goto ", decimals(target._x, 3), " ", decimals(target._y, 3), " ", decimals(cap, 3), " ", profileName,
+                       " curve=", decimals(STRATEGY_CURVE, 2), " timeout=", decimals(timeoutOf(moves[from][to]) / 10.0, 1), " mirror");
+        if (to == nbTasks)
+            break;
+        const StrategyTask &task = tasks[to];
+        Logger::infoln("    jump_failed after", i);
+        if (task.actuator < __NBMESSAGES__)
+        {
+            Logger::infoln("    send actu ", task.actuatorName, " ", task.orderName);
+            Logger::infoln("    sleep ", decimals(round(task.actuatorTime * 100) / 100.0, 2));
+        }
+        Logger::infoln("    add ", STRATEGY_SCORE_VARIABLE, " ", task.score);
+        Logger::infoln("    add ", STRATEGY_DONE_VARIABLE, " 1");
+        Logger::infoln("after", i, ":");
+        current.heading = caps[from][to];
+        current.order[current.size++] = to;
+    }
+    Logger::infoln("    end lock");
+}
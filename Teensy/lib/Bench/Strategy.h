@@ -0,0 +1,140 @@
+/**   Ensmasteel Library - Offline match strategy optimizer
+ * note : Cherche l'ordre des taches du match (gobelets, racks, manches...) qui maximise le score dans la durée du match :
+ *          1. durées estimées une fois pour toutes avec le Ghost (Planner::gotoDuration et spinDuration, les memes qu'a bord)
+ *             pour chaque trajet tache -> tache (spin vers la cible puis goto, comme StraightTo_Action) plus le temps d'actionneur,
+ *          2. beam search sur les ordres (tables de durées seulement : des milliers de candidats par seconde),
+ *             un ordre n'est gardé que s'il reste le temps de rentrer a la base,
+ *          3. les meilleurs ordres sont assemblés en bytecode (cf Program.h, verifié par Program::validate) et leurs mouvements
+ *             sont rejoués un par un sur HeadlessSim (asservissement et Simulator, VirtualClock : plus vite que le temps reel),
+ *             le score retenu est celui du match simulé (RobotSimu ne pilote ses moteurs qu'en contact des interrupteurs arriere),
+ *          4. le meilleur est affiché en C++ (pour Robot::Robot) et en texte pour tools/sequence_asm.py.
+ *        Les taches sont independantes (pas de capacité de stockage ni de bonus de paires).
+ *        Comme le Tuner (cf HostJobs.h) : sur le PC chaque ordre est rejoué dans son processus (tous les coeurs), sur la cible l'un apres l'autre.
+ *        La recherche reste dans un seul processus : les profondeurs s'enchainent et elle ne coute que quelques ms (millions de candidats/s)
+*/
+
+#ifndef STRATEGY_H_
+#define STRATEGY_H_
+
+#include "Arduino.h"
+#include "Vector.h"
+#include "MessageID.h"
+#include "MoveProfile.h"
+#include "HeadlessSim.h"
+#include "Planner.h"
+#include "HostJobs.h"
+
+#define STRATEGY_MAX_TASKS 24
+#define STRATEGY_BEAM_WIDTH 64          //Ordres partiels gardés a chaque profondeur
+#define STRATEGY_NB_VALIDATED 4         //Meilleurs ordres rejoués sur HeadlessSim
+#define STRATEGY_MATCH_DURATION 100.0   // [...] = s
+#define STRATEGY_SPIN_STEPS 16          //Table des durées de spin sur [0, PI]
+#define STRATEGY_CURVE PLANNER_CURVE    //deltaCurve des goto (celui de StraightTo_Action et des durées du Planner)
+#define STRATEGY_SCORE_VARIABLE 0       //Variables du programme (cf Program::variables) : score du match
+#define STRATEGY_DONE_VARIABLE 1        //                                                 et nombre de taches faites
+
+struct StrategyTask
+{
+    const char *name;    //Nom de la cible dans Robot::Robot
+    Vector target;       //Robot bleu
+    int16_t score;
+    float actuatorTime;  // [...] = s, attente apres l'ordre a l'actionneur
+    MessageID actuator;  //__NBMESSAGES__ : pas d'actionneur
+    Actuator_Order order;
+    const char *actuatorName, *orderName; //Pour le code affiché
+};
+
+struct StrategyPlan
+{
+    uint8_t order[STRATEGY_MAX_TASKS];
+    uint8_t size;
+    uint32_t done;     //Bit i : tache i faite
+    float time;        // [...] = s, fin de la derniere tache
+    float heading;     //Cap du robot a la fin de la derniere tache
+    int16_t score;
+    float total;       // [...] = s, time + retour a la base
+};
+
+struct StrategyResult
+{
+    StrategyPlan plan;
+    int32_t score;     //Score du match simulé
+    int32_t nbDone;
+    float time;        // [...] = s, arrivée a la base
+    bool home;         //Rentré a la base avant la fin du match
+    uint16_t size;     // [...] = octets, bytecode (0 : ne rentre pas dans un programme)
+};
+
+class Strategy
+{
+public:
+    MoveProfileName profile = standard;
+    float matchDuration = STRATEGY_MATCH_DURATION;
+    float margin = 3.0;     // [...] = s, marge de la recherche pour rentrer a la base (durées estimées un peu optimistes)
+    float timeWeight = 0.2; //Classement des ordres partiels : score - timeWeight * time (points par seconde)
+
+    // GOAL / Duration tables of every move between the tasks (Ghost)
+    void estimate();
+
+    // GOAL / Beam search of the task orders. Keeps the STRATEGY_NB_VALIDATED best ones
+    // OUT  / uint32_t : number of candidates evaluated
+    uint32_t search();
+
+    // GOAL / Replay every move of the best orders on the simulator, the best match is kept (cf best)
+    //        A move is simulated from its planned start (the ghost is recalibrated on the robot at each move start anyway)
+    void validate(HeadlessSim *sim);
+
+    // GOAL / Bytecode of an order (spin + goto + actionneur + score par tache, retour a la base, END)
+    // IN   / uint8_t *code : PROGRAM_MAX_SIZE bytes
+    // OUT  / uint16_t : size, 0 if it does not fit
+    uint16_t assemble(const StrategyPlan &plan, uint8_t *code);
+
+    void printCpp(const StrategyPlan &plan); //Lignes mainSequence->add(...) pour Robot::Robot
+    void printAsm(const StrategyPlan &plan); //Programme pour tools/sequence_asm.py
+
+    const StrategyResult &best() { return results[bestResult]; }
+
+    // IN   / const StrategyTask *tasks : must stay alive
+    //        VectorE start : starting pose (blue)
+    //        Vector home, const char *homeName : base at the end of the match (blue)
+    Strategy(const StrategyTask *tasks, uint8_t nbTasks, VectorE start, Vector home, const char *homeName);
+
+private:
+    struct Child //Extension d'un ordre du beam par une tache
+    {
+        uint32_t done;
+        float time;
+        float rank;
+        int16_t score;
+        uint8_t parent;
+        uint8_t task;
+    };
+
+    const StrategyTask *tasks;
+    uint8_t nbTasks;
+    VectorE start;
+    Vector home;
+    const char *homeName;
+
+    //Indice nbTasks : depart (ligne) ou base (colonne)
+    float caps[STRATEGY_MAX_TASKS + 1][STRATEGY_MAX_TASKS + 1];
+    float moves[STRATEGY_MAX_TASKS + 1][STRATEGY_MAX_TASKS + 1]; // [...] = s, goto seul
+    float spinTimes[STRATEGY_SPIN_STEPS + 1];
+
+    StrategyPlan beam[STRATEGY_BEAM_WIDTH], nextBeam[STRATEGY_BEAM_WIDTH];
+    Child children[STRATEGY_BEAM_WIDTH * STRATEGY_MAX_TASKS];
+    StrategyPlan finalists[STRATEGY_NB_VALIDATED];
+    uint8_t nbFinalists;
+    StrategyResult results[STRATEGY_NB_VALIDATED];
+    uint8_t bestResult;
+
+    float spinTime(float from, float to);
+    float leg(const StrategyPlan &plan, uint8_t to); //Trajet jusqu'a la tache to (ou la base si to == nbTasks), actionneur compris
+    uint8_t last(const StrategyPlan &plan) { return (plan.size == 0) ? nbTasks : plan.order[plan.size - 1]; }
+    void keep(const StrategyPlan &plan); //Candidat a la validation
+    void replay(const StrategyPlan &plan, HeadlessSim *sim, StrategyResult &result); //Match simulé d'un ordre
+    static void replayJob(uint16_t index, void *result, void *context);             //HostJob : replay du finaliste index
+    static uint8_t timeoutOf(float duration); //Timeout du bytecode (dixiemes de seconde) pour un mouvement estimé
+};
+
+#endif // !STRATEGY_H_
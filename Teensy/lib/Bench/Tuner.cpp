@@ -0,0 +1,237 @@
+#include "Tuner.h"
+#include "Logger.h"
+
+#define NB_TRANSLATION_MOVES 4
+#define NB_ROTATION_MOVES 3
+
+static const char *profileNames[__NBPROFILES__] = {"off", "brake", "accurate", "standard", "fast", "recallage"};
+static const char *lawNames[] = {"PID_LAW", "MPC_LAW", "RAMSETE_LAW"};
+
+static BenchMove translationMoves[NB_TRANSLATION_MOVES] = {
+    {VectorE(0.5, 1.0, 0.0), VectorE(1.0, 1.0, 0.0), 0.3, false, false},            //Petit pas
+    {VectorE(0.5, 1.0, 0.0), VectorE(2.0, 1.0, 0.0), 0.3, false, false},            //Grande ligne droite
+    {VectorE(1.5, 1.0, 0.0), VectorE(1.2, 1.0, 0.0), 0.3, false, true},             //Marche arriere
+    {VectorE(0.5, 0.5, 0.0), VectorE(1.5, 1.5, PI / 2), 0.5, false, false}};        //Courbe
+
+static BenchMove rotationMoves[NB_ROTATION_MOVES] = {
+    {VectorE(1.5, 1.0, 0.0), VectorE(1.5, 1.0, PI / 6), 0.0, true, false},
+    {VectorE(1.5, 1.0, 0.0), VectorE(1.5, 1.0, PI / 2), 0.0, true, false},
+    {VectorE(1.5, 1.0, 0.0), VectorE(1.5, 1.0, -0.95 * PI), 0.0, true, false}};
+
+Tuner::Tuner(HeadlessSim *sim)
+{
+    this->sim = sim;
+    this->current = nullptr;
+    this->nbEvaluations = 0;
+}
+
+void Tuner::apply(const float *params)
+{
+    current->KP = pow(10, params[0]) / RATIOPID;
+    current->KI = pow(10, params[1]) / RATIOPID;
+    current->KD = pow(10, params[2]) / RATIOPID;
+    current->KA = params[3];
+}
+
+float Tuner::benchmark()
+{
+    float out = 0.0;
+    uint8_t nbMoves = (translation) ? NB_TRANSLATION_MOVES : NB_ROTATION_MOVES;
+    BenchMove *moves = (translation) ? translationMoves : rotationMoves;
+    for (int i = 0; i < nbMoves; i++)
+    {
+        BenchResult result = sim->run(moves[i], currentName);
+        Score score = (translation) ? result.translation : result.rotation;
+        out += score.cumulError / current->epsilon + weightOvershoot * score.maxOvershoot / current->epsilon + weightInversion * score.nbInversion;
+        if (!result.finished)
+            out += penaltyNotFinished;
+    }
+    nbEvaluations++;
+    return out;
+}
+
+float Tuner::cost(const float *params)
+{
+    apply(params);
+    return benchmark();
+}
+
+float Tuner::evaluate(MoveProfileName profile, bool translation)
+{
+    this->currentName = profile;
+    this->translation = translation;
+    this->current = MoveProfiles::get(profile, translation);
+    return benchmark();
+}
+
+float Tuner::tune(MoveProfileName profile, bool translation)
+{
+    this->currentName = profile;
+    this->translation = translation;
+    this->current = MoveProfiles::get(profile, translation);
+    nbEvaluations = 0;
+
+    //Simplexe initial autour des gains actuels (les gains nuls sont remplacés par une petite valeur)
+    float simplex[TUNER_NB_PARAMS + 1][TUNER_NB_PARAMS];
+    float costs[TUNER_NB_PARAMS + 1];
+    simplex[0][0] = log10(max(current->KP * RATIOPID, 1e-3));
+    simplex[0][1] = log10(max(current->KI * RATIOPID, 1e-3));
+    simplex[0][2] = log10(max(current->KD * RATIOPID, 1e-3));
+    simplex[0][3] = current->KA;
+    for (int i = 1; i <= TUNER_NB_PARAMS; i++)
+    {
+        for (int j = 0; j < TUNER_NB_PARAMS; j++)
+            simplex[i][j] = simplex[0][j];
+        simplex[i][i - 1] += (i - 1 < 3) ? 0.5 : 0.2; //x3 sur les gains, +0.2 sur KA
+    }
+    for (int i = 0; i <= TUNER_NB_PARAMS; i++)
+        costs[i] = cost(simplex[i]);
+
+    float centroid[TUNER_NB_PARAMS], trial[TUNER_NB_PARAMS], trial2[TUNER_NB_PARAMS];
+    while (nbEvaluations < TUNER_MAX_EVALUATIONS)
+    {
+        //Tri du simplexe (le meilleur en 0)
+        for (int i = 1; i <= TUNER_NB_PARAMS; i++)
+            for (int k = i; k > 0 && costs[k] < costs[k - 1]; k--)
+            {
+                float tmp = costs[k];
+                costs[k] = costs[k - 1];
+                costs[k - 1] = tmp;
+                for (int j = 0; j < TUNER_NB_PARAMS; j++)
+                {
+                    tmp = simplex[k][j];
+                    simplex[k][j] = simplex[k - 1][j];
+                    simplex[k - 1][j] = tmp;
+                }
+            }
+        if (abs(costs[TUNER_NB_PARAMS] - costs[0]) <= TUNER_TOLERANCE * (abs(costs[0]) + 1e-6))
+            break;
+
+        for (int j = 0; j < TUNER_NB_PARAMS; j++)
+        {
+            centroid[j] = 0;
+            for (int i = 0; i < TUNER_NB_PARAMS; i++)
+                centroid[j] += simplex[i][j] / TUNER_NB_PARAMS;
+        }
+
+        //Reflexion
+        for (int j = 0; j < TUNER_NB_PARAMS; j++)
+            trial[j] = centroid[j] + (centroid[j] - simplex[TUNER_NB_PARAMS][j]);
+        float costTrial = cost(trial);
+
+        if (costTrial < costs[0])
+        {
+            //Expansion
+            for (int j = 0; j < TUNER_NB_PARAMS; j++)
+                trial2[j] = centroid[j] + 2 * (centroid[j] - simplex[TUNER_NB_PARAMS][j]);
+            float costTrial2 = cost(trial2);
+            float *best = (costTrial2 < costTrial) ? trial2 : trial;
+            for (int j = 0; j < TUNER_NB_PARAMS; j++)
+                simplex[TUNER_NB_PARAMS][j] = best[j];
+            costs[TUNER_NB_PARAMS] = min(costTrial, costTrial2);
+        }
+        else if (costTrial < costs[TUNER_NB_PARAMS - 1])
+        {
+            for (int j = 0; j < TUNER_NB_PARAMS; j++)
+                simplex[TUNER_NB_PARAMS][j] = trial[j];
+            costs[TUNER_NB_PARAMS] = costTrial;
+        }
+        else
+        {
+            //Contraction
+            for (int j = 0; j < TUNER_NB_PARAMS; j++)
+                trial2[j] = centroid[j] + 0.5 * (simplex[TUNER_NB_PARAMS][j] - centroid[j]);
+            float costTrial2 = cost(trial2);
+            if (costTrial2 < costs[TUNER_NB_PARAMS])
+            {
+                for (int j = 0; j < TUNER_NB_PARAMS; j++)
+                    simplex[TUNER_NB_PARAMS][j] = trial2[j];
+                costs[TUNER_NB_PARAMS] = costTrial2;
+            }
+            else
+            {
+                //Retrecissement vers le meilleur
+                for (int i = 1; i <= TUNER_NB_PARAMS; i++)
+                {
+                    for (int j = 0; j < TUNER_NB_PARAMS; j++)
+                        simplex[i][j] = simplex[0][j] + 0.5 * (simplex[i][j] - simplex[0][j]);
+                    costs[i] = cost(simplex[i]);
+                }
+            }
+        }
+    }
+
+    int iBest = 0;
+    for (int i = 1; i <= TUNER_NB_PARAMS; i++)
+        if (costs[i] < costs[iBest])
+            iBest = i;
+    apply(simplex[iBest]);
+    Logger::infoln(profileNames[profile], (translation) ? " translation" : " rotation", " : cost ", decimals(costs[iBest], 4), " after ", nbEvaluations, " evaluations");
+    return costs[iBest];
+}
+
+struct TunerJobs
+{
+    Tuner *tuner;
+    const MoveProfileName *profiles;
+};
+
+struct TunerResult
+{
+    MoveProfile profile;
+    float cost;
+};
+
+//Job 2i : translation du profil i, job 2i+1 : sa rotation
+static void tuneJob(uint16_t index, void *result, void *context)
+{
+    TunerJobs *jobs = (TunerJobs *)context;
+    TunerResult *out = (TunerResult *)result;
+    MoveProfileName profile = jobs->profiles[index / 2];
+    bool translation = (index % 2 == 0);
+    out->cost = jobs->tuner->tune(profile, translation);
+    out->profile = *MoveProfiles::get(profile, translation);
+}
+
+float Tuner::tuneAll(const MoveProfileName *profiles, uint8_t nbProfiles)
+{
+    TunerJobs jobs = {this, profiles};
+    TunerResult results[2 * __NBPROFILES__];
+    nbProfiles = min(nbProfiles, __NBPROFILES__);
+    for (int i = 0; i < 2 * nbProfiles; i++) //Resultat d'un job perdu : les gains d'avant
+    {
+        results[i].profile = *MoveProfiles::get(profiles[i / 2], i % 2 == 0);
+        results[i].cost = penaltyNotFinished;
+    }
+    uint16_t nbFailed = HostJobs::run(tuneJob, 2 * nbProfiles, results, sizeof(TunerResult), &jobs);
+    if (nbFailed > 0)
+        Logger::infoln("Tuner : ", nbFailed, " jobs lost, their gains are left as before");
+
+    float out = 0.0;
+    for (int i = 0; i < 2 * nbProfiles; i++)
+    {
+        *MoveProfiles::get(profiles[i / 2], i % 2 == 0) = results[i].profile;
+        out += results[i].cost;
+    }
+    return out;
+}
+
+const char *Tuner::profileName(MoveProfileName profile)
+{
+    return profileNames[profile];
+}
+
+void Tuner::printProfiles()
+{
+    for (int i = 0; i < __NBPROFILES__; i++)
+        for (int axis = 0; axis < 2; axis++)
+        {
+            bool translation = (axis == 0);
+            MoveProfile *p = MoveProfiles::get((MoveProfileName)i, translation);
+            Logger::infoln("get(", profileNames[i], ",", (translation) ? "true" : "false", ")->set(",
+                           decimals(p->KP * RATIOPID, 4), ",", decimals(p->KI * RATIOPID, 4), ",", decimals(p->KD * RATIOPID, 4), ",", decimals(p->KA, 3), ",",
+                           decimals(p->epsilon, 5), ",", decimals(p->dEpsilon, 5), ",", decimals(p->maxErr, 4), ",",
+                           decimals(p->speedRamps, 3), ",", decimals(p->cruisingSpeed, 3), ",", p->KF, ");");
+            Logger::infoln("get(", profileNames[i], ",", (translation) ? "true" : "false", ")->law = ", lawNames[p->law], ";");
+        }
+}
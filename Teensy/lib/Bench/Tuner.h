@@ -0,0 +1,59 @@
+/**   Ensmasteel Library - Offline PID tuner
+ * note : Optimise KP, KI, KD, KA of a MoveProfile with Nelder-Mead on a benchmark of simulated moves (HeadlessSim)
+ *        tuneAll : one job per profile and axis (cf HostJobs.h), in parallel processes on the host, one after the other on the target.
+ *        Every job starts from the same table (the translation of a profile is tuned with its rotation gains from before the run)
+*/
+
+#ifndef TUNER_H_
+#define TUNER_H_
+
+#include "HeadlessSim.h"
+#include "MoveProfile.h"
+#include "HostJobs.h"
+
+#define TUNER_NB_PARAMS 4          // log10(KP), log10(KI), log10(KD) (x RATIOPID) and KA
+#define TUNER_MAX_EVALUATIONS 150  // Budget of simulated benchmarks per profile
+#define TUNER_TOLERANCE 1e-3       // Stop when the simplex costs are this close
+
+class Tuner
+{
+public:
+    // Weights of the cost of one move. cumulError and maxOvershoot are normalized by the epsilon of the profile
+    float weightOvershoot = 1.0;
+    float weightInversion = 0.05;
+    float penaltyNotFinished = 1000.0;
+
+    // GOAL / Optimise the gains of one profile over the benchmark moves. The best gains are left in MoveProfiles
+    // IN   / MoveProfileName profile
+    //        bool translation : tune the translation (straight moves) or the rotation (spins) PID
+    // OUT  / float : cost of the best gains found
+    float tune(MoveProfileName profile, bool translation);
+
+    // GOAL / Tune the translation and the rotation of several profiles (cf HostJobs.h). The best gains are left in MoveProfiles
+    // IN   / const MoveProfileName *profiles, uint8_t nbProfiles
+    // OUT  / float : sum of the costs of the best gains found
+    float tuneAll(const MoveProfileName *profiles, uint8_t nbProfiles);
+
+    // GOAL / Cost of the current gains of a profile on the benchmark moves
+    float evaluate(MoveProfileName profile, bool translation);
+
+    // GOAL / Print the whole profile table on the infoPort, ready to paste in MoveProfiles::setup
+    static void printProfiles();
+
+    static const char *profileName(MoveProfileName profile);
+
+    Tuner(HeadlessSim *sim);
+
+private:
+    HeadlessSim *sim;
+    MoveProfile *current;
+    MoveProfileName currentName;
+    bool translation;
+    uint16_t nbEvaluations;
+
+    void apply(const float *params);
+    float cost(const float *params);
+    float benchmark();
+};
+
+#endif // !TUNER_H_
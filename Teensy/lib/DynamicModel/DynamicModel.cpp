@@ -0,0 +1,24 @@
+#include "DynamicModel.h"
+
+DynamicModel::DynamicModel(float size, float mass, float maxAcceleration, float maxSpeed)
+{
+    this->size = size;
+    this->mass = mass;
+    this->maxMotorForce = maxAcceleration * mass;
+    this->J = mass * size * size / 6.0;
+    this->friction = maxMotorForce / maxSpeed;
+}
+
+//m*a = (orderLeft+orderRight)*maxMotorForce - friction*(vLeft+vRight)
+//avec orderLeft+orderRight = 2*translation et vLeft+vRight = 2*v
+float DynamicModel::translationOrder(float acceleration, float speed)
+{
+    return (mass * acceleration + 2 * friction * speed) / (2 * maxMotorForce);
+}
+
+//J*alpha = ((orderRight-orderLeft)*maxMotorForce - friction*(vRight-vLeft))*size/2
+//avec orderRight-orderLeft = 2*rotation et vRight-vLeft = w*size
+float DynamicModel::rotationOrder(float acceleration, float speed)
+{
+    return (2 * J * acceleration / size + friction * speed * size) / (2 * maxMotorForce);
+}
@@ -0,0 +1,28 @@
+#ifndef DYNAMICMODEL_H_
+#define DYNAMICMODEL_H_
+
+/*
+* Modele dynamique du robot (partagé par le Simulator et l'Asservissement)
+* Chaque moteur exerce une force order*maxMotorForce, freinée par un frottement visqueux friction*v
+* Le robot est un carré de coté size avec les moteurs aux extrémités
+*/
+class DynamicModel
+{
+public:
+    float size;          //Size of one side of the robot, considering its template is a square. We also consider that the motors are at the extremity
+    float mass;          //Mass
+    float J;             //Rotational Inertie
+    float maxMotorForce; //Newton
+    float friction;      //friction  frictionForce=friction*(-V)
+
+    // GOAL / Inverse dynamics : order needed to follow a planned motion
+    // IN   / float acceleration, speed : planned acceleration and speed (m.s-2 and m.s-1, or rad.s-2 and rad.s-1)
+    // OUT  / float : translation (or rotation) order, not constrained to [-1,1]
+    float translationOrder(float acceleration, float speed);
+    float rotationOrder(float acceleration, float speed);
+
+    DynamicModel(float size, float mass, float maxAcceleration, float maxSpeed);
+    DynamicModel() {}
+};
+
+#endif // !DYNAMICMODEL_H_
@@ -2,134 +2,163 @@
 
 #include "Arduino.h"
 #include "Logger.h"
+#include "Clock.h"
 
+#define ERROR_LOG_MASK (ERROR_LOG_SIZE - 1)
 
-#define ERROR_BOX_SIZE 10 //Taille des boites d'envoie et reception
+ErrorManager::Slot ErrorManager::slots[ERROR_LOG_SIZE];
+volatile uint32_t ErrorManager::nextSequence = 0;
+volatile uint32_t ErrorManager::counts[__NBERROR__];
+volatile uint32_t ErrorManager::firstTimes[__NBERROR__];
+volatile uint32_t ErrorManager::lastTimes[__NBERROR__];
+volatile uint32_t ErrorManager::lastPublished[__NBERROR__];
+ErrorManager::Reaction ErrorManager::reactions[__NBERROR__];
+ErrorSubscriber ErrorManager::dispatcher;
 
-
-class ErrorBox
-{
-public:
-    Error pull();
-    Error peek();
-    void push(Error error);
-    int size();
-    bool empty = true;
-    void reset();
-
-private:
-    Error box[ERROR_BOX_SIZE];
-    uint8_t iFirstEntry = 0;
-    uint8_t iNextEntry = 0;
-};
-
-ErrorBox* ErrorManager::errorBox;
-float* ErrorManager::timeLastIn;
-
-Error ErrorBox::pull()
+void ErrorManager::raise(Error error)
 {
-    if (empty)
+    uint32_t now = Clock::microsFromISR();
+    uint32_t count = __atomic_add_fetch(&counts[error], 1, __ATOMIC_RELAXED);
+    if (count == 1)
+        firstTimes[error] = now;
+    lastTimes[error] = now;
+    if (count > 1 && now - lastPublished[error] < ERROR_MIN_INTERVAL)
+        return; //Deja publiée il y a peu : seulement comptée
+    lastPublished[error] = now;
+
+    //Publication : on reserve un numero, on ecrit la case, puis on la valide (les lecteurs ne lisent que les cases validées)
+    uint32_t sequence = __atomic_fetch_add(&nextSequence, 1, __ATOMIC_RELAXED);
+    Slot *slot = &slots[sequence & ERROR_LOG_MASK];
+    __atomic_store_n(&slot->sequence, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->event.error = error;
+    slot->event.time = now;
+    slot->event.count = count;
+    __atomic_store_n(&slot->sequence, sequence + 1, __ATOMIC_RELEASE);
+
+    const Reaction &reaction = reactions[error];
+    if (reaction.function != nullptr && reaction.immediate)
     {
-        Logger::infoln("The errorbox is empty");
-        //Dans ce cas on renvoie NO_ERROR
-        return NO_ERROR;
-    }
-    else
-    {
-        //On recupere l'erreur et on fait avancer le buffer
-        Error out = box[iFirstEntry];
-        iFirstEntry = (iFirstEntry + 1) % ERROR_BOX_SIZE;
-        empty = (iFirstEntry == iNextEntry);
-        return out;
+        ErrorEvent event = {error, now, count};
+        reaction.function(reaction.context, event);
     }
 }
 
-Error ErrorBox::peek()
+uint32_t ErrorManager::count(Error error)
 {
-    if (empty)
-    {
-        Logger::infoln("The errorbox is empty");
-        //Dans ce cas on renvoie NO_ERROR
-        return NO_ERROR;
-    }
-    else
-        return box[iFirstEntry];
+    return counts[error];
 }
 
-void ErrorBox::push(Error error)
+ErrorStats ErrorManager::stats(Error error)
 {
-    if ((iFirstEntry == iNextEntry) && !empty)
-        Logger::infoln("The mailbox is full");
-    //Dans ce cas on n'empile pas
-    else
-    {
-        //Sinon on empile et on fait avancer l'indice de la prochaine entrée
-        box[iNextEntry] = error;
-        iNextEntry = (iNextEntry + 1) % ERROR_BOX_SIZE;
-        empty = false;
-    }
+    ErrorStats out;
+    out.count = counts[error];
+    out.first = firstTimes[error];
+    out.last = lastTimes[error];
+    return out;
 }
 
-int ErrorBox::size()
+void ErrorManager::setReaction(Error error, ErrorReaction reaction, void *context, bool immediate)
 {
-    if (empty)
-        return 0;
-    else if (iNextEntry == iFirstEntry)
-        return ERROR_BOX_SIZE;
-    else
-        return (iNextEntry - iFirstEntry + ERROR_BOX_SIZE) % ERROR_BOX_SIZE; //Marche dans tous les cas
+    reactions[error].function = nullptr; //Pas de reaction a moitié ecrite si raise arrive en interruption
+    reactions[error].context = context;
+    reactions[error].immediate = immediate;
+    __atomic_store_n(&reactions[error].function, reaction, __ATOMIC_RELEASE);
 }
 
-void ErrorBox::reset()
+void ErrorManager::dispatch()
 {
-    iNextEntry = iFirstEntry;
-    empty = true;
+    ErrorEvent event;
+    while (dispatcher.poll(event))
+    {
+        const Reaction &reaction = reactions[event.error];
+        if (reaction.function != nullptr && !reaction.immediate)
+            reaction.function(reaction.context, event);
+    }
+    if (dispatcher.lost > 0)
+    {
+        LOG_INFOLN("ErrorManager : ", dispatcher.lost, " errors lost before dispatch");
+        dispatcher.lost = 0;
+    }
 }
 
-
-
-void ErrorManager::raise(Error error)
+void ErrorManager::print()
 {
-    if ((millis()/1e3 - timeLastIn[(int)error])>0.5)  //Une meme erreur ne peut rentrer qu'a 500ms d'intervalle
+    for (int i = 1; i < __NBERROR__; i++)
     {
-        errorBox->push(error);
-        timeLastIn[(int)error]=millis()/1e3;
+        ErrorStats error = stats((Error)i);
+        if (error.count > 0)
+            Logger::infoln("error ", i, " : count ", error.count, " first ", error.first, "us last ", error.last, "us");
     }
 }
 
 void ErrorManager::reset()
 {
-    errorBox->reset();
+    for (int i = 0; i < __NBERROR__; i++)
+    {
+        counts[i] = 0;
+        firstTimes[i] = 0;
+        lastTimes[i] = 0;
+        lastPublished[i] = 0;
+    }
 }
 
-void ErrorManager::popOldestError()
+void ErrorManager::setup()
 {
-    errorBox->pull();
+    reset();
+    for (int i = 0; i < __NBERROR__; i++)
+        reactions[i].function = nullptr;
+    dispatcher.catchUp();
 }
 
-Error ErrorManager::peekOldestError()
+ErrorSubscriber::ErrorSubscriber()
 {
-    return errorBox->peek();
+    lost = 0;
+    catchUp();
 }
 
-uint8_t ErrorManager::inWaiting()
+void ErrorSubscriber::catchUp()
 {
-    return errorBox->size();
+    cursor = __atomic_load_n(&ErrorManager::nextSequence, __ATOMIC_ACQUIRE);
 }
 
-void ErrorManager::setup(){
-    errorBox = new ErrorBox();
-    timeLastIn = new float[__NBERROR__];
-    for (int i=0;i<__NBERROR__;i++)
-        timeLastIn[i]=0;
+bool ErrorSubscriber::poll(ErrorEvent &event)
+{
+    while (true)
+    {
+        uint32_t head = __atomic_load_n(&ErrorManager::nextSequence, __ATOMIC_ACQUIRE);
+        if (head - cursor > ERROR_LOG_SIZE) //Les plus anciens ont été ecrasés
+        {
+            lost += head - cursor - ERROR_LOG_SIZE;
+            cursor = head - ERROR_LOG_SIZE;
+        }
+        if (cursor == head)
+            return false;
+
+        const ErrorManager::Slot *slot = &ErrorManager::slots[cursor & ERROR_LOG_MASK];
+        uint32_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        if ((int32_t)(sequence - (cursor + 1)) < 0)
+            return false; //En cours d'ecriture (raise interrompu) : on le lira au prochain appel
+        if (sequence == cursor + 1)
+        {
+            event = slot->event;
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) == sequence)
+            {
+                cursor++;
+                return true;
+            }
+        }
+        lost++; //Ecrasé par un evenement plus recent pendant la lecture
+        cursor++;
+    }
 }
 
-
-
-
-/*
-void ErrorManager::toTelemetry()
+bool ErrorSubscriber::received(Error error)
 {
-    if (inWaitingRx()>0)
-        Logger::toTelemetry("messId",String(extractID(peekOldestError())));
-}*/
+    bool out = false;
+    ErrorEvent event;
+    while (poll(event))
+        out |= (event.error == error);
+    return out;
+}
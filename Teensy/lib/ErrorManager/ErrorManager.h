@@ -1,8 +1,21 @@
+/**   Ensmasteel Library - Error bus
+ * note : ErrorManager::raise est appelable de partout, interruptions comprises : pas de verrou, pas d'allocation,
+ *        seulement des operations atomiques 32 bits (LDREX/STREX sur la teensy).
+ *        Chaque erreur a son compteur et les dates de sa premiere et de sa derniere occurrence (Clock::microsFromISR) : rien n'est perdu.
+ *        Les occurrences sont aussi publiées dans un anneau de ERROR_LOG_SIZE evenements, au plus une toutes les ERROR_MIN_INTERVAL
+ *        par erreur (une erreur qui se repete a chaque tour n'efface pas les autres). Chaque ErrorSubscriber lit l'anneau a son rythme
+ *        avec son propre curseur : tous les abonnés voient toutes les erreurs et personne ne les depile.
+ *        Un abonné qui prend plus de ERROR_LOG_SIZE evenements de retard perd les plus anciens (compté dans lost).
+ *        Table de reactions (ErrorManager::setReaction) : une fonction par erreur, appelée directement par raise (immediate : courte
+ *        et sure en interruption) ou par ErrorManager::dispatch depuis la boucle principale, sans que personne n'ait a scruter l'erreur.
+*/
+
 #ifndef ERRORMANAGER_H
 #define ERRORMANAGER_H
 #include "Arduino.h"
 
-class ErrorBox;
+#define ERROR_LOG_SIZE 16         //Evenements gardés pour les abonnés (puissance de 2)
+#define ERROR_MIN_INTERVAL 500000 // [...] = us, intervalle minimal entre deux publications d'une meme erreur (le compteur, lui, compte tout)
 
 enum Error
 {
@@ -11,21 +24,83 @@ enum Error
     __NBERROR__
 };
 
+struct ErrorEvent
+{
+    Error error;
+    uint32_t time;  // [...] = us, Clock::microsFromISR
+    uint32_t count; //Valeur du compteur de l'erreur a cette occurrence
+};
+
+struct ErrorStats
+{
+    uint32_t count;
+    uint32_t first, last; // [...] = us, Clock::microsFromISR (0 si count == 0)
+};
+
+typedef void (*ErrorReaction)(void *context, const ErrorEvent &event);
+
+/*
+* Curseur d'un lecteur du bus. Ne voit que les erreurs publiées apres sa creation (ou son dernier catchUp)
+*/
+class ErrorSubscriber
+{
+public:
+    uint32_t lost; //Evenements ecrasés avant d'avoir été lus
+
+    // GOAL / Read the next event
+    // OUT  / bool : false if there is nothing new
+    bool poll(ErrorEvent &event);
+
+    // GOAL / Read all the new events
+    // OUT  / bool : true if one of them was the error
+    bool received(Error error);
+
+    void catchUp(); //Ignore les evenements deja publiés
+
+    ErrorSubscriber();
+
+private:
+    uint32_t cursor; //Numero du prochain evenement a lire
+};
 
 class ErrorManager
 {
 public:
-    static void raise(Error error); //Signal l'erreur
-    static void popOldestError(); //Supprime la dernière erreur
-    static Error peekOldestError(); //Renvoie l'erreur la plus ancienne (sachant qu'a chaque tour, une Erreur est archivée)
-    static uint8_t inWaiting(); //Renvoie le nombre de message en attente dans la boite de reception
+    static void raise(Error error); //Signal l'erreur (appelable en interruption)
+
+    static uint32_t count(Error error); //Occurrences depuis setup/reset
+    static ErrorStats stats(Error error);
+
+    // GOAL / Set the function called for each published occurrence of the error
+    // IN   / ErrorReaction reaction : nullptr to remove it
+    //        bool immediate : called by raise (maybe in an interrupt), otherwise by dispatch
+    static void setReaction(Error error, ErrorReaction reaction, void *context = nullptr, bool immediate = false);
+
+    static void dispatch(); //Appelle les reactions differées des erreurs publiées depuis le dernier appel (boucle principale)
+    static void print();    //Compteurs sur Logger::info
     static void setup();
-    static void reset();
-//    void toTelemetry();
+    static void reset(); //Remet les compteurs a zero (les abonnés gardent leur curseur)
 
 private:
-    static ErrorBox* errorBox;
-    static float* timeLastIn;
+    struct Slot
+    {
+        volatile uint32_t sequence; //Numero de l'evenement + 1, 0 pendant l'ecriture
+        ErrorEvent event;
+    };
+    struct Reaction
+    {
+        ErrorReaction function;
+        void *context;
+        bool immediate;
+    };
+
+    static Slot slots[ERROR_LOG_SIZE];
+    static volatile uint32_t nextSequence; //Numero du prochain evenement publié
+    static volatile uint32_t counts[__NBERROR__];
+    static volatile uint32_t firstTimes[__NBERROR__], lastTimes[__NBERROR__], lastPublished[__NBERROR__];
+    static Reaction reactions[__NBERROR__];
+    static ErrorSubscriber dispatcher;
 
+    friend class ErrorSubscriber;
 };
 #endif
@@ -0,0 +1,102 @@
+#include "Estimator.h"
+
+void RLS2::reset(float theta0, float theta1, float covariance)
+{
+    theta[0] = theta0;
+    theta[1] = theta1;
+    P[0][0] = covariance;
+    P[1][1] = covariance;
+    P[0][1] = 0;
+    P[1][0] = 0;
+}
+
+void RLS2::update(float y, float phi0, float phi1)
+{
+    float Pphi0 = P[0][0] * phi0 + P[0][1] * phi1;
+    float Pphi1 = P[1][0] * phi0 + P[1][1] * phi1;
+    float denominator = ESTIMATOR_FORGET + phi0 * Pphi0 + phi1 * Pphi1;
+    float k0 = Pphi0 / denominator;
+    float k1 = Pphi1 / denominator;
+
+    float error = y - (theta[0] * phi0 + theta[1] * phi1);
+    theta[0] += k0 * error;
+    theta[1] += k1 * error;
+
+    //P = (P - k*phi'*P)/lambda (P symétrique : phi'*P = (P*phi)')
+    P[0][0] = (P[0][0] - k0 * Pphi0) / ESTIMATOR_FORGET;
+    P[0][1] = (P[0][1] - k0 * Pphi1) / ESTIMATOR_FORGET;
+    P[1][0] = P[0][1];
+    P[1][1] = (P[1][1] - k1 * Pphi1) / ESTIMATOR_FORGET;
+
+    float trace = P[0][0] + P[1][1];
+    if (trace > ESTIMATOR_MAX_COVARIANCE)
+    {
+        float ratio = ESTIMATOR_MAX_COVARIANCE / trace;
+        P[0][0] *= ratio;
+        P[0][1] *= ratio;
+        P[1][0] *= ratio;
+        P[1][1] *= ratio;
+    }
+}
+
+MotorEstimator::MotorEstimator(DynamicModel *model)
+{
+    this->model = model;
+    accelerationV = Filtre(0, ESTIMATOR_FILTER, DERIVATIVE);
+    accelerationW = Filtre(0, ESTIMATOR_FILTER, DERIVATIVE);
+    for (int i = 0; i < 2; i++)
+    {
+        orderF[i] = Filtre(0, ESTIMATOR_FILTER);
+        speedF[i] = Filtre(0, ESTIMATOR_FILTER);
+    }
+    reset();
+}
+
+void MotorEstimator::reset()
+{
+    for (int i = 0; i < 2; i++)
+        wheels[i].reset(model->maxMotorForce, model->friction, ESTIMATOR_INITIAL_COVARIANCE);
+}
+
+void MotorEstimator::update(float orderLeft, float orderRight, Cinetique cinetique, float dt)
+{
+    float orders[2] = {orderLeft, orderRight};
+    float speeds[2] = {cinetique._v - cinetique._w * model->size / 2, cinetique._v + cinetique._w * model->size / 2};
+
+    accelerationV.in(cinetique._v, dt);
+    accelerationW.in(cinetique._w, dt);
+    //m*dv/dt = forceLeft + forceRight ; J*dw/dt = (forceRight - forceLeft)*size/2
+    float sum = model->mass * accelerationV.out();
+    float difference = 2 * model->J * accelerationW.out() / model->size;
+    float forces[2] = {(sum - difference) / 2, (sum + difference) / 2};
+
+    for (int i = 0; i < 2; i++)
+    {
+        orderF[i].in(orders[i], dt);
+        speedF[i].in(speeds[i], dt);
+        if (abs(orderF[i].out()) < ESTIMATOR_MIN_ORDER && abs(speedF[i].out()) < ESTIMATOR_MIN_SPEED)
+            continue;
+        wheels[i].update(forces[i], orderF[i].out(), -speedF[i].out());
+        wheels[i].theta[0] = constrain(wheels[i].theta[0], ESTIMATOR_MIN_RATIO * model->maxMotorForce, ESTIMATOR_MAX_RATIO * model->maxMotorForce);
+        wheels[i].theta[1] = constrain(wheels[i].theta[1], ESTIMATOR_MIN_RATIO * model->friction, ESTIMATOR_MAX_RATIO * model->friction);
+    }
+}
+
+float MotorEstimator::compensateOrder(float order, bool right, float v)
+{
+    if (!compensate)
+        return order;
+    //gain*u' - friction*v = maxMotorForce*u - nominalFriction*v
+    RLS2 *wheel = &wheels[(right) ? 1 : 0];
+    return constrain((model->maxMotorForce * order + (wheel->theta[1] - model->friction) * v) / wheel->theta[0], -1.0, 1.0);
+}
+
+float MotorEstimator::getGain(bool right)
+{
+    return wheels[(right) ? 1 : 0].theta[0];
+}
+
+float MotorEstimator::getFriction(bool right)
+{
+    return wheels[(right) ? 1 : 0].theta[1];
+}
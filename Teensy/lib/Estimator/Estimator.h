@@ -0,0 +1,72 @@
+/**   Ensmasteel Library - Online identification of the motors
+ * note : Pour chaque roue : force = gain*order - friction*v (cf DynamicModel)
+ *        Les forces sont déduites des accelerations mesurées (m*dv/dt et J*dw/dt), les parametres (gain, friction)
+ *        sont estimés par moindres carrés recursifs avec oubli. Cout fixe par tick (2 parametres par roue).
+ *        La compensation corrige les ordres pour que chaque roue se comporte comme le modele nominal.
+*/
+
+#ifndef ESTIMATOR_H_
+#define ESTIMATOR_H_
+
+#include "Arduino.h"
+#include "Vector.h"
+#include "Filtre.h"
+#include "DynamicModel.h"
+
+#define ESTIMATOR_FORGET 0.995       //Facteur d'oubli des moindres carrés (memoire ~ 1/(1-lambda) ticks)
+#define ESTIMATOR_FILTER 8.0         // [...] = Hz, filtre commun aux accelerations, ordres et vitesses
+#define ESTIMATOR_MIN_ORDER 0.05     //En dessous (et a l'arret), pas assez d'excitation : on n'estime pas
+#define ESTIMATOR_MIN_SPEED 0.02     // [...] = m/s
+#define ESTIMATOR_INITIAL_COVARIANCE 1e3
+#define ESTIMATOR_MAX_COVARIANCE 1e4 //Borne de la trace de P (evite l'explosion quand l'excitation est faible)
+#define ESTIMATOR_MIN_RATIO 0.3      //Bornes des estimations par rapport au modele nominal
+#define ESTIMATOR_MAX_RATIO 3.0
+
+/*
+* Moindres carrés recursifs a 2 parametres : y = theta[0]*phi[0] + theta[1]*phi[1]
+*/
+class RLS2
+{
+public:
+    float theta[2];
+    void update(float y, float phi0, float phi1);
+    void reset(float theta0, float theta1, float covariance);
+    RLS2() {}
+
+private:
+    float P[2][2];
+};
+
+class MotorEstimator
+{
+public:
+    bool compensate = true; //Si false, on estime sans corriger les ordres
+
+    // GOAL / Update the estimation with the orders of the last period and the measured speeds
+    // IN   / float orderLeft, orderRight : orders applied during dt
+    //        Cinetique cinetique : measured speeds (v, w)
+    //        float dt
+    void update(float orderLeft, float orderRight, Cinetique cinetique, float dt);
+
+    // GOAL / Order to apply on a wheel so that it gives the force of the nominal model
+    // IN   / float order : order computed with the nominal model
+    //        bool right : which wheel
+    //        float v : speed of the wheel
+    // OUT  / float : compensated order (between -1 and 1)
+    float compensateOrder(float order, bool right, float v);
+
+    float getGain(bool right);     // [...] = N per unit of order
+    float getFriction(bool right); // [...] = N.s/m
+    void reset();
+
+    MotorEstimator(DynamicModel *model);
+    MotorEstimator() {}
+
+private:
+    DynamicModel *model;
+    RLS2 wheels[2]; //[0] gauche, [1] droite
+    Filtre accelerationV, accelerationW; //DERIVATIVE : vitesse -> acceleration
+    Filtre orderF[2], speedF[2];         //Meme filtre que les accelerations pour que les regresseurs soient en phase
+};
+
+#endif // !ESTIMATOR_H_
@@ -2,12 +2,78 @@
 #include "Vector.h"
 #include "Arduino.h"
 
+void Filtre::computeCoefficients(float dt)
+{
+    coeffDt = dt;
+    if (type == FIRST_ORDER)
+    {
+        //Euler implicite : y = (y_prec + x*dt*wc)/(wc*dt+1)
+        b0 = wc * dt / (wc * dt + 1);
+        b1 = 0;
+        b2 = 0;
+        a1 = -1 / (wc * dt + 1);
+        a2 = 0;
+        return;
+    }
+
+    //Transformation bilineaire avec precompensation de la frequence de coupure
+    float K = wc / tan(min(wc * dt / 2, 1.5f));
+    float norm = 1 / (K * K + K * wc / q + wc * wc);
+    a1 = 2 * (wc * wc - K * K) * norm;
+    a2 = (K * K - K * wc / q + wc * wc) * norm;
+    switch (type)
+    {
+    case LOWPASS:
+        b0 = wc * wc * norm;
+        b1 = 2 * b0;
+        b2 = b0;
+        break;
+    case NOTCH:
+        b0 = (K * K + wc * wc) * norm;
+        b1 = a1;
+        b2 = b0;
+        break;
+    case DERIVATIVE:
+        b0 = wc * wc * (2 / dt) * norm; //Derivée non precompensée : gain exactement 1 sur une rampe
+        b1 = 0;
+        b2 = -b0;
+        break;
+    default:
+        break;
+    }
+}
+
+float Filtre::dcGain()
+{
+    return (type == DERIVATIVE) ? 0.0 : 1.0;
+}
+
+void Filtre::prime()
+{
+    s2 = b2 * lastIn - a2 * lastValue;
+    s1 = b1 * lastIn - a1 * lastValue + s2;
+    primed = true;
+}
+
 void Filtre::in(float newRaw, float dt)
 {
     if (dt > 0.5)
-        lastValue = newRaw; //Le filtre n'a pas ete appelle pendant trop de temps
-    else
-        lastValue = (lastValue + newRaw * dt * wc) / (wc * dt + 1);
+    {
+        reset(newRaw); //Le filtre n'a pas ete appelle pendant trop de temps
+        return;
+    }
+    //Le dt mesuré par le Scheduler varie un peu a chaque appel : coefficients recalculés seulement sur un vrai changement
+    //de periode, et les etats sont gardés (re-amorcer a chaque recalcul ramenerait le filtre a une difference d'ordre 1)
+    if (fabs(dt - coeffDt) > FILTRE_DT_TOLERANCE * coeffDt)
+        computeCoefficients(dt);
+    if (!primed)
+        prime();
+
+    float y = b0 * newRaw + s1;
+    s1 = b1 * newRaw - a1 * y + s2;
+    s2 = b2 * newRaw - a2 * y;
+    lastIn = newRaw;
+    lastValue = y;
 }
 
 float Filtre::out()
@@ -15,15 +81,35 @@ float Filtre::out()
     return lastValue;
 }
 
-Filtre::Filtre(float initValue, float frequency)
+void Filtre::set(FilterType type, float frequency, float q)
 {
-    this->lastValue = initValue;
+    this->type = type;
     this->wc = 2 * PI * frequency;
+    this->q = q;
+    this->coeffDt = -1;
+    reset(lastIn);
 }
 
-Filtre::Filtre() {}
+FilterType Filtre::getType()
+{
+    return type;
+}
+
+Filtre::Filtre(float initValue, float frequency, FilterType type, float q)
+{
+    this->lastIn = initValue;
+    set(type, frequency, q);
+}
+
+Filtre::Filtre()
+{
+    this->lastIn = 0;
+    set(LOWPASS, 1.0);
+}
 
 void Filtre::reset(float value)
 {
-    lastValue = value;
+    lastIn = value;
+    lastValue = dcGain() * value;
+    primed = false;
 }
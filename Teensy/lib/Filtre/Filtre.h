@@ -2,15 +2,44 @@
 #define FILTRE_INCLUDED
 #include "Arduino.h"
 
+#define BUTTERWORTH_Q 0.70710678 //Facteur de qualité d'un Butterworth d'ordre 2
+#define FILTRE_DT_TOLERANCE 0.02 //Ecart relatif de dt au dela duquel les coefficients sont recalculés
+
+enum FilterType
+{
+    FIRST_ORDER, //Passe bas d'ordre 1 (l'ancien Filtre)
+    LOWPASS,     //Passe bas d'ordre 2 (Butterworth par défaut)
+    NOTCH,       //Coupe bande centré sur la frequence
+    DERIVATIVE   //Derivée filtrée par un passe bas d'ordre 2 : en entrée une position, en sortie une vitesse
+};
+
+/*
+* Filtre biquad (forme directe II transposée).
+* Les coefficients ne sont recalculés que lorsque dt change de plus de FILTRE_DT_TOLERANCE : a dt quasi fixe (jitter du Scheduler),
+* un appel a "in" coute 5 multiplications-additions
+*/
 class Filtre
 {
 public:
-    float lastValue;
-    float wc;
     void in(float newRaw, float dt);
     float out();
-    void reset(float value);
-    Filtre(float initValue, float frequency);
+    void reset(float value); //Place le filtre en regime permanent pour cette entrée
+    void set(FilterType type, float frequency, float q = BUTTERWORTH_Q); //Change le type de filtre (les coefficients seront recalculés)
+    FilterType getType();
+    Filtre(float initValue, float frequency, FilterType type = LOWPASS, float q = BUTTERWORTH_Q);
     Filtre();
+
+private:
+    FilterType type;
+    float wc, q;
+    float b0, b1, b2, a1, a2; //Coefficients normalisés (a0 = 1)
+    float s1, s2;             //Etats de la forme directe II transposée
+    float coeffDt;            //dt pour lequel les coefficients ont été calculés
+    float lastIn, lastValue;
+    bool primed;              //Les etats correspondent ils a lastIn/lastValue ?
+
+    void computeCoefficients(float dt);
+    void prime();
+    float dcGain();
 };
 #endif
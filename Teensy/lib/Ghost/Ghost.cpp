@@ -281,6 +281,7 @@ int Ghost::ActuatePosition(float dt)
     }
 
     Update_Speeds(posCurrent, posPrevious, dt);
+    Update_Accelerations();
 
     cinetiqueController = Get_Controller_Cinetique();
 
@@ -297,6 +298,74 @@ void Ghost::Update_Speeds(VectorE posNow, VectorE posLast, float dt)
     speedRotationalCurrent = normalizeAngle(posNow._theta - posLast._theta) / dt;
 }
 
+void Ghost::Update_Accelerations()
+{
+    if (locked || trajectoryFinished)
+    {
+        accelerationLinearCurrent = 0.0;
+        accelerationRotationalCurrent = 0.0;
+    }
+    else if (rotating)
+    {
+        accelerationLinearCurrent = 0.0;
+        accelerationRotationalCurrent = speedProfileRotation.df(t_delayed) * ((lengthTrajectory > 0) ? 1 : -1);
+    }
+    else
+    {
+        accelerationLinearCurrent = speedProfileLinear.df(t_delayed) * (backward ? -1.0 : 1.0);
+        accelerationRotationalCurrent = 0.0; // Curvature changes are left to the PID
+    }
+}
+
+void Ghost::Get_Future_Speeds(float dt, uint8_t n, float *linear, float *rotational)
+{
+    for (uint8_t k = 0; k < n; k++)
+    {
+        float tk = t_delayed + (k + 1) * dt;
+        if (locked || trajectoryFinished)
+        {
+            linear[k] = 0.0;
+            rotational[k] = 0.0;
+        }
+        else if (rotating)
+        {
+            linear[k] = 0.0;
+            rotational[k] = speedProfileRotation.f(tk) * ((lengthTrajectory > 0) ? 1 : -1);
+        }
+        else
+        {
+            linear[k] = speedProfileLinear.f(tk) * (backward ? -1.0 : 1.0);
+            rotational[k] = (tk < durationTrajectory) ? Planned_Rotational_Speed(tk, t_e_delayed) : 0.0;
+        }
+    }
+}
+
+float Ghost::Planned_Rotational_Speed(float time, float tE)
+{
+    // w = v * courbure = v * (x'y'' - y'x'') / |(x', y')|^3 (meme signe en marche arriere : le cap est retourné de PI)
+    float dx = trajectory_X.df(tE), dy = trajectory_Y.df(tE);
+    float normSquare = dx * dx + dy * dy;
+    if (normSquare < 1e-12)
+        return 0.0;
+    float cross = dx * trajectory_Y.ddf(tE) - dy * trajectory_X.ddf(tE);
+    return speedProfileLinear.f(time) * cross / (normSquare * sqrt(normSquare));
+}
+
+float Ghost::Get_Duration()
+{
+    return durationTrajectory;
+}
+
+float Ghost::Get_Linear_Acceleration()
+{
+    return accelerationLinearCurrent;
+}
+
+float Ghost::Get_Rotational_Acceleration()
+{
+    return accelerationRotationalCurrent;
+}
+
 Cinetique Ghost::Get_Controller_Cinetique()
 {
     Cinetique out;
@@ -60,6 +60,22 @@ public:
 
     Cinetique Get_Controller_Cinetique();
 
+    // GOAL / Planned accelerations of the ghost (from the speed profiles), used as feedforward by the controller
+    // OUT  / float : linear acceleration [...] = m/s^2 ; rotational acceleration [...] = rad/s^2
+    float Get_Linear_Acceleration();
+    float Get_Rotational_Acceleration();
+
+    // GOAL / Planned duration of the current trajectory
+    // OUT  / float : [...] = s
+    float Get_Duration();
+
+    // GOAL / Planned speeds of the controller's ghost (posDelayed) over the next n steps, used by predictive controllers
+    //        For curves the rotational speed is the planned speed times the curvature at posDelayed (held over the horizon)
+    // IN   / float dt : step of the horizon
+    //        uint8_t n : number of steps
+    // OUT  / float *linear, *rotational : planned speeds at t+dt, t+2dt ... t+n*dt (0 once the trajectory is over)
+    void Get_Future_Speeds(float dt, uint8_t n, float *linear, float *rotational);
+
 private:
     // ===    PARAMETERS    ===
     // ========================
@@ -82,6 +98,7 @@ private:
     float t_e = 0.0, t_e_delayed = 0.0;          // 0<t_e<1 virtual time of Bezier curves
     float durationTrajectory = 0.0, lengthTrajectory = 0.0;       // [...] = s ; [...] = (rotating ? rad : cm)
     float speedLinearCurrent = 0.0, speedRotationalCurrent = 0.0; // Current speeds
+    float accelerationLinearCurrent = 0.0, accelerationRotationalCurrent = 0.0; // Current planned accelerations
 
     // ===    STATE    ===
     // ===================
@@ -98,6 +115,8 @@ private:
     //      / float dt : delay between posNow and posLast
     // OUT  / float : speedLinearCurrent, speedRotationalCurrent
     void Update_Speeds(VectorE posNow, VectorE posLast, float dt);
+    void Update_Accelerations(); // Read planned accelerations on the speed profiles at t_delayed (those of posDelayed, tracked by the controller)
+    float Planned_Rotational_Speed(float time, float tE); // Curves : speed profile at time times the curvature of the Bezier curve at tE
     void Set_NewTrajectory(Polynome newTrajectoryX, Polynome newTrajectoryY, Trapezoidal_Function newSpeed); // store new trajectories
     int StateManager(); // Cancel coming movement if teleportation (movement > deltaPositionMax)
 };
@@ -0,0 +1,154 @@
+#include "ILC.h"
+#include "EEPROM.h"
+
+ILC::ILC(float *outTranslation, float *outRotation, Cinetique *cRobot, Cinetique *cGhost)
+{
+    this->outTranslation = outTranslation;
+    this->outRotation = outRotation;
+    this->cRobot = cRobot;
+    this->cGhost = cGhost;
+    this->current = nullptr;
+    this->nextReplaced = 0;
+    clear();
+}
+
+void ILC::clear()
+{
+    for (int i = 0; i < ILC_NB_TRACKS; i++)
+    {
+        tracks[i].key = ILC_NO_TRACK;
+        resetTrack(&tracks[i], 0);
+    }
+}
+
+void ILC::resetTrack(ILCTrack *track, uint16_t signature)
+{
+    track->signature = signature;
+    track->lastCost = 0;
+    track->gain = 1;
+    memset(track->correction, 0, sizeof(track->correction));
+}
+
+uint16_t ILC::signature(VectorE target, float deltaCurve, uint8_t profile, bool pureRotation, bool backward, float duration)
+{
+    //FNV-1a sur les valeurs arrondies (cm, centiradians, dixiemes de seconde) : insensible aux arrondis flottants
+    int32_t values[7] = {(int32_t)round(target._x * 100), (int32_t)round(target._y * 100), (int32_t)round(target._theta * 100),
+                         (int32_t)round(deltaCurve * 100), profile, (pureRotation << 1) | backward, (int32_t)round(duration * 10)};
+    uint32_t hash = 2166136261u;
+    const uint8_t *data = (const uint8_t *)values;
+    for (unsigned int i = 0; i < sizeof(values); i++)
+        hash = (hash ^ data[i]) * 16777619u;
+    return (uint16_t)(hash ^ (hash >> 16));
+}
+
+void ILC::startTrack(uint8_t sequence, uint8_t action, uint16_t signature, float duration)
+{
+    uint16_t key = ((uint16_t)sequence << 8) | action;
+    current = nullptr;
+    for (int i = 0; i < ILC_NB_TRACKS && current == nullptr; i++)
+        if (tracks[i].key == key)
+            current = &tracks[i];
+    for (int i = 0; i < ILC_NB_TRACKS && current == nullptr; i++)
+        if (tracks[i].key == ILC_NO_TRACK)
+            current = &tracks[i];
+    if (current == nullptr) //Toutes les tables sont prises : on recycle
+    {
+        current = &tracks[nextReplaced];
+        nextReplaced = (nextReplaced + 1) % ILC_NB_TRACKS;
+    }
+    if (current->key != key || current->signature != signature)
+    {
+        current->key = key;
+        resetTrack(current, signature);
+    }
+
+    memset(errorSum, 0, sizeof(errorSum));
+    memset(errorCount, 0, sizeof(errorCount));
+    samplePeriod = (max(duration, 0.01f) + ILC_SETTLE_TIME) / ILC_NB_SAMPLES;
+    t = 0;
+    cost = 0;
+}
+
+void ILC::apply(float dt)
+{
+    if (current == nullptr || !enabled)
+        return;
+
+    int k = (int)(t / samplePeriod);
+    t += dt;
+    if (k >= ILC_NB_SAMPLES) //Au dela de la table : ni apprentissage ni correction
+        return;
+
+    float lagBehind = (*cGhost - *cRobot) % (directeur(cRobot->_theta));
+    errorSum[0][k] += lagBehind;
+    errorSum[1][k] += normalizeAngle(cGhost->_theta - cRobot->_theta);
+    errorCount[k]++;
+    cost += abs(lagBehind) * dt;
+
+    *outTranslation = constrain(*outTranslation + current->correction[0][k] * ILC_ORDER_LSB, -1.0, 1.0);
+    *outRotation = constrain(*outRotation + current->correction[1][k] * ILC_ORDER_LSB, -1.0, 1.0);
+}
+
+void ILC::endTrack(bool learn)
+{
+    if (current == nullptr)
+        return;
+
+    if (learn && enabled)
+    {
+        //La derniere iteration a degradé le suivi : on apprend moins vite, sinon le gain remonte
+        if (current->lastCost > 0 && cost > current->lastCost)
+            current->gain *= ILC_GAIN_DECREASE;
+        else
+            current->gain = min(current->gain * ILC_GAIN_INCREASE, 1.0f);
+        current->lastCost = cost;
+
+        const float learning[2] = {ILC_LEARNING_TRANSLATION, ILC_LEARNING_ROTATION};
+        int lead = max((int)round(ILC_LEAD_TIME / samplePeriod), 1);
+        for (int axis = 0; axis < 2; axis++)
+        {
+            float error[ILC_NB_SAMPLES];
+            for (int k = 0; k < ILC_NB_SAMPLES; k++)
+            {
+                //Erreur moyenne ILC_LEAD_TIME plus tard (0 si le mouvement n'a pas duré jusque là)
+                int j = min(k + lead, ILC_NB_SAMPLES - 1);
+                error[k] = (errorCount[j] > 0) ? errorSum[axis][j] / errorCount[j] : 0;
+            }
+            for (int k = 0; k < ILC_NB_SAMPLES; k++)
+            {
+                //Filtre [1 2 1]/4 : l'apprentissage ne doit pas exciter les hautes frequences
+                float smooth = (error[max(k - 1, 0)] + 2 * error[k] + error[min(k + 1, ILC_NB_SAMPLES - 1)]) / 4;
+                float u = ILC_FORGET * current->correction[axis][k] + current->gain * learning[axis] * smooth / ILC_ORDER_LSB;
+                current->correction[axis][k] = (int8_t)constrain(round(u), -127, 127);
+            }
+        }
+    }
+    current = nullptr;
+}
+
+void ILC::load()
+{
+    if (EEPROM.read(ILC_EEPROM_ADDRESS) != ILC_EEPROM_MAGIC)
+    {
+        clear();
+        return;
+    }
+    uint8_t *data = (uint8_t *)tracks;
+    for (unsigned int i = 0; i < sizeof(tracks); i++)
+        data[i] = EEPROM.read(ILC_EEPROM_ADDRESS + 1 + i);
+}
+
+void ILC::save()
+{
+    for (int i = 0; i < ILC_NB_TRACKS; i++)
+        saveTrack(i);
+}
+
+void ILC::saveTrack(uint8_t index)
+{
+    EEPROM.update(ILC_EEPROM_ADDRESS, ILC_EEPROM_MAGIC);
+    uint8_t *data = (uint8_t *)&tracks[index];
+    int address = ILC_EEPROM_ADDRESS + 1 + index * sizeof(ILCTrack);
+    for (unsigned int i = 0; i < sizeof(ILCTrack); i++)
+        EEPROM.update(address + i, data[i]);
+}
@@ -0,0 +1,88 @@
+/**   Ensmasteel Library - Iterative learning control
+ * note : Les mouvements d'un match se repetent presque a l'identique d'un match a l'autre.
+ *        Pour chaque trajectoire (identifiée par sa sequence, l'indice de l'action et une signature de la cible et du profil),
+ *        on enregistre l'erreur de suivi et on apprend une table d'ordres de feedforward ajoutée a la sortie de l'Asservissement.
+ *        Une table dont la signature ne correspond plus (reflash, programme téléversé, Planner) repart de zero.
+ *        La table couvre le mouvement et ILC_SETTLE_TIME apres, rien n'est appliqué au dela (la fin est le travail du PID).
+ *        Si l'erreur d'un mouvement augmente par rapport a la fois precedente, le gain d'apprentissage de sa table est divisé par 2.
+ *        Budget memoire fixe : ILC_NB_TRACKS trajectoires de ILC_NB_SAMPLES echantillons sur 2 axes en int8
+ *        Sauvegarde en EEPROM par save() seulement, apres le match (saveILC) : jamais pendant un mouvement
+ *        Recherche O(1) a chaque tick (l'echantillon est calculé a partir du temps depuis le debut du mouvement)
+*/
+
+#ifndef ILC_H_
+#define ILC_H_
+
+#include "Arduino.h"
+#include "Vector.h"
+
+#define ILC_NB_TRACKS 16
+#define ILC_NB_SAMPLES 64
+#define ILC_NO_TRACK 0xFFFF
+#define ILC_ORDER_LSB (1.0 / 256) //Ordre représenté par une unité de la table (int8 : +-0.5 au maximum)
+#define ILC_LEARNING_TRANSLATION 20.0 //Ordre appris par metre d'erreur (projetée) et par iteration
+#define ILC_LEARNING_ROTATION 2.0     //Ordre appris par radian d'erreur et par iteration
+#define ILC_FORGET 0.98               //Oubli a chaque iteration (robustesse si le robot change)
+#define ILC_LEAD_TIME 0.1             // [...] = s, avance de phase : l'erreur arrive apres l'ordre qui l'a causée (au moins un echantillon)
+#define ILC_SETTLE_TIME 0.5           // [...] = s, la table couvre la durée du mouvement plus ce temps d'arrivée
+#define ILC_GAIN_DECREASE 0.5         //Gain de la table si son erreur a augmenté
+#define ILC_GAIN_INCREASE 1.25        //Sinon il remonte jusqu'a 1
+#define ILC_EEPROM_ADDRESS 0
+#define ILC_EEPROM_MAGIC 0x1D
+//ILC_NB_TRACKS*sizeof(ILCTrack) + 1 = 2241 octets sur les 4096 de l'EEPROM de la teensy 3.5
+
+struct ILCTrack
+{
+    uint16_t key;                              //(sequence << 8) | indice de l'action, ILC_NO_TRACK si libre
+    uint16_t signature;                        //Cible et profil du mouvement (cf ILC::signature)
+    float lastCost;                            //Erreur de translation cumulée la derniere fois (m.s), 0 : jamais joué
+    float gain;                                //Part du gain d'apprentissage (cf ILC_GAIN_DECREASE)
+    int8_t correction[2][ILC_NB_SAMPLES];      //[0] translation, [1] rotation
+};
+
+class ILC
+{
+public:
+    bool enabled = true;
+
+    // GOAL / Select the table of the move which starts (creates it, or clears it if the signature changed)
+    // IN   / uint8_t sequence, action : identify the trajectory
+    //        uint16_t signature : cf signature
+    //        float duration : planned duration of the move (sets the sampling of the table)
+    void startTrack(uint8_t sequence, uint8_t action, uint16_t signature, float duration);
+
+    // GOAL / Signature of a move : its table is only replayed on the same target, curve, profile and duration
+    static uint16_t signature(VectorE target, float deltaCurve, uint8_t profile, bool pureRotation, bool backward, float duration);
+
+    // GOAL / Record the tracking error and add the learnt correction to the orders (call after the controller)
+    // IN   / float dt
+    //        cRobot, cGhost
+    // OUT  / outTranslation, outRotation : orders + correction
+    void apply(float dt);
+
+    // GOAL / End of the move : update the table with the recorded error (if learn), then release the track
+    void endTrack(bool learn);
+
+    void load(); //Lit les tables en EEPROM (tables vides si l'EEPROM n'a jamais été écrite ou a une autre version)
+    void save(); //N'écrit en EEPROM que les octets qui ont changé (~2000 lectures : apres le match, pas pendant un mouvement)
+    void clear();
+
+    ILC(float *outTranslation, float *outRotation, Cinetique *cRobot, Cinetique *cGhost);
+    ILC() {}
+
+private:
+    ILCTrack tracks[ILC_NB_TRACKS];
+    float errorSum[2][ILC_NB_SAMPLES]; //Erreur cumulée par echantillon pendant le mouvement en cours
+    uint16_t errorCount[ILC_NB_SAMPLES];
+    ILCTrack *current;
+    float samplePeriod, t;
+    float cost;           //Erreur de translation cumulée du mouvement en cours (m.s)
+    uint8_t nextReplaced; //Table remplacée quand elles sont toutes utilisées
+    float *outTranslation, *outRotation;
+    Cinetique *cRobot, *cGhost;
+
+    void resetTrack(ILCTrack *track, uint16_t signature);
+    void saveTrack(uint8_t index);
+};
+
+#endif // !ILC_H_
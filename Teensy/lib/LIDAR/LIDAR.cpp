@@ -2,6 +2,7 @@
 #include "Arduino.h"
 #include "RPLidar.h"
 #include "Vector.h"
+#include "Clock.h"
 
 //points to check :
 //math fonctions : cos, sin , pow , sqrt
@@ -84,7 +85,7 @@ void LIDAR::detect()
                 //if an object is being detected and the curent point is close enougth to the last point
                 object_list[nb_object-1].points[object_list[nb_object-1].length] = p;
                 object_list[nb_object-1].length++;
-                object_list[nb_object-1].age = millis();
+                object_list[nb_object-1].age = Clock::millis();
                 //add a new point to the curent object            
             }
             else
@@ -173,7 +174,7 @@ void LIDAR::track()
             }
         }
     }
-    uint32_t t = millis();
+    uint32_t t = Clock::millis();
     for (int i = 0;i<nb_object-1;i++)
     {
         //clear all objects too old
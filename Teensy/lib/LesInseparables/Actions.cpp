@@ -1,10 +1,54 @@
 #include "Actions.h"
 #include "Robot.h"
 #include "Sequence.h"
+#include "ScoreHistory.h"
 
 //========================================ACTION GENERIQUES========================================
 Robot *Action::robot;
 
+static uint8_t actionArena[ACTION_ARENA_SIZE] __attribute__((aligned(8)));
+static ActionPool actionPool(actionArena, ACTION_ARENA_SIZE);
+static uint16_t actionArenaOverflows = 0;
+
+ActionPool::ActionPool(uint8_t *storage, size_t storageSize)
+{
+    this->storage = storage;
+    this->storageSize = storageSize;
+    size = 0;
+}
+
+void *ActionPool::allocate(size_t size)
+{
+    size = (size + 7) & ~(size_t)7; //Alignement de chaque action sur 8 octets
+    if (this->size + size > storageSize)
+        return nullptr;
+    void *out = storage + this->size;
+    this->size += size;
+    return out;
+}
+
+void *Action::operator new(size_t size)
+{
+    void *out = actionPool.allocate(size);
+    if (out == nullptr)
+    {
+        actionArenaOverflows++;
+        LOG_INFOLN("Action arena full (ACTION_ARENA_SIZE), heap used");
+        return ::operator new(size);
+    }
+    return out;
+}
+
+size_t Action::arenaUsed()
+{
+    return actionPool.used();
+}
+
+uint16_t Action::arenaOverflows()
+{
+    return actionArenaOverflows;
+}
+
 void Action::setPointer(Robot *robot_)
 {
     robot = robot_;
@@ -12,7 +56,7 @@ void Action::setPointer(Robot *robot_)
 
 void Action::start()
 {
-    timeStarted = millis() / 1e3;
+    timeStarted = Clock::micros();
     started = true;
 }
 
@@ -20,7 +64,19 @@ bool Action::hasFailed()
 {
     if (timeout < 0)
         return false;
-    return millis() / 1e3 > timeStarted + timeout;
+    return Clock::secondsSince(timeStarted) > timeout;
+}
+
+void Action::subscribe(SequenceName sequence)
+{
+    if (!done)
+        Wakeups::poll(sequence); //On ne sait pas ce qu'attend l'action
+}
+
+void Action::subscribeTimeout(SequenceName sequence)
+{
+    if (timeout >= 0 && started)
+        Wakeups::at(sequence, timeStarted + (uint64_t)(timeout * CLOCK_US_PER_S));
 }
 
 void Double_Action::doAtEnd()
@@ -44,6 +100,11 @@ bool Double_Action::isFinished()
         {
             action1->doAtEnd();
             action2->start();
+            if (mySequence != nullptr)
+            {
+                action2->subscribe(mySequence->getName()); //S'ajoute aux conditions de action1 jusqu'a la fin
+                Wakeups::wake(mySequence->getName());
+            }
         }
         return false;
     }
@@ -57,7 +118,13 @@ bool Double_Action::hasFailed()
         return action1->hasFailed();
 }
 
-Double_Action::Double_Action(float timeout, String name, int16_t require) : Action(name, timeout, require)
+void Double_Action::subscribe(SequenceName sequence)
+{
+    subscribeTimeout(sequence);
+    action1->subscribe(sequence); //action2 s'abonne a son start (isFinished)
+}
+
+Double_Action::Double_Action(float timeout, const char *name, int16_t require) : Action(name, timeout, require)
 {
     this->action1 = nullptr;
     this->action2 = nullptr;
@@ -67,50 +134,64 @@ Double_Action::Double_Action(float timeout, String name, int16_t require) : Acti
 
 void Move_Action::start()
 {
-    Logger::infoln("MOVE START");
+    LOG_INFOLN("MOVE START");
     robot->recalibrateGhost();
     int err;
     err = robot->ghost.Compute_Trajectory(posFinal, deltaCurve, MoveProfiles::get(profileName, !pureRotation)->speedRamps, MoveProfiles::get(profileName, !pureRotation)->cruisingSpeed, pureRotation, backward);
     if (err == 0)
-        Logger::debugln("Computation succeeded");
+        LOG_DEBUGLN("Computation succeeded");
     else
-        Logger::infoln("Computation failed");
+        LOG_INFOLN("Computation failed");
     robot->ghost.Lock(false);
     robot->controller.setCurrentProfile(profileName);
+    if (mySequence != nullptr)
+        robot->ilc.startTrack(mySequence->getName(), mySequence->getCurrentIndex(),
+                              ILC::signature(posFinal, deltaCurve, profileName, pureRotation, backward, robot->ghost.Get_Duration()),
+                              robot->ghost.Get_Duration());
     Action::start();
 }
 
 void Move_Action::doAtEnd()
 {
     //robot->controller.sendScoreToTelemetry();
-    robot->controller.reset();
+    bool success = robot->ghost.trajectoryIsFinished() && robot->controller.close;
+    ScoreHistory::record((mySequence != nullptr) ? mySequence->getName() : 0xFF, (mySequence != nullptr) ? mySequence->getCurrentIndex() : 0,
+                         profileName, Clock::secondsSince(timeStarted), success, robot->controller.getScore(true), robot->controller.getScore(false));
+    robot->controller.reset(false); //L'integrateur est transféré au mouvement suivant (pas de pause pour se stabiliser)
+    robot->ilc.endTrack(success); //On n'apprend pas d'un mouvement raté
 }
 
 bool Move_Action::isFinished()
 {
     bool out = robot->ghost.trajectoryIsFinished() && robot->controller.close;
     if (out)
-        Logger::infoln("MOVE FINISHED");
+        LOG_INFOLN("MOVE FINISHED");
     return out;
 }
 
+void Move_Action::subscribe(SequenceName sequence)
+{
+    Wakeups::onState(sequence, WAKE_GHOST_FINISHED | WAKE_CONTROLLER_CLOSE);
+    subscribeTimeout(sequence);
+}
+
 bool Move_Action::hasFailed()
 {
     if (Action::hasFailed())
     {
         if (!robot->controller.close)
         {
-            Logger::infoln("MOVE FAILED : robot too far");
+            LOG_INFOLN("MOVE FAILED : robot too far");
         }
         else
         {
-            Logger::infoln("MOVE FAILED : ghost not finished");
+            LOG_INFOLN("MOVE FAILED : ghost not finished");
         }
     }
     return /*asser->tooFar ||*/ Action::hasFailed();
 }
 
-Move_Action::Move_Action(float timeout, VectorE posFinal, float deltaCurve, MoveProfileName profileName, bool pureRotation, bool backward, String name, int16_t require) : Action(name, timeout, require)
+Move_Action::Move_Action(float timeout, VectorE posFinal, float deltaCurve, MoveProfileName profileName, bool pureRotation, bool backward, const char *name, int16_t require) : Action(name, timeout, require)
 {
     this->posFinal = posFinal;
     this->deltaCurve = deltaCurve;
@@ -159,7 +240,7 @@ Forward_Action::Forward_Action(float timeout, float dist, MoveProfileName profil
 void Forward_Action::start()
 {
     posFinal._theta = robot->cinetiqueCurrent._theta;
-    Logger::infoln(String(posFinal._theta));
+    LOG_INFOLN(posFinal._theta);
     posFinal._x = (robot->cinetiqueCurrent._x) + dist * cos(normalizeAngle(posFinal._theta));
     posFinal._y = (robot->cinetiqueCurrent._y) + dist * sin(normalizeAngle(posFinal._theta));
     Move_Action::start();
@@ -196,15 +277,24 @@ void StraightTo_Action::start()
     //X et Y sont déja miroiré à ce moment.
     Vector delta = Vector(x, y) - robot->cinetiqueCurrent;
     float cap = delta.angle();
-    spin = new Spin_Action(timeout, TargetVectorE(cap, true), profileName); //Donc il faut etre en absolu
-    goTo = new Goto_Action(timeout, TargetVectorE(x, y, cap, true), 0.1, profileName);
-    action1 = spin;
-    action2 = goTo;
+    spin.setPosFinal(VectorE(0, 0, cap)); //Donc il faut etre en absolu (x et y du spin sont modifiés par son start)
+    goTo.setPosFinal(VectorE(x, y, cap));
+    spin.rearm();
+    goTo.rearm();
     Double_Action::start();
 }
 
-StraightTo_Action::StraightTo_Action(float timeout, TargetVector target, MoveProfileName profileName, int16_t require) : Double_Action(timeout, "stTo", require)
+void StraightTo_Action::setTarget(Vector target)
 {
+    this->x = target._x;
+    this->y = target._y;
+}
+
+StraightTo_Action::StraightTo_Action(float timeout, TargetVector target, MoveProfileName profileName, int16_t require)
+    : Double_Action(timeout, "stTo", require), spin(timeout, TargetVectorE(0, true), profileName), goTo(timeout, TargetVectorE(0, 0, 0, true), 0.1, profileName)
+{
+    action1 = &spin;
+    action2 = &goTo;
     Vector targetV = target.getVector();
     this->x = targetV._x;
     this->y = targetV._y;
@@ -229,7 +319,7 @@ Send_Action::Send_Action(Message message, Communication *comm, int16_t require)
 
 void Send_Action::start()
 {   
-    Serial.println("Start");
+    LOG_DEBUGLN("Start");
     this->_commLocal->send(message);
     done = true;
     Action::start();
@@ -246,18 +336,27 @@ bool Wait_Message_Action::isFinished()
     return _commLocal->inWaitingRx() > 0 && extractID(_commLocal->peekOldestMessage()) == messageId;
 }
 
+void Wait_Message_Action::subscribe(SequenceName sequence)
+{
+    Wakeups::onMessage(sequence, messageId);
+    subscribeTimeout(sequence);
+}
+
 Switch_Message_Action::Switch_Message_Action(float timeout, Communication *comm, int16_t require) : Action("swch", timeout, require)
 {
-    this->doFct.clear();
-    this->onMessage.clear();
     this->_commLocal = comm;
     size = 0;
 }
 
 void Switch_Message_Action::addPair(MessageID messageId, Fct fct)
 {
-    this->onMessage.push_back(messageId);
-    this->doFct.push_back(fct);
+    if (size >= SWITCH_MAX_PAIRS)
+    {
+        LOG_INFOLN("Switch_Message_Action full (SWITCH_MAX_PAIRS)");
+        return;
+    }
+    this->onMessage[size] = messageId;
+    this->doFct[size] = fct;
     size++;
 }
 
@@ -277,16 +376,22 @@ bool Switch_Message_Action::isFinished()
     return false;
 }
 
-Send_Order_Action::Send_Order_Action(MessageID actuatorID, Actuator_Order actuatorOrder, float timeout, Communication *comm, boolean waitCompletion, int16_t require) : Double_Action(timeout, "Order",require)
+void Switch_Message_Action::subscribe(SequenceName sequence)
+{
+    for (int i = 0; i < size; i++)
+        Wakeups::onMessage(sequence, onMessage[i]);
+    subscribeTimeout(sequence);
+}
+
+Send_Order_Action::Send_Order_Action(MessageID actuatorID, Actuator_Order actuatorOrder, float timeout, Communication *comm, boolean waitCompletion, int16_t require)
+    : Double_Action(timeout, "Order", require), sendAction(newMessage(actuatorID, actuatorOrder, 0, 0, 0), comm), waitAction(actuatorID, -1, comm)
 {
     message = newMessage(actuatorID, actuatorOrder, 0, 0, 0);
-    sendAction = new Send_Action(message, comm);
-    waitAction = new Wait_Message_Action(actuatorID,-1, comm);
-    action1 = sendAction;
+    action1 = &sendAction;
     if(waitCompletion)
-        action2 = waitAction;
+        action2 = &waitAction;
     else
-        action2 = new Null_Action();
+        action2 = &nullAction;
 }
 
 
@@ -328,7 +433,12 @@ Sleep_Action::Sleep_Action(float timeToWait, int16_t require) : Action("ZZzz", -
 
 bool Sleep_Action::isFinished()
 {   
-    return millis() / 1e3 - timeStarted > timeToWait;
+    return Clock::secondsSince(timeStarted) > timeToWait;
+}
+
+void Sleep_Action::subscribe(SequenceName sequence)
+{
+    Wakeups::at(sequence, timeStarted + (uint64_t)(max(timeToWait, (float)0) * CLOCK_US_PER_S));
 }
 
 Null_Action::Null_Action() : Action("Null",-1)
@@ -341,9 +451,21 @@ Wait_Error_Action::Wait_Error_Action(Error error, float timeout, int16_t require
     this->error = error;
 }
 
+void Wait_Error_Action::start()
+{
+    Action::start();
+    errors.catchUp();
+}
+
 bool Wait_Error_Action::isFinished()
 {
-    return ErrorManager::inWaiting() > 0 && ErrorManager::peekOldestError() == error;
+    return errors.received(error);
+}
+
+void Wait_Error_Action::subscribe(SequenceName sequence)
+{
+    Wakeups::onError(sequence, error);
+    subscribeTimeout(sequence);
 }
 
 PauseSeq_Action::PauseSeq_Action(SequenceName nameSeq, bool lockGhost, int16_t require) : Action("paus", 0.1, require)
@@ -374,13 +496,14 @@ void ResumeSeq_Action::start()
 /*
 * /!\ Le timeout specifié dans la sequence d'ecoute "recallageListner" doit etre plus petit que celui ci
 */
-Recallage_Action::Recallage_Action(bool arriere, float dist, float timeout) : Double_Action(timeout, "recal")
+Recallage_Action::Recallage_Action(bool arriere, float dist, float timeout)
+    : Double_Action(timeout, "recal"), resumeListener(recallageListerName), backwardMove(timeout, dist, recallage), forwardMove(timeout, dist, recallage)
 {
-    action1 = new ResumeSeq_Action(recallageListerName);
+    action1 = &resumeListener;
     if (arriere)
-        action2 = new Backward_Action(timeout, dist, recallage);
+        action2 = &backwardMove;
     else
-        action2 = new Forward_Action(timeout, dist, recallage);
+        action2 = &forwardMove;
 }
 
 //========================================ACTION INPUT========================================
@@ -404,7 +527,7 @@ bool Wait_Tirette_Action::isFinished()
         done = true;
         if (digitalRead(pinIN))
         {
-            Logger::toTelemetry("Tirette", 0);
+            LOG_TELEMETRY("Tirette", 0);
             return true;
         }
         else
@@ -6,8 +6,10 @@
 #include "Communication.h"
 #include "SequenceName.h"
 #include "ErrorManager.h"
-#include <vector>
+#include "Clock.h"
+#include "Wakeups.h"
 #include <cstdint> //for macro INT16_MAX
+#include <new>     //placement new (ActionPool)
 
 class Robot;
 class Sequence;
@@ -15,6 +17,39 @@ typedef void (*Fct)(Robot *robot);
 
 //========================================ACTION GENERIQUES========================================
 #define NO_REQUIREMENT INT16_MAX
+#define SWITCH_MAX_PAIRS 8      //Switch_Message_Action : nombre maximal de couples (message, fonction)
+#define ACTION_ARENA_SIZE 8192 // [...] = octets, arene statique des "new Action" (les actions vivent jusqu'a la fin du match)
+
+/*
+* Reserve d'actions de capacité fixe : construction en place, jamais de destruction (les actions vivent jusqu'a la fin du match).
+* "new Action" utilise la reserve globale (ACTION_ARENA_SIZE, cf Action::operator new)
+*/
+class ActionPool
+{
+public:
+    // GOAL / Reserve size bytes (aligned on 8)
+    // OUT  / void* : nullptr if the pool is full
+    void *allocate(size_t size);
+
+    // GOAL / Build an action in the pool
+    // OUT  / T* : nullptr if the pool is full
+    template <typename T, typename... Args>
+    T *make(Args... args)
+    {
+        void *out = allocate(sizeof(T));
+        return (out == nullptr) ? nullptr : ::new (out) T(args...);
+    }
+
+    size_t used() { return size; }
+    size_t capacity() { return storageSize; }
+
+    ActionPool(uint8_t *storage, size_t storageSize); //storage aligné sur 8 octets
+
+private:
+    uint8_t *storage;
+    size_t storageSize;
+    size_t size;
+};
 
 /*
 * CLASSE ABSTRAITE. NE PAS INSTANCIER DIRECTEMENT
@@ -23,9 +58,9 @@ class Action
 {
 public:
     /*
-    * Le nom de l'action
+    * Le nom de l'action (chaine constante, en flash)
     */
-    String name;
+    const char *name;
 
     /*
     * La fonction start est appelé une fois au début de l'action si l'action désignée par le "requirement" a réussi
@@ -48,6 +83,13 @@ public:
     */
     virtual bool hasFailed();
 
+    /*
+    * Appelé juste apres start : declare les evenements qui peuvent terminer ou faire foirer l'action (cf Wakeups.h).
+    * La sequence n'appelle isFinished/hasFailed qu'a ces moments (et une fois juste apres le start).
+    * Par défaut : rien si l'action est deja terminée, sinon evaluée a chaque tour
+    */
+    virtual void subscribe(SequenceName sequence);
+
     /*
     * Passe à toutes les actions courantes et a venir un pointeur vers le robot
     */
@@ -57,11 +99,12 @@ public:
     * Cree une action de base
     * Cette classe est abstraite et ne dois pas être instanciée directement
     */
-    Action(String name = "Action", float timeout = 0.1, int16_t require = NO_REQUIREMENT)
+    Action(const char *name = "Action", float timeout = 0.1, int16_t require = NO_REQUIREMENT)
     {
         this->name = name;
         this->timeout = timeout;
         this->require = require;
+        this->mySequence = nullptr; //Reste nul pour les actions contenues dans une Double_Action
         done = false;
         started = false;
     }
@@ -71,6 +114,24 @@ public:
     */
     bool hasStarted() { return started; }
 
+    /*
+    * Remet l'action dans l'etat d'avant son premier start (actions membres d'une Double_Action, reutilisées)
+    */
+    void rearm()
+    {
+        done = false;
+        started = false;
+    }
+
+    /*
+    * "new Action" est servi par une ActionPool statique (Actions.cpp) : pas de tas, pas de fragmentation.
+    * Les actions ne sont jamais détruites. Si l'arene est pleine, on retombe sur le tas (arenaOverflows)
+    */
+    static void *operator new(size_t size);
+    static void operator delete(void *) {}
+    static size_t arenaUsed();
+    static uint16_t arenaOverflows();
+
     /*
     * Cette fonction est appelée en cas de réussite de l'action. Ne fait rien par défaut
     */
@@ -82,12 +143,15 @@ protected:
     bool done;
     bool started;
     float timeout;
-    float timeStarted;
+    uint64_t timeStarted; // [...] = us (Clock)
     static Robot *robot;
     Sequence *mySequence;
     int16_t require;
 
+    void subscribeTimeout(SequenceName sequence); //Reveil a l'echeance du timeout (s'il y en a un)
+
     friend class Sequence;
+    friend class Program; //Construit et pilote les actions des instructions bloquantes
 };
 
 /*
@@ -106,8 +170,9 @@ public:
     virtual void start();
     virtual bool isFinished();
     virtual bool hasFailed();
+    void subscribe(SequenceName sequence) override; //(Double) timeout et conditions de l'action en cours
     void doAtEnd() override;
-    Double_Action(float timeout, String name = "Twin", int16_t require = NO_REQUIREMENT);
+    Double_Action(float timeout, const char *name = "Twin", int16_t require = NO_REQUIREMENT);
 };
 
 //========================================ACTION MOVES========================================
@@ -115,7 +180,7 @@ public:
 /*
 * Une Move Action est une action qui va donner un nouvel ordre au ghost
 * Lors de l'appel de "start", la position cible est donnée au ghost qui va ensuite s'y rendre (le ghoost est alors delock si necessaire)
-* Par défaut, les PID sont reset (Iterm) à la fin de l'action
+* Par défaut, les scores des PID sont reset à la fin de l'action. L'integrateur est conservé pour enchainer les mouvements
 */
 class Move_Action : public Action //Classe abstraite
 {
@@ -123,9 +188,11 @@ public:
     virtual void start();      //(Action+Move)Dump les parametres dans le ghost et appelle Action::start() et debloque le ghost
     virtual bool isFinished(); //(Move) Verifie que le ghost est arrive et que le robot est sur le ghost
     virtual bool hasFailed();  //(Action+Move) Verifie que le pid n'a pas retourné d'erreur ou que Action::hasFailed n'est pas true
+    void subscribe(SequenceName sequence) override; //(Move) ghost arrivé et asservissement proche, timeout
     void doAtEnd() override;
     Move_Action(float timeout, VectorE posFinal, float deltaCurve,
-                MoveProfileName profileName, bool pureRotation, bool backward, String name = "Move", int16_t require = NO_REQUIREMENT);
+                MoveProfileName profileName, bool pureRotation, bool backward, const char *name = "Move", int16_t require = NO_REQUIREMENT);
+    void setPosFinal(VectorE posFinal) { this->posFinal = posFinal; } //En absolu (deja miroiré)
 
 protected:
     VectorE posFinal;
@@ -210,14 +277,15 @@ public:
 class StraightTo_Action : public Double_Action
 {
 private:
-    Spin_Action *spin;
-    Goto_Action *goTo;
+    Spin_Action spin;
+    Goto_Action goTo;
     float x, y;
     MoveProfileName profileName;
     float timeout;
 
 public:
     void start();
+    void setTarget(Vector target); //Nouvelle cible (deja miroirée), prise en compte au prochain start (cf Planner)
     StraightTo_Action(float timeout, TargetVector target, MoveProfileName profileName, int16_t require = NO_REQUIREMENT);
 };
 
@@ -263,17 +331,30 @@ public:
     Wait_Message_Action(MessageID messageId, float timeout, Communication* comm, int16_t require = NO_REQUIREMENT);
     //start(Action)
     bool isFinished(); //(Wait_Message) verifie que le message est recu
+    void subscribe(SequenceName sequence) override; //(Wait_Message) le message, timeout
     //hasFailed(Action)
 };
 
+/*
+* Ne fais rien.
+* Permet d'annuler une action d'un Double_Action.
+*/
+class Null_Action : public Action
+{
+public:
+    Null_Action();
+    bool isFinished() {return true;}
+    bool hasFailed() {return false;}
+};
+
 /*
 * Permet d'assigner une Function par message possible
 */
 class Switch_Message_Action : public Action
 {
 private:
-    std::vector<MessageID> onMessage;
-    std::vector<Fct> doFct;
+    MessageID onMessage[SWITCH_MAX_PAIRS];
+    Fct doFct[SWITCH_MAX_PAIRS];
     uint8_t size;
     Communication* _commLocal;
 
@@ -282,6 +363,7 @@ public:
     void addPair(MessageID messageId, Fct fct);
     //start : inherited from Action
     bool isFinished();
+    void subscribe(SequenceName sequence) override; //(Switch) les messages des couples, timeout
     //has failed : inherited from Action
 };
 
@@ -292,8 +374,9 @@ public:
 class Send_Order_Action : public Double_Action
 {
 private:
-    Send_Action* sendAction;
-    Wait_Message_Action* waitAction;
+    Send_Action sendAction;
+    Wait_Message_Action waitAction;
+    Null_Action nullAction;
 
     Message message;
 public:
@@ -313,21 +396,11 @@ private:
 
 public:
     Sleep_Action(float timeToWait, int16_t require = NO_REQUIREMENT);
+    void setDuration(float timeToWait) { this->timeToWait = timeToWait; } //Prise en compte au prochain start (cf Planner)
     //start(Action)
     bool isFinished();                 //(Sleep) verifie que le temps prévu s'est ecoulé
     bool hasFailed() { return false; } //(Sleep) on en peut pas fail d'attendre
-};
-
-/*
-* Ne fais rien.
-* Permet d'annuler une action d'un Double_Action.
-*/
-class Null_Action : public Action
-{
-public:
-    Null_Action();
-    bool isFinished() {return true;}
-    bool hasFailed() {return false;}
+    void subscribe(SequenceName sequence) override; //(Sleep) la fin de l'attente
 };
 
 /*
@@ -349,6 +422,7 @@ public:
     void start();
     bool isFinished() { return done; }
     bool hasFailed() { return false; }
+    void subscribe(SequenceName sequence) override {} //(End) n'attend rien : terminée des le start (loop) ou jamais
 };
 
 /*
@@ -398,16 +472,23 @@ class Wait_Error_Action : public Action
 {
 private:
     Error error;
+    ErrorSubscriber errors; //Abonné au bus des erreurs (cf ErrorManager.h)
 
 public:
     Wait_Error_Action(Error error, float timeout, int16_t require = NO_REQUIREMENT);
-    //void start();
+    void start();      //(Action+Wait_Error) Ignore les erreurs arrivées avant le debut de l'action
     bool isFinished(); //(Wait_Error) verifie que l'erreur s'est produite
+    void subscribe(SequenceName sequence) override; //(Wait_Error) l'erreur, timeout
     //hasFailed(Action)
 };
 
 class Recallage_Action : public Double_Action
 {
+private:
+    ResumeSeq_Action resumeListener;
+    Backward_Action backwardMove;
+    Forward_Action forwardMove;
+
 public:
     Recallage_Action(bool arriere, float dist, float timeout);
 };
@@ -1,4 +1,10 @@
 #include "Codeuse.h"
+#include "Logger.h"
+#include <new>
+
+//Les Encoder sont construits une seule fois (placement new) dans ce pool : les Codeuse peuvent etre copiées
+static uint8_t encoderPool[CODEUSE_MAX_ENCODERS][sizeof(Encoder)] __attribute__((aligned(8)));
+static uint8_t nbEncoders = 0;
 
 Interrupteur::Interrupteur(uint8_t pin)
 {
@@ -9,6 +15,8 @@ Interrupteur::Interrupteur(uint8_t pin)
 
 void Interrupteur::updateContact()
 {
+    if (pin == 0xFF)
+        return;
     contact = (digitalRead(pin) == LOW);
 }
 
@@ -19,16 +27,43 @@ bool Interrupteur::isContact()
 
 void Codeuse::actuate(float dt)
 {
-    ticks = enc->read();                                                    //On recupère les ticks de l'objet Encoder (automatiquement mis a jour par interruptions cf cours ISE)
+    ticks = (enc != nullptr) ? enc->read() : 0;                                                    //On recupère les ticks de l'objet Encoder (automatiquement mis a jour par interruptions cf cours ISE)
     deltaAvance = (ticks - oldTicks) * (PI * diametreRoue) / ticksPerRound; //Simple géométrie
-    v = deltaAvance / dt;
     debug += deltaAvance;
     oldTicks = ticks;
+    if (!filterVelocity)
+        v = deltaAvance / dt;
+    else
+    {
+        vF.in((vF.getType() == DERIVATIVE) ? debug : deltaAvance / dt, dt);
+        v = vF.out();
+    }
+}
+
+void Codeuse::setVelocityFilter(FilterType type, float frequency)
+{
+    vF.set(type, frequency);
+    vF.reset((type == DERIVATIVE) ? debug : v);
+    filterVelocity = true;
+}
+
+float Codeuse::readSpeed(float dt)
+{
+    int32_t t = (enc != nullptr) ? enc->read() : 0;
+    wheelF.in((t - innerOldTicks) * (PI * diametreRoue) / ticksPerRound / dt, dt);
+    innerOldTicks = t;
+    return wheelF.out();
 }
 
 Codeuse::Codeuse(uint8_t pinA, uint8_t pinB, uint16_t ticksPerRound, float diametreRoue)
 {
-    enc = new Encoder(pinA, pinB); //Objet Encoder de la librairie Encoder.
+    if (nbEncoders < CODEUSE_MAX_ENCODERS)
+        enc = new (encoderPool[nbEncoders++]) Encoder(pinA, pinB); //Objet Encoder de la librairie Encoder.
+    else
+    {
+        LOG_INFOLN("Encoder pool full (CODEUSE_MAX_ENCODERS)");
+        enc = nullptr;
+    }
     this->diametreRoue = diametreRoue;
     this->ticksPerRound = ticksPerRound; //Nombe de ticks par tour
     ticks = 0;
@@ -36,9 +71,15 @@ Codeuse::Codeuse(uint8_t pinA, uint8_t pinB, uint16_t ticksPerRound, float diame
     v = 0.0;
     deltaAvance = 0;
     debug = 0;
+    filterVelocity = false;
+    innerOldTicks = 0;
+    wheelF = Filtre(0, WHEEL_SPEED_FILTER);
 }
 
-Codeuse::Codeuse() {}
+Codeuse::Codeuse()
+{
+    enc = nullptr;
+}
 
 void Odometrie::updateCinetique(float dt)
 {
@@ -50,8 +91,8 @@ void Odometrie::updateCinetique(float dt)
     cinetique->normalizeTheta();
     (*cinetique) += directeur(cinetique->_theta) * ((codeuseDroite.deltaAvance + codeuseGauche.deltaAvance) / 2);
 
-    interGauche->updateContact();
-    interDroite->updateContact();
+    interGauche.updateContact();
+    interDroite.updateContact();
 }
 
 Odometrie::Odometrie(){}
@@ -65,17 +106,23 @@ Odometrie::Odometrie(uint16_t ticksPerRound, Cinetique *cinetique, float eloigne
     codeuseDroite = Codeuse(pinACodeuseDroite, pinBCodeuseDroite, ticksPerRound, diametreRoueDroite);
     this->cinetique = cinetique;
     this->eloignementCodeuses = eloignementCodeuses;
-    interGauche = new Interrupteur(pinInterGauche);
-    interDroite = new Interrupteur(pinInterDroite);
+    interGauche = Interrupteur(pinInterGauche);
+    interDroite = Interrupteur(pinInterDroite);
+}
+
+void Odometrie::setVelocityFilter(FilterType type, float frequency)
+{
+    codeuseGauche.setVelocityFilter(type, frequency);
+    codeuseDroite.setVelocityFilter(type, frequency);
 }
 
 bool Odometrie::getInterDroiteContact()
 {
-    return interDroite->isContact();
+    return interDroite.isContact();
 }
 
 bool Odometrie::getInterGaucheContact()
 {
-    return interGauche->isContact();
+    return interGauche.isContact();
 }
 
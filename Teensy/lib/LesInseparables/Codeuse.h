@@ -3,6 +3,10 @@
 
 #include "Vector.h"
 #include "Arduino.h"
+#include "Filtre.h"
+
+#define WHEEL_SPEED_FILTER 150.0 // [...] = Hz, filtre de la vitesse lue par la boucle de vitesse (readSpeed)
+#define CODEUSE_MAX_ENCODERS 2    //Taille du pool statique des Encoder (leurs interruptions pointent sur eux : ils ne doivent pas bouger)
 
 #ifndef STM32BOTH
 #include <Encoder.h>
@@ -23,6 +27,7 @@ class Interrupteur
         bool contact;
     public:
         Interrupteur(uint8_t pin);
+        Interrupteur() : pin(0xFF), contact(false) {} //Sans pin : jamais en contact
         void updateContact();
         bool isContact();
 };
@@ -33,12 +38,18 @@ class Codeuse
     float debug;             //Distance parcourue par la codeuse depuis l'alllumage
     float diametreRoue;
     uint16_t ticksPerRound; //Nombre de ticks par tours de roue
-    Encoder *enc;           //Objet Encoder de la librairie Encoder.
+    Encoder *enc;           //Objet Encoder de la librairie Encoder, dans le pool statique de Codeuse.cpp
+    Filtre vF;              //Filtre de la vitesse (DERIVATIVE : derivée filtrée de la distance parcourue)
+    bool filterVelocity;
+    int32_t innerOldTicks;  //Ticks au dernier appel de readSpeed (independant d'actuate)
+    Filtre wheelF;          //Filtre de la vitesse lue par readSpeed
 
 public:
     float v, deltaAvance; //Vitesse et avance du robot AU NIVEAU DE LA ROUE CODEUSE
     int32_t ticks;
     void actuate(float dt); //Actualise (transforme les ticks en vitesse puis en avance)
+    void setVelocityFilter(FilterType type, float frequency); //Filtre la vitesse (par défaut la vitesse n'est pas filtrée)
+    float readSpeed(float dt); //Vitesse filtrée pour la boucle de vitesse (1kHz), ne touche pas a l'odometrie
     Codeuse();
     Codeuse(uint8_t pinA, uint8_t pinB, uint16_t ticksPerRound, float diametreRoue);
 };
@@ -48,7 +59,7 @@ class Odometrie
 {
 private:
     //Codeuse codeuseGauche, codeuseDroite;
-    Interrupteur *interGauche, *interDroite;
+    Interrupteur interGauche, interDroite;
     Cinetique *cinetique;
     float eloignementCodeuses;
 
@@ -62,6 +73,7 @@ public:
               uint8_t pinInterDroite, uint8_t pinInterGauche);
     bool getInterDroiteContact();
     bool getInterGaucheContact();
+    void setVelocityFilter(FilterType type, float frequency);
 };
 
 
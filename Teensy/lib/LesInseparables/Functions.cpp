@@ -1,6 +1,7 @@
 #include "Functions.h"
 #include "Actions.h"
 #include "Robot.h"
+#include "Planner.h"
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter" //Retire le warning "unused parameter"
@@ -12,12 +13,12 @@ void PID_tweak(Robot *robot)
     bool incr = fBytes.byte0 == 1;
     bool translation = fBytes.byte1 == 1;
     uint8_t whichOne = fBytes.byte2; //0 = P, 1 = I, 2 = D
-    Logger::infoln(String(robot->controller.tweak(incr, translation, whichOne)));
+    LOG_INFOLN(robot->controller.tweak(incr, translation, whichOne));
 }
 
 void ping(Robot *robot)
 {
-    Logger::infoln("ping");
+    LOG_INFOLN("ping");
 }
 
 void shutdown(Robot *robot)
@@ -25,12 +26,19 @@ void shutdown(Robot *robot)
     for (int i = 0; i < __NBSEQUENCES__; i++)
         robot->getSequenceByName((SequenceName)i)->pause(true);
     robot->controller.setCurrentProfile(off);
-    Logger::infoln("SHUTDOWN");
+    LOG_INFOLN("SHUTDOWN");
+}
+
+//Ecriture des tables de l'ILC en EEPROM : robot arreté uniquement (plusieurs ms de lectures/ecritures)
+void saveILC(Robot *robot)
+{
+    robot->ilc.save();
+    LOG_INFOLN("ILC SAVED");
 }
 
 void setTimeStart(Robot *robot)
 {
-    robot->timeStarted = millis() / 1e3;
+    robot->timeStarted = Clock::micros();
 }
 
 void startBackHomeSeq(Robot *robot)
@@ -47,18 +55,18 @@ void startBackHomeSeq(Robot *robot)
 void setNorth(Robot *robot)
 {
     robot->endNorth = true;
-    Logger::infoln("I will go North");
+    LOG_INFOLN("I will go North");
 }
 
 void setSouth(Robot *robot)
 {
     robot->endNorth = false;
-    Logger::infoln("I will go South");
+    LOG_INFOLN("I will go South");
 }
 
 void recallageBordure(Robot *robot)
 {
-    Logger::infoln("recallage bordure");
+    LOG_INFOLN("recallage bordure");
     if (abs(normalizeAngle(robot->cinetiqueCurrent._theta - 0.0)) < DEG_TO_RAD * 45) //On fait un recallage X en regardant vers theta==0
     {
         if (abs(robot->cinetiqueCurrent._x - robot->backLength) < 0.40)              // C'est un recallage arrière
@@ -66,7 +74,7 @@ void recallageBordure(Robot *robot)
         else if (abs(robot->cinetiqueCurrent._x - (3.0 - robot->frontLength)) < 0.40) //C'est un recallage avant
             robot->move(VectorE(3.0 - robot->frontLength, robot->cinetiqueCurrent._y, 0.0));
         else
-            Logger::infoln("ERREUR RECALLAGE x look east");
+            LOG_INFOLN("ERREUR RECALLAGE x look east");
     }
     else if (abs(normalizeAngle(robot->cinetiqueCurrent._theta - PI / 2.0)) < DEG_TO_RAD * 45) //On fait un recallage Y en regardant vers theta==PI/2
     {
@@ -75,7 +83,7 @@ void recallageBordure(Robot *robot)
         else if (abs(robot->cinetiqueCurrent._y - (2.0 - robot->frontLength)) < 0.40) //C'est un recallage avant
             robot->move(VectorE(robot->cinetiqueCurrent._x, 2.0 - robot->frontLength, PI / 2.0));
         else
-            Logger::infoln("ERREUR RECALLAGE y look north");
+            LOG_INFOLN("ERREUR RECALLAGE y look north");
     }
     else if (abs(normalizeAngle(robot->cinetiqueCurrent._theta - PI)) < DEG_TO_RAD * 45) //On fait un recallage X en regardant vers theta==PI
     {
@@ -84,7 +92,7 @@ void recallageBordure(Robot *robot)
         else if (abs(robot->cinetiqueCurrent._x - (3.0 - robot->backLength)) < 0.40) //C'est un recallage arriere
             robot->move(VectorE(3.0 - robot->backLength, robot->cinetiqueCurrent._y, PI));
         else
-            Logger::infoln("ERREUR RECALLAGE x look west");
+            LOG_INFOLN("ERREUR RECALLAGE x look west");
     }
     else if (abs(normalizeAngle(robot->cinetiqueCurrent._theta - (-PI / 2.0))) < DEG_TO_RAD * 45) //On fait un recallage Y en regardant vers theta== -PI/2
     {
@@ -93,10 +101,10 @@ void recallageBordure(Robot *robot)
         else if (abs(robot->cinetiqueCurrent._y - (2.0 - robot->backLength)) < 0.40) //C'est un recallage arriere
             robot->move(VectorE(robot->cinetiqueCurrent._x, 2.0 - robot->backLength, -PI / 2.0));
         else
-            Logger::infoln("ERREUR RECALLAGE y look south");
+            LOG_INFOLN("ERREUR RECALLAGE y look south");
     }   
     else
-        Logger::infoln("ERREUR RECALLAGE bad angle");
+        LOG_INFOLN("ERREUR RECALLAGE bad angle");
 }
 
 void forceMainSeqNext(Robot *robot)
@@ -105,8 +113,19 @@ void forceMainSeqNext(Robot *robot)
 }
 
 void startTimeSeq(Robot* robot) {
-    Serial.println("StartTimeSeq");
+    LOG_DEBUGLN("StartTimeSeq");
     robot->getSequenceByName(timeSequenceName)->resume();
 }
 
+//Boucle du Planner (cf Planner::build)
+void plannerNext(Robot *robot)
+{
+    Planner::next(robot);
+}
+
+void plannerActuate(Robot *robot)
+{
+    Planner::actuate(robot);
+}
+
 #pragma GCC diagnostic pop
\ No newline at end of file
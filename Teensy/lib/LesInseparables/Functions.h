@@ -8,6 +8,7 @@ void add_spin(Robot* robot);
 void pauseNlockMainSequence(Robot* robot);
 void ping(Robot* robot);
 void shutdown(Robot* robot);
+void saveILC(Robot* robot);
 void setTimeStart(Robot* robot);
 void startBackHomeSeq(Robot* robot);
 void setNorth(Robot* robot);
@@ -15,6 +16,8 @@ void setSouth(Robot* robot);
 void recallageBordure(Robot* robot);
 void forceMainSeqNext(Robot* robot);
 void startTimeSeq(Robot* robot);
+void plannerNext(Robot* robot);
+void plannerActuate(Robot* robot);
 
 
 #endif // !FUNCTIONS_H_
\ No newline at end of file
@@ -0,0 +1,409 @@
+#include "Planner.h"
+#include "Actions.h"
+#include "Sequence.h"
+#include "Functions.h"
+#include "Robot.h"
+#include "Ghost.h"
+#include "Clock.h"
+#include "Logger.h"
+
+PlannerTask Planner::tasks[PLANNER_MAX_TASKS];
+uint8_t Planner::nbTasks = 0;
+MoveProfileName Planner::profile = standard;
+Planner::Zone Planner::zones[PLANNER_MAX_ZONES];
+
+float Planner::caps[PLANNER_MAX_TASKS + 1][PLANNER_MAX_TASKS + 1];
+float Planner::moves[PLANNER_MAX_TASKS + 1][PLANNER_MAX_TASKS + 1];
+float Planner::spinTimes[PLANNER_SPIN_STEPS + 1];
+float Planner::startHeading = 0.0;
+
+Robot *Planner::robot = nullptr;
+Sequence *Planner::sequence = nullptr;
+StraightTo_Action *Planner::move = nullptr;
+Sleep_Action *Planner::wait = nullptr;
+uint8_t Planner::moveIndex = 0;
+uint8_t Planner::exitIndex = 0;
+
+int8_t Planner::current = -1;
+uint8_t Planner::pose = PLANNER_MAX_TASKS;
+float Planner::heading = 0.0;
+float Planner::currentEnd = 0.0;
+bool Planner::obstructed = false;
+uint64_t Planner::matchStart = 0;
+
+uint32_t Planner::generation = 0;
+uint32_t Planner::searchGeneration = 0;
+Planner::State Planner::root;
+uint16_t Planner::excluded = 0;
+int8_t Planner::candidate = -1;
+Planner::State Planner::rollout;
+float Planner::rolloutValue = -1.0;
+int8_t Planner::roundBest = -1;
+float Planner::roundBestValue = 0.0;
+float Planner::roundBestTime = 0.0;
+int8_t Planner::published = -1;
+uint32_t Planner::publishedGeneration = 0;
+uint32_t Planner::rounds = 0;
+uint32_t Planner::maxStep = 0;
+uint32_t Planner::lastDecay = 0;
+
+#define BIT(i) ((uint16_t)1 << (i))
+
+//========================================DUREES========================================
+
+float Planner::gotoDuration(Vector from, Vector to, MoveProfileName profile)
+{
+    Vector delta = to - from;
+    if (delta.norm() <= 1e-3)
+        return 0.0;
+    MoveProfile *translation = MoveProfiles::get(profile, true);
+    Ghost ghost = Ghost(VectorE(from._x, from._y, delta.angle()));
+    ghost.Compute_Trajectory(VectorE(to._x, to._y, delta.angle()), PLANNER_CURVE, translation->speedRamps, translation->cruisingSpeed);
+    return ghost.Get_Duration() + PLANNER_SETTLE_TIME;
+}
+
+float Planner::spinDuration(float angle, MoveProfileName profile)
+{
+    if (fabs(angle) <= 1e-3)
+        return PLANNER_SETTLE_TIME;
+    MoveProfile *rotation = MoveProfiles::get(profile, false);
+    Ghost ghost = Ghost(VectorE(0, 0, 0));
+    ghost.Compute_Trajectory(VectorE(0, 0, angle), 0.0, rotation->speedRamps, rotation->cruisingSpeed, true);
+    return ghost.Get_Duration() + PLANNER_SETTLE_TIME;
+}
+
+float Planner::spinTime(float from, float to)
+{
+    float steps = fabs(normalizeAngle(to - from)) / PI * PLANNER_SPIN_STEPS;
+    int k = min((int)steps, PLANNER_SPIN_STEPS - 1);
+    return spinTimes[k] + (steps - k) * (spinTimes[k + 1] - spinTimes[k]);
+}
+
+float Planner::leg(const State &state, uint8_t to)
+{
+    float duration = spinTime(state.heading, caps[state.pose][to]) + moves[state.pose][to];
+    if (to < nbTasks)
+        duration += tasks[to].actuatorTime;
+    return duration;
+}
+
+//========================================CONSTRUCTION========================================
+
+void Planner::setup(MoveProfileName profile)
+{
+    Planner::profile = profile;
+    nbTasks = 0;
+    for (int i = 0; i < PLANNER_MAX_ZONES; i++)
+        zones[i].until = 0;
+    current = -1;
+    published = -1;
+    candidate = -1;
+    matchStart = 0;
+    robot = nullptr;
+    generation++;
+}
+
+int8_t Planner::addTask(const char *name, TargetVector target, int16_t score, MessageID actuator, Actuator_Order order, float actuatorTime)
+{
+    if (nbTasks >= PLANNER_MAX_TASKS)
+    {
+        LOG_INFOLN("Planner : too many tasks (", name, ")");
+        return -1;
+    }
+    tasks[nbTasks] = {name, target, score, actuator, order, actuatorTime, 0, false};
+    return nbTasks++;
+}
+
+void Planner::build(Sequence *sequence, VectorE start, TargetVector home, float timeout)
+{
+    if (nbTasks == 0)
+        LOG_INFOLN("Planner : no task (cf PlannerTasks.h)");
+    uint32_t startBuild = micros(); //Temps de boot : (nbTasks + 1)^2 trajectoires du Ghost
+    spinTimes[0] = PLANNER_SETTLE_TIME;
+    for (int k = 1; k <= PLANNER_SPIN_STEPS; k++)
+        spinTimes[k] = spinDuration(PI * k / PLANNER_SPIN_STEPS, profile);
+
+    //Ligne PLANNER_MAX_TASKS : depart, colonne PLANNER_MAX_TASKS : base (les colonnes nbTasks..MAX-1 ne servent pas)
+    for (int from = 0; from <= PLANNER_MAX_TASKS; from++)
+    {
+        if (from >= nbTasks && from != PLANNER_MAX_TASKS)
+            continue;
+        Vector origin = (from == PLANNER_MAX_TASKS) ? (Vector)start : tasks[from].target.getVector();
+        for (int to = 0; to <= PLANNER_MAX_TASKS; to++)
+        {
+            if (to >= nbTasks && to != PLANNER_MAX_TASKS)
+                continue;
+            Vector target = (to == PLANNER_MAX_TASKS) ? home.getVector() : tasks[to].target.getVector();
+            Vector delta = target - origin;
+            caps[from][to] = (delta.norm() > 1e-3) ? delta.angle() : ((from == PLANNER_MAX_TASKS) ? start._theta : 0.0);
+            moves[from][to] = gotoDuration(origin, target, profile);
+        }
+    }
+    LOG_INFOLN("Planner : ", nbTasks, " tasks, travel times in ", micros() - startBuild, "us");
+    startHeading = start._theta;
+    pose = PLANNER_MAX_TASKS;
+    heading = startHeading;
+
+    Planner::sequence = sequence;
+    move = new StraightTo_Action(timeout, home, profile);
+    wait = new Sleep_Action(0);
+    sequence->add(new Do_Action(plannerNext));
+    moveIndex = sequence->size();
+    sequence->add(move);
+    sequence->add(new Do_Action(plannerActuate));
+    sequence->add(wait);
+    sequence->add(new Do_Action(plannerNext));
+    exitIndex = sequence->size();
+    generation++;
+}
+
+//========================================CHOIX========================================
+
+float Planner::elapsed()
+{
+    uint64_t since = (robot->timeStarted != 0) ? robot->timeStarted : matchStart;
+    return Clock::secondsSince(since);
+}
+
+float Planner::probability(uint8_t task)
+{
+    return 1.0 / (1.0 + tasks[task].failures);
+}
+
+bool Planner::feasible(const State &state, uint8_t task)
+{
+    float end = state.time + leg(state, task);
+    State after = state;
+    after.pose = task;
+    after.heading = caps[state.pose][task];
+    return end + leg(after, PLANNER_MAX_TASKS) <= PLANNER_MATCH_DURATION - PLANNER_MARGIN;
+}
+
+int8_t Planner::greedy(const State &state)
+{
+    int8_t best = -1;
+    float bestRatio = 0.0;
+    for (int i = 0; i < nbTasks; i++)
+    {
+        if ((state.done & BIT(i)) || !feasible(state, i))
+            continue;
+        float ratio = probability(i) * tasks[i].score / max(leg(state, i), 1e-3f);
+        if (ratio > bestRatio)
+        {
+            best = i;
+            bestRatio = ratio;
+        }
+    }
+    return best;
+}
+
+void Planner::advance(State &state, uint8_t task)
+{
+    state.time += leg(state, task);
+    state.heading = caps[state.pose][task];
+    state.pose = task;
+    state.done |= BIT(task);
+}
+
+uint16_t Planner::unavailable()
+{
+    uint64_t time = Clock::micros();
+    uint16_t mask = 0;
+    for (int i = 0; i < nbTasks; i++)
+    {
+        if (tasks[i].done || tasks[i].failures >= PLANNER_MAX_FAILURES)
+        {
+            mask |= BIT(i);
+            continue;
+        }
+        Vector target = tasks[i].target.getVector();
+        for (int z = 0; z < PLANNER_MAX_ZONES; z++)
+            if (zones[z].until > time && (target - zones[z].center).norm() < zones[z].radius)
+                mask |= BIT(i);
+    }
+    return mask;
+}
+
+Planner::State Planner::now()
+{
+    State state;
+    if (current >= 0) //On planifie depuis la fin (estimée) de la tache en cours
+    {
+        state.pose = current;
+        state.heading = caps[pose][current];
+        state.time = max(elapsed(), currentEnd);
+        state.done = unavailable() | BIT(current);
+    }
+    else
+    {
+        state.pose = pose;
+        state.heading = heading;
+        state.time = elapsed();
+        state.done = unavailable();
+    }
+    return state;
+}
+
+void Planner::blockZone(Vector center, float radius, float duration)
+{
+    //Remplace la zone qui expire le plus tot
+    uint8_t oldest = 0;
+    for (int z = 1; z < PLANNER_MAX_ZONES; z++)
+        if (zones[z].until < zones[oldest].until)
+            oldest = z;
+    zones[oldest] = {center, radius, Clock::micros() + (uint64_t)(duration * 1e6)};
+    generation++;
+}
+
+void Planner::next(Robot *robot)
+{
+    if (matchStart == 0)
+    {
+        matchStart = Clock::micros();
+        Planner::robot = robot;
+    }
+
+    //Resultat de la tache qui vient de finir
+    bool planValid = false;
+    if (current >= 0)
+    {
+        PlannerTask &task = tasks[current];
+        if (sequence->failed(moveIndex))
+        {
+            task.failures++;
+            blockZone(task.target.getVector(), PLANNER_BLOCK_RADIUS, PLANNER_BLOCK_DURATION);
+            LOG_INFOLN("Planner : ", task.name, " failed", obstructed ? " (obstructed)" : "");
+            //Le robot est quelque part sur le trajet : pose connue la plus proche, cap du trajet (repere du build)
+            heading = caps[pose][current];
+            Vector where = Vector(robot->cinetiqueCurrent._x, robot->cinetiqueCurrent._y);
+            float nearest = (tasks[current].target.getVector() - where).norm();
+            pose = current;
+            for (int i = 0; i < nbTasks; i++)
+            {
+                float distance = (tasks[i].target.getVector() - where).norm();
+                if (distance < nearest)
+                {
+                    nearest = distance;
+                    pose = i;
+                }
+            }
+        }
+        else
+        {
+            task.done = true;
+            planValid = (publishedGeneration == generation); //Le tour publié supposait cette tache reussie
+            heading = caps[pose][current];
+            pose = current;
+        }
+        current = -1;
+    }
+
+    State state = now();
+    int8_t choice = (planValid && published >= 0 && !(state.done & BIT(published)) && feasible(state, published)) ? published : greedy(state);
+    generation++;
+    obstructed = false;
+    if (choice < 0)
+    {
+        LOG_INFOLN("Planner : nothing left at ", decimals(state.time, 1), "s");
+        sequence->setNextIndex(exitIndex);
+        return;
+    }
+
+    current = choice;
+    currentEnd = state.time + leg(state, choice);
+    move->setTarget(tasks[choice].target.getVector());
+    wait->setDuration(tasks[choice].actuatorTime);
+    sequence->setNextIndex(moveIndex);
+    LOG_INFOLN("Planner : ", tasks[choice].name, (choice == published && planValid) ? " (rollout)" : " (greedy)", " at ", decimals(state.time, 1), "s, end ", decimals(currentEnd, 1), "s");
+}
+
+void Planner::actuate(Robot *robot)
+{
+    if (current < 0)
+        return;
+    PlannerTask &task = tasks[current];
+    if (sequence->failed(moveIndex))
+    {
+        wait->setDuration(0); //Pas d'ordre, pas d'attente
+        return;
+    }
+    if (task.actuator != __NBMESSAGES__)
+        robot->commActionneurs.send(newMessage(task.actuator, task.order, 0, 0, 0));
+}
+
+//========================================RECHERCHE DE FOND========================================
+
+bool Planner::step()
+{
+    if (candidate < 0 || searchGeneration != generation) //Nouveau tour
+    {
+        searchGeneration = generation;
+        root = now();
+        excluded = root.done;
+        candidate = 0;
+        roundBest = -1;
+        roundBestValue = 0.0;
+        roundBestTime = PLANNER_MATCH_DURATION;
+        rolloutValue = -1.0;
+        return false;
+    }
+    if (candidate >= nbTasks) //Fin du tour
+    {
+        published = roundBest;
+        publishedGeneration = searchGeneration;
+        rounds++;
+        candidate = -1;
+        return true;
+    }
+    if (rolloutValue < 0) //Premiere tache imposée
+    {
+        if ((excluded & BIT(candidate)) || !feasible(root, candidate))
+        {
+            candidate++;
+            return false;
+        }
+        rollout = root;
+        rolloutValue = probability(candidate) * tasks[candidate].score;
+        advance(rollout, candidate);
+        return false;
+    }
+    int8_t task = greedy(rollout);
+    if (task < 0) //Fin de l'enchainement
+    {
+        //Plus de points esperés, a egalité le plus tot fini
+        if (rolloutValue > roundBestValue + 1e-3 || (rolloutValue > roundBestValue - 1e-3 && rollout.time < roundBestTime))
+        {
+            roundBest = candidate;
+            roundBestValue = rolloutValue;
+            roundBestTime = rollout.time;
+        }
+        candidate++;
+        rolloutValue = -1.0;
+        return false;
+    }
+    rolloutValue += probability(task) * tasks[task].score;
+    advance(rollout, task);
+    return false;
+}
+
+void Planner::slice(void *, uint32_t budget)
+{
+    if (robot == nullptr) //Boucle pas encore atteinte
+        return;
+    if (current >= 0 && robot->stopped) //Adversaire sur le trajet (noté, la zone n'est bloquée que si le mouvement rate)
+        obstructed = true;
+    uint32_t start = micros();
+    //Pas le plus long, oublié lentement (1/8 par PLANNER_STEP_DECAY) : une interruption pendant un pas ne bloque pas
+    //la recherche pour toujours, mais la garde reste celle du pire pas recent quel que soit le nombre d'appels
+    if (start - lastDecay >= PLANNER_STEP_DECAY)
+    {
+        maxStep -= maxStep / 8;
+        lastDecay = start;
+    }
+    while (micros() - start + maxStep <= budget)
+    {
+        uint32_t stepStart = micros();
+        step();
+        maxStep = max(maxStep, (uint32_t)(micros() - stepStart));
+    }
+}
@@ -0,0 +1,165 @@
+/**   Ensmasteel Library - On-robot anytime strategy planner
+ * note : Remplace l'ordre figé des taches du match par un choix fait pendant le match.
+ *        build ajoute a une sequence une boucle de 4 actions :
+ *            Do_Action(plannerNext)   -> tache suivante (resultat de la precedente noté), ou sortie de la boucle
+ *            StraightTo_Action        -> cible de la tache (setTarget)
+ *            Do_Action(plannerActuate)-> ordre a l'actionneur si le mouvement a reussi
+ *            Sleep_Action             -> temps d'actionneur de la tache (setDuration)
+ *        et saute a la fin de la boucle (actions ajoutées ensuite a la sequence : retour a la base...) quand plus rien ne rentre.
+ *
+ *        Choix : points esperés (score x 1 / (1 + echecs)) d'un enchainement glouton par points par seconde, sur les durées
+ *        de la matrice precalculée au build (Ghost : spin + goto entre toutes les poses, comme StraightTo_Action),
+ *        tant qu'il reste le temps de rentrer. Une tache ratée reste candidate (moins probable) jusqu'a PLANNER_MAX_FAILURES,
+ *        une zone bloquée (mouvement raté ou robot arreté par les capteurs de distance) est evitée PLANNER_BLOCK_DURATION.
+ *        Anytime : plannerNext a toujours une reponse (le meilleur ratio, calcul immédiat) ; slice, appelée dans le temps
+ *        libre du Scheduler (setIdle), deroule pas a pas un enchainement complet par premiere tache candidate et publie
+ *        la meilleure premiere tache a la fin du tour. Un tour dont l'etat de depart a changé est recommencé.
+ *        Chaque pas coute O(nombre de taches) : slice s'arrete avant de depasser le budget donné (horloge materielle).
+ *        Firmware compilé avec -DPLANNER seulement (env teensy35_planner), taches dans PlannerTasks.h ; build calcule la
+ *        matrice au boot et affiche sa durée.
+*/
+
+#ifndef PLANNER_H_
+#define PLANNER_H_
+
+#include "Arduino.h"
+#include "Vector.h"
+#include "MessageID.h"
+#include "MoveProfile.h"
+
+#define PLANNER_MAX_TASKS 16
+#define PLANNER_MAX_ZONES 4
+#define PLANNER_SLICE_BUDGET 200      // [...] = us, tranche de fond maximale (cf Scheduler::setIdle)
+#define PLANNER_MATCH_DURATION 100.0  // [...] = s
+#define PLANNER_MARGIN 3.0            // [...] = s, gardées pour rentrer a la base
+#define PLANNER_SETTLE_TIME 0.3       // [...] = s, par mouvement : asservissement proche apres la fin du ghost
+#define PLANNER_SPIN_STEPS 16         //Table des durées de spin sur [0, PI]
+#define PLANNER_CURVE 0.1             //deltaCurve des goto (celui de StraightTo_Action)
+#define PLANNER_MAX_FAILURES 2        //Echecs avant d'abandonner une tache
+#define PLANNER_BLOCK_DURATION 10.0   // [...] = s, une zone bloquée est evitée pendant ce temps
+#define PLANNER_BLOCK_RADIUS 0.25     // [...] = m
+#define PLANNER_STEP_DECAY 10000      // [...] = us, periode d'oubli du pas le plus long (une periode de controle a 100Hz)
+
+class Sequence;
+class Robot;
+class StraightTo_Action;
+class Sleep_Action;
+
+struct PlannerTask
+{
+    const char *name;
+    TargetVector target;
+    int16_t score;
+    MessageID actuator;   //__NBMESSAGES__ : pas d'actionneur
+    Actuator_Order order;
+    float actuatorTime;   // [...] = s
+    uint8_t failures;
+    bool done;
+};
+
+class Planner
+{
+public:
+    // GOAL / Forget all the tasks
+    static void setup(MoveProfileName profile = standard);
+
+    // GOAL / Add a task (a target to reach, then an order to an actuator)
+    // OUT  / int8_t : index of the task, -1 if the table is full
+    static int8_t addTask(const char *name, TargetVector target, int16_t score, MessageID actuator, Actuator_Order order, float actuatorTime);
+
+    // GOAL / Append the planned loop to a sequence (cf top) and precompute the travel times between all the poses
+    // IN   / Sequence *sequence : the robot must be set (Action::setPointer)
+    //        VectorE start : pose of the robot at the first plannerNext (blue)
+    //        TargetVector home : base at the end of the match
+    //        float timeout : of each move
+    static void build(Sequence *sequence, VectorE start, TargetVector home, float timeout);
+
+    static void next(Robot *robot);    //plannerNext (Functions.h)
+    static void actuate(Robot *robot); //plannerActuate (Functions.h)
+
+    // GOAL / Background work (Scheduler::setIdle) : refine the choice of the next task
+    // IN   / uint32_t budget : us, never exceeded
+    static void slice(void *context, uint32_t budget);
+
+    // GOAL / Avoid the tasks around a point (opponent seen there...)
+    // IN   / Vector center : field coordinates (already mirrored)
+    static void blockZone(Vector center, float radius, float duration);
+
+    static int8_t getCurrent() { return current; } //Tache en cours, -1 si aucune
+    static uint32_t getRounds() { return rounds; } //Tours de recherche complets
+
+    //Durées estimées avec le Ghost (partagées avec l'optimiseur hors ligne, cf Strategy.h)
+    static float gotoDuration(Vector from, Vector to, MoveProfileName profile); // [...] = s, ghost + PLANNER_SETTLE_TIME
+    static float spinDuration(float angle, MoveProfileName profile);
+
+private:
+    struct Zone
+    {
+        Vector center;
+        float radius;
+        uint64_t until; // [...] = us (Clock)
+    };
+
+    //Etat de depart d'un enchainement
+    struct State
+    {
+        uint8_t pose;   //Tache (ou PLANNER_MAX_TASKS : depart)
+        float heading;
+        float time;     // [...] = s depuis le debut du match
+        uint16_t done;  //Taches faites ou exclues
+    };
+
+    static PlannerTask tasks[PLANNER_MAX_TASKS];
+    static uint8_t nbTasks;
+    static MoveProfileName profile;
+    static Zone zones[PLANNER_MAX_ZONES];
+
+    //Matrices (indice PLANNER_MAX_TASKS : depart en ligne, base en colonne), repere du build
+    static float caps[PLANNER_MAX_TASKS + 1][PLANNER_MAX_TASKS + 1];
+    static float moves[PLANNER_MAX_TASKS + 1][PLANNER_MAX_TASKS + 1]; // [...] = s, goto seul
+    static float spinTimes[PLANNER_SPIN_STEPS + 1];
+    static float startHeading;
+
+    //Boucle dans la sequence
+    static Robot *robot;       //Au premier plannerNext
+    static Sequence *sequence;
+    static StraightTo_Action *move;
+    static Sleep_Action *wait;
+    static uint8_t moveIndex, exitIndex;
+
+    static int8_t current;
+    static uint8_t pose;      //Pose de depart de la tache en cours (ou pose actuelle si aucune)
+    static float heading;
+    static float currentEnd;  // [...] = s, fin estimée de la tache en cours
+    static bool obstructed;   //Robot arreté par les capteurs pendant la tache en cours
+    static uint64_t matchStart;
+
+    //Recherche incrementale (slice)
+    static uint32_t generation, searchGeneration; //Change a chaque evenement (tache finie, zone bloquée...)
+    static State root;
+    static uint16_t excluded;    //Taches impossibles maintenant (echecs, zones) au debut du tour
+    static int8_t candidate;     //Premiere tache en cours d'evaluation, -1 : tour a commencer
+    static State rollout;
+    static float rolloutValue;
+    static int8_t roundBest;
+    static float roundBestValue;
+    static float roundBestTime;  // [...] = s, fin de l'enchainement du meilleur (departage les egalités)
+    static int8_t published;     //Meilleure premiere tache du dernier tour complet (-1 : aucune)
+    static uint32_t publishedGeneration;
+    static uint32_t rounds;
+    static uint32_t maxStep;     // [...] = us, pas le plus long mesuré recemment
+    static uint32_t lastDecay;   // [...] = us (micros), dernier oubli de maxStep
+
+    static float elapsed();
+    static float spinTime(float from, float to);
+    static float leg(const State &state, uint8_t to);         //Spin + goto (+ actionneur si to est une tache)
+    static float probability(uint8_t task);
+    static bool feasible(const State &state, uint8_t task);  //Reste le temps de la faire et de rentrer
+    static int8_t greedy(const State &state);                //Meilleur ratio points esperés / seconde
+    static void advance(State &state, uint8_t task);
+    static uint16_t unavailable();                           //Taches faites, abandonnées ou en zone bloquée
+    static State now();
+    static bool step();                                      //Un pas de la recherche, true a la fin d'un tour
+};
+
+#endif // !PLANNER_H_
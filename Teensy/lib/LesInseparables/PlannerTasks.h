@@ -0,0 +1,19 @@
+/**   Ensmasteel Library - Tasks of the on-robot planner
+ * note : Données du match pour le Planner (firmware compilé avec -DPLANNER, env teensy35_planner), a remplir par l'equipe :
+ *        points du reglement et ordres d'actionneur validés sur le robot. Sans -DPLANNER la mainSequence de Robot::Robot
+ *        est jouée telle quelle et ce fichier n'est pas utilisé.
+ *        PLANNER_TASK(cible, points, actionneur, ordre, temps d'actionneur en s) : cible est une des TargetVector de Robot::Robot,
+ *        l'ordre est envoyé une fois la cible atteinte (une tache = un seul ordre, ajouter une tache par etape sinon).
+ *        Les taches sont jouées a la fin de la mainSequence, avant son End_Action ; PLANNER_HOME sert a garder le temps
+ *        de rentrer (le retour lui meme reste celui de la timeSequence).
+*/
+
+#ifndef PLANNERTASKS_H_
+#define PLANNERTASKS_H_
+
+#define PLANNER_HOME northBase
+
+//Exemple : PLANNER_TASK(manche1, 0, BrasD_M, Sortir, 1.0)
+#define PLANNER_TASKS
+
+#endif // !PLANNERTASKS_H_
@@ -0,0 +1,458 @@
+#include "Program.h"
+#include "Robot.h"
+#include "Sequence.h"
+#include "Functions.h"
+#include "EEPROM.h"
+#include <new>
+
+//Taille des operandes de chaque opcode (cf Program.h)
+static const uint8_t operandSizes[__NBOPCODES__] = {1, 10, 5, 4, 4, 4, 1, 2, 7, 4, 2, 1, 1, 2, 1, 3, 3, 2, 6, 2};
+
+//Fonctions appelables par OP_CALL (ne pas changer l'ordre : les programmes deja televersés en dependent, ajouter a la fin)
+static const Fct programFunctions[] = {ping, shutdown, setTimeStart, startTimeSeq, startBackHomeSeq, setNorth, setSouth,
+                                       recallageBordure, forceMainSeqNext, saveILC};
+#define PROGRAM_NB_FUNCTIONS (sizeof(programFunctions) / sizeof(programFunctions[0]))
+
+static_assert(sizeof(Goto_Action) <= PROGRAM_ACTION_STORAGE && sizeof(Spin_Action) <= PROGRAM_ACTION_STORAGE &&
+                  sizeof(Forward_Action) <= PROGRAM_ACTION_STORAGE && sizeof(Backward_Action) <= PROGRAM_ACTION_STORAGE &&
+                  sizeof(Rotate_Action) <= PROGRAM_ACTION_STORAGE && sizeof(Brake_Action) <= PROGRAM_ACTION_STORAGE &&
+                  sizeof(Sleep_Action) <= PROGRAM_ACTION_STORAGE && sizeof(Wait_Message_Action) <= PROGRAM_ACTION_STORAGE &&
+                  sizeof(Wait_Error_Action) <= PROGRAM_ACTION_STORAGE && sizeof(Wait_Tirette_Action) <= PROGRAM_ACTION_STORAGE,
+              "Action over PROGRAM_ACTION_STORAGE");
+static_assert(ILC_EEPROM_ADDRESS + 1 + ILC_NB_TRACKS * sizeof(ILCTrack) <= PROGRAM_EEPROM_ADDRESS, "ILC tables overlap the program in EEPROM");
+#if PROGRAM_EEPROM_ADDRESS + PROGRAM_EEPROM_HEADER + PROGRAM_MAX_SIZE > 4096
+#error "Program does not fit in the EEPROM of the teensy 3.5"
+#endif
+
+static inline uint16_t readU16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+static inline int16_t readI16(const uint8_t *p) { return (int16_t)readU16(p); }
+static inline int32_t readI32(const uint8_t *p) { return (int32_t)(readU16(p) | ((uint32_t)readU16(p + 2) << 16)); }
+static inline float timeoutOf(uint8_t tenths) { return (tenths == 0) ? -1 : tenths / 10.0; }
+static inline float metersOf(const uint8_t *p) { return readI16(p) / 1000.0; }
+
+//========================================VALIDATION========================================
+
+int32_t Program::variables[PROGRAM_NB_VARIABLES];
+
+static bool operandsValid(const uint8_t *instruction)
+{
+    const uint8_t *operands = instruction + 1;
+    switch (instruction[0])
+    {
+    case OP_GOTO:
+        return operands[7] < __NBPROFILES__;
+    case OP_SPIN:
+        return operands[2] < __NBPROFILES__;
+    case OP_FORWARD:
+    case OP_BACKWARD:
+    case OP_ROTATE:
+        return operands[2] < __NBPROFILES__;
+    case OP_SEND:
+    case OP_WAIT_MESSAGE:
+        return operands[0] <= 1;
+    case OP_WAIT_ERROR:
+        return operands[0] < __NBERROR__;
+    case OP_CALL:
+        return operands[0] < PROGRAM_NB_FUNCTIONS;
+    case OP_PAUSE_SEQ:
+    case OP_RESUME_SEQ:
+        return operands[0] < __NBSEQUENCES__;
+    case OP_SET:
+    case OP_ADD:
+        return operands[0] < PROGRAM_NB_VARIABLES;
+    case OP_JUMP_IF:
+        return operands[0] < PROGRAM_NB_VARIABLES && operands[1] < __NBCOMPARES__;
+    default:
+        return true;
+    }
+}
+
+ProgramStatus Program::validate(const uint8_t *code, uint16_t size, uint16_t *where)
+{
+    uint8_t starts[PROGRAM_MAX_SIZE / 8]; //Bit a 1 : une instruction commence a cette adresse
+    uint16_t faulty = 0;
+    ProgramStatus out = PROGRAM_OK;
+    if (size > PROGRAM_MAX_SIZE)
+        out = PROGRAM_TOO_BIG;
+    memset(starts, 0, sizeof(starts));
+
+    //1er passage : decoupage en instructions
+    uint16_t address = 0;
+    while (address < size && out == PROGRAM_OK)
+    {
+        faulty = address;
+        if (code[address] >= __NBOPCODES__)
+            out = PROGRAM_BAD_OPCODE;
+        else if (address + 1 + operandSizes[code[address]] > size)
+            out = PROGRAM_TRUNCATED;
+        else if (!operandsValid(code + address))
+            out = PROGRAM_BAD_OPERAND;
+        else
+        {
+            starts[address >> 3] |= 1 << (address & 7);
+            address += 1 + operandSizes[code[address]];
+        }
+    }
+
+    //2eme passage : les sauts tombent sur des instructions
+    for (address = 0; address < size && out == PROGRAM_OK; address += 1 + operandSizes[code[address]])
+    {
+        faulty = address;
+        uint8_t opcode = code[address];
+        if (opcode == OP_JUMP || opcode == OP_JUMP_IF || opcode == OP_JUMP_FAILED)
+        {
+            uint16_t target = readU16(code + address + 1 + operandSizes[opcode] - 2);
+            if (target >= size || !(starts[target >> 3] & (1 << (target & 7))))
+                out = PROGRAM_BAD_JUMP;
+        }
+    }
+    if (where != nullptr)
+        *where = faulty;
+    return out;
+}
+
+uint32_t Program::crc32(const uint8_t *data, uint16_t size)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    for (uint16_t i = 0; i < size; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+    return ~crc;
+}
+
+//========================================INTERPRETEUR========================================
+
+Program::Program()
+{
+    code = nullptr;
+    size = 0;
+    address = 0;
+    current = nullptr;
+    lastFailed = false;
+}
+
+ProgramStatus Program::load(const uint8_t *code, uint16_t size)
+{
+    uint16_t where;
+    ProgramStatus status = validate(code, size, &where);
+    if (status != PROGRAM_OK)
+    {
+        LOG_INFOLN("Program rejected : status ", status, " at ", where);
+        return status;
+    }
+    this->code = code;
+    this->size = size;
+    restart();
+    return PROGRAM_OK;
+}
+
+void Program::unload()
+{
+    code = nullptr;
+    current = nullptr;
+}
+
+void Program::restart()
+{
+    address = 0;
+    current = nullptr;
+    lastFailed = false;
+}
+
+void Program::resume()
+{
+    if (current != nullptr)
+        current->mySequence->arm(current);
+}
+
+void Program::skip()
+{
+    if (current == nullptr)
+        return;
+    lastFailed = true;
+    current = nullptr;
+    address += 1 + operandSizes[code[address]];
+}
+
+void Program::finish()
+{
+    current->doAtEnd();
+    current = nullptr;
+    address += 1 + operandSizes[code[address]];
+}
+
+void Program::update(Sequence *sequence)
+{
+    if (code == nullptr)
+        return;
+    if (current != nullptr)
+    {
+        if (current->isFinished())
+        {
+            lastFailed = false;
+            LOG_DEBUGLN("Instruction ", address, " succeded !");
+            finish();
+        }
+        else if (current->hasFailed())
+        {
+            lastFailed = true;
+            LOG_INFOLN("Instruction ", address, " failed (", sequence->getName(), ")");
+            finish();
+        }
+        else
+            return;
+    }
+    for (uint8_t steps = 0; steps < PROGRAM_MAX_STEPS && current == nullptr && !sequence->paused; steps++)
+        execute(sequence);
+    if (current == nullptr && !sequence->paused)
+        Wakeups::wake(sequence->getName()); //PROGRAM_MAX_STEPS atteint : la suite au prochain tour
+}
+
+uint8_t Program::instructionIndex()
+{
+    uint8_t out = 0;
+    for (uint16_t i = 0; i < address; i += 1 + operandSizes[code[i]])
+        out++;
+    return out;
+}
+
+void Program::execute(Sequence *sequence)
+{
+    if (address >= size) //Fin du programme sans END
+    {
+        sequence->pause(false);
+        return;
+    }
+    const uint8_t *operands = code + address + 1;
+    uint16_t next = address + 1 + operandSizes[code[address]];
+    Robot *robot = Action::robot;
+    Communication *port = (operands[0] == 0) ? &robot->communication : &robot->commActionneurs;
+    Action *action = nullptr;
+
+    //Les actions sont construites par ::new (l'operator new d'Action servirait l'arene)
+    switch (code[address])
+    {
+    case OP_END:
+        sequence->pause(operands[0] & PROGRAM_LOCK_GHOST);
+        return; //On reste sur END : un resume remet la sequence en pause
+    case OP_GOTO:
+        action = ::new (actionStorage) Goto_Action(timeoutOf(operands[9]),
+                                                   TargetVectorE(metersOf(operands), metersOf(operands + 2), readI16(operands + 4) / 1000.0, !(operands[8] & PROGRAM_MIRROR)),
+                                                   operands[6] / 100.0, (MoveProfileName)operands[7], operands[8] & PROGRAM_BACKWARD);
+        break;
+    case OP_SPIN:
+        action = ::new (actionStorage) Spin_Action(timeoutOf(operands[4]), TargetVectorE(readI16(operands) / 1000.0, !(operands[3] & PROGRAM_MIRROR)),
+                                                   (MoveProfileName)operands[2]);
+        break;
+    case OP_FORWARD:
+        action = ::new (actionStorage) Forward_Action(timeoutOf(operands[3]), metersOf(operands), (MoveProfileName)operands[2]);
+        break;
+    case OP_BACKWARD:
+        action = ::new (actionStorage) Backward_Action(timeoutOf(operands[3]), metersOf(operands), (MoveProfileName)operands[2]);
+        break;
+    case OP_ROTATE:
+        action = ::new (actionStorage) Rotate_Action(timeoutOf(operands[3]), readI16(operands) / 1000.0, (MoveProfileName)operands[2]);
+        break;
+    case OP_BRAKE:
+        action = ::new (actionStorage) Brake_Action(timeoutOf(operands[0]));
+        break;
+    case OP_SLEEP:
+        action = ::new (actionStorage) Sleep_Action(readU16(operands) / 100.0);
+        break;
+    case OP_SEND:
+        port->send(newMessage((MessageID)readU16(operands + 1), readI32(operands + 3)));
+        break;
+    case OP_WAIT_MESSAGE:
+        action = ::new (actionStorage) Wait_Message_Action((MessageID)readU16(operands + 1), timeoutOf(operands[3]), port);
+        break;
+    case OP_WAIT_ERROR:
+        action = ::new (actionStorage) Wait_Error_Action((Error)operands[0], timeoutOf(operands[1]));
+        break;
+    case OP_WAIT_TIRETTE:
+        action = ::new (actionStorage) Wait_Tirette_Action(operands[0]);
+        break;
+    case OP_CALL:
+        programFunctions[operands[0]](robot);
+        break;
+    case OP_PAUSE_SEQ:
+        robot->getSequenceByName((SequenceName)operands[0])->pause(operands[1] & PROGRAM_LOCK_GHOST);
+        break;
+    case OP_RESUME_SEQ:
+        robot->getSequenceByName((SequenceName)operands[0])->resume();
+        break;
+    case OP_SET:
+        variables[operands[0]] = readI16(operands + 1);
+        break;
+    case OP_ADD:
+        variables[operands[0]] += readI16(operands + 1);
+        break;
+    case OP_JUMP:
+        next = readU16(operands);
+        break;
+    case OP_JUMP_IF:
+    {
+        int32_t a = variables[operands[0]], b = readI16(operands + 2);
+        bool jump[__NBCOMPARES__] = {a == b, a != b, a < b, a <= b, a > b, a >= b};
+        if (jump[operands[1]])
+            next = readU16(operands + 4);
+        break;
+    }
+    case OP_JUMP_FAILED:
+        if (lastFailed)
+            next = readU16(operands);
+        break;
+    }
+
+    if (action == nullptr)
+    {
+        address = next;
+        return;
+    }
+    current = action;
+    current->mySequence = sequence;
+    sequence->currentIndex = instructionIndex();
+    sequence->arm(current);
+}
+
+//========================================TELEVERSEMENT========================================
+
+uint8_t ProgramLoader::active[PROGRAM_MAX_SIZE];
+uint8_t ProgramLoader::staging[PROGRAM_MAX_SIZE];
+uint16_t ProgramLoader::activeSize = 0;
+uint16_t ProgramLoader::stagingSize = 0;
+uint16_t ProgramLoader::received = 0;
+SequenceName ProgramLoader::activeSequence = mainSequenceName;
+SequenceName ProgramLoader::stagingSequence = mainSequenceName;
+uint8_t ProgramLoader::flags = 0;
+uint8_t ProgramLoader::nextChunk = 0;
+bool ProgramLoader::uploading = false;
+
+void ProgramLoader::acknowledge(Communication *communication, ProgramStatus status, uint16_t where)
+{
+    communication->send(newMessage(Program_Ack_M, status, where & 0xFF, where >> 8, 0));
+    if (status != PROGRAM_OK)
+        LOG_INFOLN("Program upload failed : status ", status, " at ", where);
+}
+
+bool ProgramLoader::handles(Message message)
+{
+    MessageID id = extractID(message);
+    return id == Program_Begin_M || id == Program_Chunk_M || id == Program_End_M;
+}
+
+bool ProgramLoader::receive(Message message, Communication *communication)
+{
+    FourBytes bytes = extract4Bytes(message);
+    switch (extractID(message))
+    {
+    case Program_Begin_M:
+        stagingSequence = (SequenceName)bytes.byte0;
+        stagingSize = bytes.byte1 | (bytes.byte2 << 8);
+        flags = bytes.byte3;
+        received = 0;
+        nextChunk = 0;
+        uploading = true;
+        if (stagingSequence >= __NBSEQUENCES__ || stagingSize > PROGRAM_MAX_SIZE)
+        {
+            uploading = false;
+            acknowledge(communication, (stagingSize > PROGRAM_MAX_SIZE) ? PROGRAM_TOO_BIG : PROGRAM_BAD_OPERAND);
+        }
+        LOG_INFOLN("Program upload : ", stagingSize, " bytes for sequence ", stagingSequence);
+        return false;
+
+    case Program_Chunk_M:
+        if (!uploading)
+            return false; //Deja refusé (l'erreur a été envoyée)
+        if (bytes.byte0 != nextChunk)
+        {
+            uploading = false;
+            acknowledge(communication, PROGRAM_LOST_CHUNK, received);
+            return false;
+        }
+        for (uint8_t i = 0; i < 3 && received < stagingSize; i++)
+            staging[received++] = (i == 0) ? bytes.byte1 : (i == 1) ? bytes.byte2 : bytes.byte3;
+        nextChunk++;
+        return false;
+
+    case Program_End_M:
+    {
+        if (!uploading)
+        {
+            acknowledge(communication, PROGRAM_NO_UPLOAD);
+            return false;
+        }
+        uploading = false;
+        uint16_t where = 0;
+        ProgramStatus status = PROGRAM_OK;
+        if (received != stagingSize)
+            status = PROGRAM_LOST_CHUNK;
+        else if (Program::crc32(staging, stagingSize) != (uint32_t)extractInt32(message))
+            status = PROGRAM_BAD_CRC;
+        else
+            status = Program::validate(staging, stagingSize, &where);
+        acknowledge(communication, status, (status == PROGRAM_LOST_CHUNK) ? received : where);
+        if (status != PROGRAM_OK)
+            return false;
+
+        if (flags & PROGRAM_STORE)
+            store();
+        if (!(flags & PROGRAM_RUN) || stagingSize == 0)
+            return false;
+        memcpy(active, staging, stagingSize);
+        activeSize = stagingSize;
+        activeSequence = stagingSequence;
+        LOG_INFOLN("Program ready : ", activeSize, " bytes for sequence ", activeSequence);
+        return true;
+    }
+
+    default:
+        return false;
+    }
+}
+
+void ProgramLoader::store()
+{
+    if (stagingSize == 0)
+    {
+        EEPROM.update(PROGRAM_EEPROM_ADDRESS, 0xFF); //Plus de programme gardé
+        LOG_INFOLN("Program erased from EEPROM");
+        return;
+    }
+    uint32_t crc = Program::crc32(staging, stagingSize);
+    uint8_t header[PROGRAM_EEPROM_HEADER] = {PROGRAM_EEPROM_MAGIC, (uint8_t)stagingSequence, (uint8_t)(stagingSize & 0xFF), (uint8_t)(stagingSize >> 8),
+                                             (uint8_t)crc, (uint8_t)(crc >> 8), (uint8_t)(crc >> 16), (uint8_t)(crc >> 24)};
+    EEPROM.update(PROGRAM_EEPROM_ADDRESS, 0xFF); //Invalide pendant l'ecriture (coupure de courant)
+    for (uint16_t i = 1; i < PROGRAM_EEPROM_HEADER; i++)
+        EEPROM.update(PROGRAM_EEPROM_ADDRESS + i, header[i]);
+    for (uint16_t i = 0; i < stagingSize; i++)
+        EEPROM.update(PROGRAM_EEPROM_ADDRESS + PROGRAM_EEPROM_HEADER + i, staging[i]);
+    EEPROM.update(PROGRAM_EEPROM_ADDRESS, PROGRAM_EEPROM_MAGIC);
+    LOG_INFOLN("Program stored in EEPROM : ", stagingSize, " bytes");
+}
+
+bool ProgramLoader::loadFromEEPROM()
+{
+    if (EEPROM.read(PROGRAM_EEPROM_ADDRESS) != PROGRAM_EEPROM_MAGIC)
+        return false;
+    uint8_t header[PROGRAM_EEPROM_HEADER];
+    for (uint16_t i = 0; i < PROGRAM_EEPROM_HEADER; i++)
+        header[i] = EEPROM.read(PROGRAM_EEPROM_ADDRESS + i);
+    uint16_t size = header[2] | (header[3] << 8);
+    uint32_t crc = header[4] | ((uint32_t)header[5] << 8) | ((uint32_t)header[6] << 16) | ((uint32_t)header[7] << 24);
+    if (size == 0 || size > PROGRAM_MAX_SIZE || header[1] >= __NBSEQUENCES__)
+        return false;
+    for (uint16_t i = 0; i < size; i++)
+        active[i] = EEPROM.read(PROGRAM_EEPROM_ADDRESS + PROGRAM_EEPROM_HEADER + i);
+    if (Program::crc32(active, size) != crc)
+    {
+        LOG_INFOLN("Program in EEPROM corrupted (CRC), ignored");
+        return false;
+    }
+    activeSize = size;
+    activeSequence = (SequenceName)header[1];
+    LOG_INFOLN("Program loaded from EEPROM : ", activeSize, " bytes for sequence ", activeSequence);
+    return true;
+}
@@ -0,0 +1,164 @@
+/**   Ensmasteel Library - Bytecode of the sequences
+ * note : Une sequence peut executer un programme (Sequence::run) au lieu de sa file d'actions : quelques octets par instruction
+ *        au lieu d'une Action virtuelle dans l'arene, et un programme se change sans reflasher (televersement par Communication).
+ *        Instruction = opcode (1 octet) + operandes little endian de taille fixe (operandSizes dans Program.cpp) :
+ *          distances en mm (int16), angles en mrad (int16), courbure en cm (uint8),
+ *          timeout en dixiemes de seconde (uint8, 0 : illimité), attente en centiemes de seconde (uint16),
+ *          saut : adresse absolue en octets dans le programme (uint16).
+ *        Les mouvements a flag PROGRAM_MIRROR sont donnés pour le robot bleu et miroirés a l'execution (comme TargetVectorE relatif).
+ *        Les instructions bloquantes (mouvements, attentes) construisent l'action correspondante dans un emplacement unique
+ *        du Program (placement new) : le comportement est celui des actions de la file, sans allocation.
+ *        Les autres s'enchainent dans le meme update (au plus PROGRAM_MAX_STEPS, une boucle sans attente ne bloque pas le robot).
+ *        Un programme est validé entierement au chargement (opcodes, operandes, sauts sur des debuts d'instruction) :
+ *        l'interpreteur ne fait plus aucune verification.
+ *
+ *        Televersement (ProgramLoader, messages de 4 octets) :
+ *          Program_Begin_M : byte0 sequence, byte1..2 taille en octets, byte3 flags (PROGRAM_STORE, PROGRAM_RUN)
+ *          Program_Chunk_M : byte0 numero du morceau (modulo 256), byte1..3 les 3 octets suivants du programme
+ *          Program_End_M   : CRC32 du programme
+ *          => Program_Ack_M : byte0 ProgramStatus, byte1..2 adresse de l'instruction fautive
+ *        Avec PROGRAM_STORE le programme est gardé en EEPROM (apres les tables de l'ILC) et rechargé au demarrage.
+ *        Une taille nulle avec PROGRAM_STORE efface le programme gardé (retour a la sequence compilée).
+ *        tools/sequence_asm.py assemble un programme texte et le televerse.
+*/
+
+#ifndef PROGRAM_H_
+#define PROGRAM_H_
+
+#include "Arduino.h"
+#include "Actions.h"
+
+#define PROGRAM_MAX_SIZE 1024     // [...] = octets
+#define PROGRAM_NB_VARIABLES 16   //Variables globales (int32) partagées par tous les programmes
+#define PROGRAM_MAX_STEPS 32      //Instructions non bloquantes executées au plus par update
+#define PROGRAM_EEPROM_ADDRESS 2304 //Apres l'ILC (0..2240)
+#define PROGRAM_EEPROM_MAGIC 0xB5
+#define PROGRAM_EEPROM_HEADER 8   //Magic, sequence, taille (2 octets), CRC32
+#define PROGRAM_ACTION_STORAGE 96 // [...] = octets, emplacement de l'action bloquante en cours (verifié dans Program.cpp)
+
+//Flags des mouvements
+#define PROGRAM_MIRROR 0x01       //Coordonnées du robot bleu, miroirées pour le jaune
+#define PROGRAM_BACKWARD 0x02     //Goto en marche arriere
+//Flags de END et PAUSE_SEQ
+#define PROGRAM_LOCK_GHOST 0x01
+//Flags de Program_Begin_M
+#define PROGRAM_STORE 0x01
+#define PROGRAM_RUN 0x02
+
+enum Opcode : uint8_t
+{
+    OP_END,          //flags                                  Met la sequence en pause (reste sur END)
+    OP_GOTO,         //x y theta courbure profil flags timeout
+    OP_SPIN,         //theta profil flags timeout
+    OP_FORWARD,      //distance profil timeout
+    OP_BACKWARD,     //distance profil timeout
+    OP_ROTATE,       //deltaTheta profil timeout
+    OP_BRAKE,        //timeout
+    OP_SLEEP,        //duree (cs)
+    OP_SEND,         //port (0 : communication, 1 : actionneurs) id(uint16) data(int32)
+    OP_WAIT_MESSAGE, //port id(uint16) timeout
+    OP_WAIT_ERROR,   //erreur timeout
+    OP_WAIT_TIRETTE, //pin
+    OP_CALL,         //indice de la fonction (cf programFunctions dans Program.cpp)
+    OP_PAUSE_SEQ,    //sequence flags
+    OP_RESUME_SEQ,   //sequence
+    OP_SET,          //variable valeur(int16)                 variable = valeur
+    OP_ADD,          //variable valeur(int16)                 variable += valeur
+    OP_JUMP,         //adresse
+    OP_JUMP_IF,      //variable comparaison valeur(int16) adresse
+    OP_JUMP_FAILED,  //adresse                                Si la derniere instruction bloquante a foiré
+    __NBOPCODES__
+};
+
+enum ProgramCompare : uint8_t
+{
+    CMP_EQ,
+    CMP_NE,
+    CMP_LT,
+    CMP_LE,
+    CMP_GT,
+    CMP_GE,
+    __NBCOMPARES__
+};
+
+enum ProgramStatus : uint8_t
+{
+    PROGRAM_OK,
+    PROGRAM_TOO_BIG,
+    PROGRAM_BAD_OPCODE,
+    PROGRAM_TRUNCATED,   //Derniere instruction incomplete
+    PROGRAM_BAD_JUMP,    //Saut hors du programme ou au milieu d'une instruction
+    PROGRAM_BAD_OPERAND, //Profil, variable, sequence, fonction... hors limites
+    PROGRAM_BAD_CRC,
+    PROGRAM_LOST_CHUNK,
+    PROGRAM_NO_UPLOAD    //Chunk ou End sans Begin
+};
+
+class Program
+{
+public:
+    static int32_t variables[PROGRAM_NB_VARIABLES];
+
+    // GOAL / Check a whole program
+    // IN   / uint16_t *where : offset of the faulty instruction (optional)
+    static ProgramStatus validate(const uint8_t *code, uint16_t size, uint16_t *where = nullptr);
+
+    static uint32_t crc32(const uint8_t *data, uint16_t size);
+
+    // GOAL / Use a program (validated first). The code is not copied : it must stay alive
+    ProgramStatus load(const uint8_t *code, uint16_t size);
+    void unload();
+    bool isLoaded() { return code != nullptr; }
+
+    void restart();                   //Repart de l'adresse 0
+    void update(Sequence *sequence);  //Appelé par Sequence::update
+    void resume();                    //Relance l'instruction bloquante en cours (Sequence::resume)
+    void skip();                      //Abandonne l'instruction bloquante en cours, comptée comme ratée (Sequence::forceFollowing)
+    uint16_t getAddress() { return address; }
+
+    Program();
+
+private:
+    const uint8_t *code;
+    uint16_t size;
+    uint16_t address;  //Instruction en cours
+    Action *current;   //Action de l'instruction bloquante en cours (dans actionStorage), nullptr sinon
+    bool lastFailed;
+    uint8_t actionStorage[PROGRAM_ACTION_STORAGE] __attribute__((aligned(8)));
+
+    void execute(Sequence *sequence); //Execute l'instruction a address et avance
+    void finish();                    //Fin de l'instruction bloquante : doAtEnd et instruction suivante
+    uint8_t instructionIndex();       //Rang de l'instruction en cours (Sequence::getCurrentIndex : ILC, ScoreHistory)
+};
+
+/*
+* Reception des programmes par Communication, stockage (RAM et EEPROM). Statique : un seul televersement a la fois
+*/
+class ProgramLoader
+{
+public:
+    static bool handles(Message message); //Program_Begin_M, Program_Chunk_M ou Program_End_M
+
+    // GOAL / Handle a Program_*_M message (each message must be given once : the caller pops it)
+    // IN   / Communication *communication : to send Program_Ack_M
+    // OUT  / bool : true if a program has just been received with PROGRAM_RUN (cf code, size, sequence)
+    static bool receive(Message message, Communication *communication);
+
+    static bool loadFromEEPROM(); //Programme gardé en EEPROM (CRC verifié), false s'il n'y en a pas
+    static const uint8_t *code() { return active; }
+    static uint16_t size() { return activeSize; }
+    static SequenceName sequence() { return activeSequence; }
+
+private:
+    static uint8_t active[PROGRAM_MAX_SIZE];  //Programme en cours d'execution
+    static uint8_t staging[PROGRAM_MAX_SIZE]; //Programme en cours de reception
+    static uint16_t activeSize, stagingSize, received;
+    static SequenceName activeSequence, stagingSequence;
+    static uint8_t flags, nextChunk;
+    static bool uploading;
+
+    static void acknowledge(Communication *communication, ProgramStatus status, uint16_t where = 0);
+    static void store();
+};
+
+#endif // !PROGRAM_H_
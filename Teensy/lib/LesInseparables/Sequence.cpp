@@ -1,6 +1,8 @@
 #include "Sequence.h"
 #include "Robot.h"
 #include "Actions.h"
+#include "Program.h"
+#include "Wakeups.h"
 
 void Sequence::startFollowing()
 {
@@ -12,31 +14,51 @@ void Sequence::startFollowing()
 
 void Sequence::startSelected()
 {
+    if (program != nullptr)
+    {
+        program->resume();
+        Wakeups::wake(getName()); //Instruction non bloquante en cours
+        return;
+    }
     nextIndex = currentIndex + 1;
-    Serial.println(NO_REQUIREMENT);
+    LOG_DEBUGLN(NO_REQUIREMENT);
     if (queue[currentIndex]->require!=NO_REQUIREMENT)
     {
         //Si l'indice est négatif, on check en relatif. Sinon en absolu
         uint8_t indiceToCheck=(queue[currentIndex]->require>=0)?(queue[currentIndex]->require):(currentIndex + queue[currentIndex]->require);
         if (!fails[indiceToCheck])
         {
-            queue[currentIndex]->start();
+            arm(queue[currentIndex]);
         }
         else
         {
             fails[currentIndex]=true;
-            Logger::infoln(queue[currentIndex]->require);
-            Logger::infoln("Action "+ queue[currentIndex]->name + String(currentIndex)+" failed(requirementNotFilled)"+"("+String(getName())+")" /*queue[currentIndex]->timeout + queue[currentIndex]->require*/);
+            LOG_INFOLN(queue[currentIndex]->require);
+            LOG_INFOLN("Action ", queue[currentIndex]->name, currentIndex, " failed(requirementNotFilled)(", getName(), ")" /*queue[currentIndex]->timeout + queue[currentIndex]->require*/);
             startFollowing();
         }
     }
     else
 
-        queue[currentIndex]->start();
+        arm(queue[currentIndex]);
+}
+
+void Sequence::arm(Action *action)
+{
+    Wakeups::clear(getName());
+    action->start();
+    action->subscribe(getName());
+    Wakeups::wake(getName()); //Premiere evaluation au prochain tour
 }
 
 void Sequence::forceFollowing()
 {
+    if (program != nullptr)
+    {
+        program->skip();
+        Wakeups::wake(getName());
+        return;
+    }
     fails[currentIndex] = true;
     startFollowing();
 }
@@ -45,11 +67,16 @@ void Sequence::update()
 {
     if (paused)
         return;
+    if (program != nullptr)
+    {
+        program->update(this);
+        return;
+    }
 
     if (queue[currentIndex]->isFinished())
     {
         fails[currentIndex] = false;
-        Logger::debugln("Action "+String(currentIndex)+" succeded !");
+        LOG_DEBUGLN("Action ", currentIndex, " succeded !");
         if (nextIndex<=lastIndex)
         {
             queue[currentIndex]->doAtEnd();
@@ -59,7 +86,7 @@ void Sequence::update()
     else if (queue[currentIndex]->hasFailed())
     {
         fails[currentIndex] = true;
-        Logger::infoln("Action "+String(currentIndex)+" failed "+"("+String(getName())+")");
+        LOG_INFOLN("Action ", currentIndex, " failed (", getName(), ")");
         if (nextIndex<=lastIndex)
         {
             queue[currentIndex]->doAtEnd();   //<---------------------- DEBUUUUUUUG
@@ -71,7 +98,7 @@ void Sequence::update()
 void Sequence::setNextIndex(uint8_t index)
 {
     if (index >= TAILLESEQUENCE)
-        Logger::infoln("Tried to reach an index out of range");
+        LOG_INFOLN("Tried to reach an index out of range");
     else
         nextIndex = index;
 }
@@ -83,6 +110,7 @@ Sequence::Sequence(int mySeqIndex)
     nextIndex = 1;
     lastIndex = -1;
     paused=false;
+    program = nullptr;
 }
 
 SequenceName Sequence::getName()
@@ -90,6 +118,21 @@ SequenceName Sequence::getName()
     return (SequenceName)mySeqIndex;
 }
 
+uint8_t Sequence::getCurrentIndex()
+{
+    return currentIndex;
+}
+
+uint8_t Sequence::size()
+{
+    return lastIndex + 1;
+}
+
+bool Sequence::failed(uint8_t index)
+{
+    return index < TAILLESEQUENCE && fails[index];
+}
+
 void Sequence::add(Action *action)
 {
     queue[lastIndex + 1] = action;
@@ -98,19 +141,33 @@ void Sequence::add(Action *action)
     lastIndex++;
 }
 
+void Sequence::run(Program *program)
+{
+    this->program = program;
+    if (program != nullptr)
+        program->restart();
+    Wakeups::wake(getName());
+}
+
+Program *Sequence::getProgram()
+{
+    return program;
+}
+
 void Sequence::toTelemetry()
 {
-    Logger::toTelemetry("i",String(currentIndex));
+    LOG_TELEMETRY("i",currentIndex);
     for (int i = 0; i <= lastIndex; i++)
     {
-        Logger::toTelemetry("A"+String(i),queue[i]->name);
-        Logger::toTelemetry("F"+String(i),String(fails[i]));
+        LOG_TELEMETRY("A",i,queue[i]->name);
+        LOG_TELEMETRY("F",i,fails[i]);
     }
 }
 
 void Sequence::pause(bool lockGhost)
 {
     paused=true;
+    Wakeups::clear(getName()); //resume relance l'action, qui se reabonne
     if (lockGhost)
     {
         Action::robot->controller.setCurrentProfile(brake);
@@ -125,6 +182,8 @@ void Sequence::resume()
 }
 
 void Sequence::reset(bool lockGhost){
+    if (program != nullptr)
+        program->restart();
     currentIndex = 0;
     nextIndex = 1;
     for (int i=0;i<lastIndex;i++)
@@ -1,14 +1,16 @@
 #ifndef SEQUENCE_H_
 #define SEQUENCE_H_
 /*
-Chose qu'il est possible de faire:
-
-0: Forward_Action 1.0 Fast      //L'action 0 avance de 1m rapidement
-1: Set_Action 0 true 2          //L'action 1 incrémente de 2 la variable globale d'indice 0
-2: Jump_Action 0 sup 10 3 0     //L'action 2 passe a l'instruction 3 si la variable globale d'indice 0 est superieur à 10. Sinon elle passe à 0
-3: Send_Action Ouvre_Pince      //L'action 3 envoie le message Ouvre_Pince a l'arduino
-4: Wait_Action 500              //L'action 4 bloque la queue pendant 500 secondes
-5: Spin_Action 3.14 fast        //L'action 5 tourne le robot vers pi
+Une sequence execute soit sa file d'actions (add), soit un programme televersé (run, cf Program.h et tools/sequence_asm.py) :
+
+    forward 1.0 fast                //Avance de 1m rapidement
+    add 0 2                         //Incrémente de 2 la variable globale d'indice 0
+    jump_if 0 > 10 fin              //Passe a l'etiquette fin si la variable globale d'indice 0 est superieure à 10
+    send actu BrasD_M Sortir        //Envoie l'ordre Sortir au bras droit (arduino)
+    sleep 0.5                       //Bloque la sequence pendant 0.5 seconde
+fin:
+    spin 3.14 fast mirror           //Tourne le robot vers pi (miroiré pour le robot jaune)
+    end lock
 */
 
 
@@ -17,6 +19,7 @@ Chose qu'il est possible de faire:
 #include "SequenceName.h"
 
 class Action;
+class Program;
 
 class Sequence
 {
@@ -27,11 +30,31 @@ private:
     int16_t lastIndex;
     bool paused;
     int mySeqIndex;
+    Program *program; //Programme executé a la place de la file (cf Program.h), nullptr sinon
+
+    /*
+    * Demarre l'action et remplace les conditions de reveil de la sequence par les siennes (cf Wakeups.h)
+    */
+    void arm(Action *action);
+
+    friend class Program;
 public:
     uint8_t nextIndex;
 
     SequenceName getName();
 
+    uint8_t getCurrentIndex();
+
+    /*
+    * Nombre d'actions de la file (indice de la prochaine action ajoutée)
+    */
+    uint8_t size();
+
+    /*
+    * Vrai si l'action d'indice index a foiré a sa derniere execution
+    */
+    bool failed(uint8_t index);
+
     /*
     * Demarre l'action désigné par currentIndex (débloque la séquence si nécessaire)
     */
@@ -49,6 +72,7 @@ public:
 
     /*
     * Verifie l'etat de l'action en cours et agit si l'action réussi/foire
+    * Appelé par Robot::UpdateSequences seulement si un evenement attendu par l'action est arrivé (cf Wakeups.h)
     */
     void update();
 
@@ -61,13 +85,20 @@ public:
     * Cree une sequence vide
     * Par défaut, la séquence est en pause
     */
-    Sequence(int mySeqIndex);
+    Sequence(int mySeqIndex = 0);
 
     /*
     * Ajoute une action au bout de la séquence
     */
     void add(Action* action);
 
+    /*
+    * Execute un programme (bytecode, cf Program.h) a la place de la file d'actions, depuis son debut
+    * nullptr : retour a la file d'actions
+    */
+    void run(Program *program);
+    Program *getProgram();
+
     /*
     * Upload les informations liée a cette séquence
     * (A n'utiliser que sur une des séquences...)
@@ -75,7 +106,7 @@ public:
     void toTelemetry();
 
     /*
-    * Empèche l'actualisation de la séquence et lock le ghost (ou pas)
+    * Empèche l'actualisation de la séquence (oublie ses conditions de reveil) et lock le ghost (ou pas)
     */
     void pause(bool lockGhost);
 
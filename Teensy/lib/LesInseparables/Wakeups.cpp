@@ -0,0 +1,168 @@
+#include "Wakeups.h"
+
+static_assert(__NBSEQUENCES__ <= 8, "Wakeups : one bit per sequence in a uint8_t");
+static_assert((WAKE_WHEEL_SLOTS & (WAKE_WHEEL_SLOTS - 1)) == 0, "WAKE_WHEEL_SLOTS must be a power of 2");
+
+uint8_t Wakeups::pending = 0;
+uint8_t Wakeups::polled = 0;
+uint8_t Wakeups::visited = 0;
+uint8_t Wakeups::stateSubscribers = 0;
+uint8_t Wakeups::messageSubscribers[__NBMESSAGES__];
+uint8_t Wakeups::errorSubscribers[__NBERROR__];
+uint8_t Wakeups::stateMasks[__NBSEQUENCES__];
+uint64_t Wakeups::dates[__NBSEQUENCES__];
+int8_t Wakeups::slotOf[__NBSEQUENCES__];
+int8_t Wakeups::nextInSlot[__NBSEQUENCES__];
+int8_t Wakeups::heads[WAKE_WHEEL_SLOTS];
+uint64_t Wakeups::wheelTick = 0;
+ErrorSubscriber Wakeups::errors;
+
+void Wakeups::setup()
+{
+    pending = 0;
+    polled = 0;
+    visited = 0;
+    stateSubscribers = 0;
+    memset(messageSubscribers, 0, sizeof(messageSubscribers));
+    memset(errorSubscribers, 0, sizeof(errorSubscribers));
+    memset(stateMasks, 0, sizeof(stateMasks));
+    memset(slotOf, -1, sizeof(slotOf));
+    memset(heads, -1, sizeof(heads));
+    wheelTick = 0;
+    errors.catchUp();
+}
+
+void Wakeups::unschedule(uint8_t sequence)
+{
+    if (slotOf[sequence] < 0)
+        return;
+    int8_t *link = &heads[slotOf[sequence]];
+    while (*link != (int8_t)sequence)
+        link = &nextInSlot[*link];
+    *link = nextInSlot[sequence];
+    slotOf[sequence] = -1;
+}
+
+void Wakeups::clear(SequenceName sequence)
+{
+    uint8_t keep = ~(1 << sequence);
+    polled &= keep;
+    for (int i = 0; i < __NBMESSAGES__; i++)
+        messageSubscribers[i] &= keep;
+    for (int i = 0; i < __NBERROR__; i++)
+        errorSubscribers[i] &= keep;
+    stateSubscribers &= keep;
+    stateMasks[sequence] = 0;
+    unschedule(sequence);
+}
+
+void Wakeups::wake(SequenceName sequence)
+{
+    pending |= 1 << sequence;
+}
+
+void Wakeups::poll(SequenceName sequence)
+{
+    polled |= 1 << sequence;
+}
+
+void Wakeups::at(SequenceName sequence, uint64_t date)
+{
+    unschedule(sequence);
+    uint64_t tick = max(date / WAKE_WHEEL_TICK, wheelTick); //Case deja passée : vue au prochain collect
+    uint8_t slot = tick & (WAKE_WHEEL_SLOTS - 1);
+    dates[sequence] = date;
+    slotOf[sequence] = slot;
+    nextInSlot[sequence] = heads[slot];
+    heads[slot] = sequence;
+}
+
+void Wakeups::onMessage(SequenceName sequence, MessageID id)
+{
+    if (id < __NBMESSAGES__)
+        messageSubscribers[id] |= 1 << sequence;
+    else
+        poll(sequence); //Id inconnu (programme televersé) : on ne peut pas s'y abonner
+}
+
+void Wakeups::onError(SequenceName sequence, Error error)
+{
+    errorSubscribers[error] |= 1 << sequence;
+}
+
+void Wakeups::onState(SequenceName sequence, uint8_t state)
+{
+    stateMasks[sequence] |= state;
+    stateSubscribers |= 1 << sequence;
+}
+
+void Wakeups::collect(uint64_t now, uint8_t state)
+{
+    visited = 0;
+
+    //Cases de la roue depuis le dernier tour (un tour complet au plus), la case courante est revue au prochain collect
+    uint64_t tick = now / WAKE_WHEEL_TICK;
+    uint64_t nbSlots = min(tick - wheelTick + 1, (uint64_t)WAKE_WHEEL_SLOTS);
+    for (uint64_t i = 0; i < nbSlots; i++)
+    {
+        int8_t *link = &heads[(wheelTick + i) & (WAKE_WHEEL_SLOTS - 1)];
+        while (*link >= 0)
+        {
+            int8_t sequence = *link;
+            if (dates[sequence] <= now)
+            {
+                *link = nextInSlot[sequence];
+                slotOf[sequence] = -1;
+                pending |= 1 << sequence;
+                polled |= 1 << sequence; //Echeance passée : evaluée a chaque tour jusqu'a la fin de l'action
+            }
+            else
+                link = &nextInSlot[sequence]; //Tour suivant de la roue
+        }
+    }
+    wheelTick = tick;
+
+    ErrorEvent event;
+    while (errors.poll(event))
+        pending |= errorSubscribers[event.error];
+
+    for (uint8_t subscribers = stateSubscribers; subscribers != 0; subscribers &= subscribers - 1)
+    {
+        uint8_t sequence = __builtin_ctz(subscribers);
+        if ((state & stateMasks[sequence]) == stateMasks[sequence])
+            pending |= 1 << sequence;
+    }
+}
+
+void Wakeups::message(MessageID id)
+{
+    if (id < __NBMESSAGES__)
+        pending |= messageSubscribers[id];
+}
+
+uint8_t Wakeups::deliver(MessageID id)
+{
+    uint8_t awake = polled;
+    if (id < __NBMESSAGES__)
+        awake |= messageSubscribers[id];
+    pending &= ~awake; //Evaluées maintenant
+    return awake;
+}
+
+uint8_t Wakeups::take(uint8_t sequences)
+{
+    uint8_t awake = pending & sequences;
+    pending &= ~awake;
+    return awake;
+}
+
+int8_t Wakeups::next()
+{
+    uint8_t awake = (pending | polled) & ~visited;
+    if (awake == 0)
+        return -1;
+    int8_t sequence = __builtin_ctz(awake);
+    visited |= 1 << sequence;
+    pending &= ~(1 << sequence);
+    return sequence;
+}
@@ -0,0 +1,88 @@
+/**   Ensmasteel Library - Wake conditions of the sequences
+ * note : Une sequence n'evalue son action (isFinished/hasFailed) que lorsqu'un evenement a pu la faire changer.
+ *        Apres son start, chaque action declare ce qu'elle attend (Action::subscribe) :
+ *          une date (roue de temporisation : timeout, fin d'un Sleep),
+ *          un message (abonnés par MessageID, les deux ports confondus),
+ *          une erreur (abonnés par Error, lue sur le bus),
+ *          un etat du robot (ghost arrivé, asservissement proche : reveil tant que tous les etats demandés sont vrais).
+ *        Robot::UpdateSequences publie les evenements du tour (collect) puis n'appelle update que sur les sequences
+ *        reveillées (next) : le cout d'un tour suit le nombre d'evenements, plus le nombre de sequences.
+ *        Les messages sont routés au rythme de la communication (deliver) : chaque message reçu met a jour tout de suite
+ *        ses abonnés (et les sequences en poll), puis il est supprimé. Quand la boite est vide, ces sequences enchainent leurs
+ *        actions suivantes (take) : elles attendent de nouveau avant le message suivant.
+ *        Une sequence est toujours reveillée une fois apres le start de son action (premiere evaluation, comme avant),
+ *        puis a chaque tour une fois son echeance passée (les arrondis des timeouts en float ne bloquent jamais une action).
+ *        Une action qui ne declare rien (Wait_Tirette, qui lit un pin...) est evaluée a chaque tour (poll), comme avant.
+ *        Les conditions d'une sequence s'ajoutent jusqu'au start suivant ou a sa pause (clear).
+*/
+
+#ifndef WAKEUPS_H_
+#define WAKEUPS_H_
+
+#include "Arduino.h"
+#include "SequenceName.h"
+#include "MessageID.h"
+#include "ErrorManager.h"
+
+#define WAKE_WHEEL_SLOTS 32   //Cases de la roue de temporisation (puissance de 2)
+#define WAKE_WHEEL_TICK 10000 // [...] = us, largeur d'une case
+
+//Etats du robot (onState, collect)
+#define WAKE_GHOST_FINISHED 0x01
+#define WAKE_CONTROLLER_CLOSE 0x02
+
+class Wakeups
+{
+public:
+    static void clear(SequenceName sequence); //Oublie toutes les conditions de la sequence (start ou pause de son action)
+    static void wake(SequenceName sequence);  //Evaluation au prochain next (dans ce tour si elle n'a pas encore été evaluée)
+    static void poll(SequenceName sequence);  //Evaluation a chaque tour jusqu'au prochain clear
+
+    // GOAL / Wake the sequence at a date
+    // IN   / uint64_t date : us (Clock), only the last date given since clear is kept
+    static void at(SequenceName sequence, uint64_t date);
+
+    static void onMessage(SequenceName sequence, MessageID id);
+    static void onError(SequenceName sequence, Error error);
+    static void onState(SequenceName sequence, uint8_t state); //WAKE_GHOST_FINISHED, WAKE_CONTROLLER_CLOSE (tous vrais)
+
+    // GOAL / Start a tick : fire the dates up to now, the errors published since the last tick and the robot state
+    // IN   / uint8_t state : WAKE_* flags true now
+    static void collect(uint64_t now, uint8_t state);
+    static void message(MessageID id); //Message le plus ancien d'un port, lu par les sequences pendant ce tour
+
+    // GOAL / A message is routed now, outside of a tick (Robot::UpdateCommunication, at the comm rate)
+    // OUT  / uint8_t : sequences to update immediately (bit i : sequence i), they leave pending
+    static uint8_t deliver(MessageID id);
+
+    // GOAL / Sequences among the given ones that are awake now (first evaluation of a new action), they leave pending
+    static uint8_t take(uint8_t sequences);
+
+    // GOAL / Next sequence to update in this tick (each sequence at most once per tick)
+    // OUT  / int8_t : -1 if no sequence is awake
+    static int8_t next();
+
+    static void setup();
+
+private:
+    static uint8_t pending;  //Sequences reveillées (bit i : sequence i)
+    static uint8_t polled;   //Sequences evaluées a chaque tour
+    static uint8_t visited;  //Sequences deja evaluées dans ce tour
+    static uint8_t messageSubscribers[__NBMESSAGES__];
+    static uint8_t errorSubscribers[__NBERROR__];
+    static uint8_t stateSubscribers; //Sequences qui attendent un etat du robot (stateMasks)
+    static uint8_t stateMasks[__NBSEQUENCES__];
+
+    //Roue de temporisation : une echeance au plus par sequence, chainées par case
+    static uint64_t dates[__NBSEQUENCES__];
+    static int8_t slotOf[__NBSEQUENCES__]; //-1 : pas d'echeance
+    static int8_t nextInSlot[__NBSEQUENCES__];
+    static int8_t heads[WAKE_WHEEL_SLOTS];
+    static uint64_t wheelTick; //Premiere case pas encore entierement passée (en WAKE_WHEEL_TICK)
+
+    static ErrorSubscriber errors;
+
+    static void unschedule(uint8_t sequence);
+};
+
+#endif // !WAKEUPS_H_
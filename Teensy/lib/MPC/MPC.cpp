@@ -0,0 +1,127 @@
+#include "MPC.h"
+
+MPCAxis::MPCAxis(MPCAxisType type, DynamicModel *model)
+{
+    if (type == MPC_TRANSLATION)
+    {
+        //m*dv/dt = 2*maxMotorForce*T - 2*friction*v
+        gain = 2 * model->maxMotorForce / model->mass;
+        decay = 2 * model->friction / model->mass;
+        qPosition = MPC_Q_POSITION_TRANSLATION;
+        qSpeed = MPC_Q_SPEED_TRANSLATION;
+    }
+    else
+    {
+        //J*dw/dt = maxMotorForce*size*R - friction*size^2/2*w
+        gain = model->maxMotorForce * model->size / model->J;
+        decay = model->friction * model->size * model->size / (2 * model->J);
+        qPosition = MPC_Q_POSITION_ROTATION;
+        qSpeed = MPC_Q_SPEED_ROTATION;
+    }
+    coeffDt = -1;
+    reset();
+}
+
+void MPCAxis::reset()
+{
+    for (int i = 0; i < MPC_HORIZON; i++)
+        u[i] = 0;
+}
+
+const float *MPCAxis::getOrders()
+{
+    return u;
+}
+
+void MPCAxis::computeMatrices(float dt)
+{
+    //Discretisation exacte (bloqueur d'ordre 0) : stable quel que soit dt
+    float e = exp(-decay * dt);
+    av = e;
+    bv = gain * (1 - e) / decay;
+    ap = (1 - e) / decay;
+    bp = gain / decay * (dt - ap);
+
+    hP[0] = bp;
+    hV[0] = bv;
+    for (int i = 1; i < MPC_HORIZON; i++)
+    {
+        hP[i] = hP[i - 1] + ap * hV[i - 1];
+        hV[i] = av * hV[i - 1];
+    }
+
+    //H[i][j] = sum sur k >= max(i,j) de qP*hP[k-i]*hP[k-j] + qV*hV[k-i]*hV[k-j], + qOrder sur la diagonale
+    float lipschitz = 0;
+    for (int i = 0; i < MPC_HORIZON; i++)
+    {
+        for (int j = 0; j <= i; j++)
+        {
+            float sum = (i == j) ? MPC_Q_ORDER : 0;
+            for (int k = i; k < MPC_HORIZON; k++)
+                sum += qPosition * hP[k - i] * hP[k - j] + qSpeed * hV[k - i] * hV[k - j];
+            H[i][j] = sum;
+            H[j][i] = sum;
+        }
+    }
+    for (int i = 0; i < MPC_HORIZON; i++) //Gershgorin : majorant de la plus grande valeur propre
+    {
+        float row = 0;
+        for (int j = 0; j < MPC_HORIZON; j++)
+            row += abs(H[i][j]);
+        lipschitz = max(lipschitz, row);
+    }
+    step = 1 / lipschitz;
+    coeffDt = dt;
+}
+
+float MPCAxis::solve(float position, float speed, const float *pRef, const float *vRef, const float *bound, float dt)
+{
+    if (dt != coeffDt)
+        computeMatrices(dt);
+
+    //Reponse libre et partie lineaire du cout : grad[j] = sum sur k >= j de qP*hP[k-j]*(pFree_k - pRef_k) + qV*hV[k-j]*(vFree_k - vRef_k)
+    float errP[MPC_HORIZON], errV[MPC_HORIZON];
+    float p = position, v = speed;
+    for (int k = 0; k < MPC_HORIZON; k++)
+    {
+        p += ap * v;
+        v *= av;
+        errP[k] = qPosition * (p - pRef[k]);
+        errV[k] = qSpeed * (v - vRef[k]);
+    }
+    for (int j = 0; j < MPC_HORIZON; j++)
+    {
+        float sum = 0;
+        for (int k = j; k < MPC_HORIZON; k++)
+            sum += hP[k - j] * errP[k] + hV[k - j] * errV[k];
+        grad[j] = sum;
+    }
+
+    //Warm start : solution precedente decalée d'un pas
+    for (int i = 0; i < MPC_HORIZON; i++)
+    {
+        u[i] = (i + 1 < MPC_HORIZON) ? u[i + 1] : u[i];
+        u[i] = constrain(u[i], -bound[i], bound[i]);
+        y[i] = u[i];
+    }
+
+    //FISTA : gradient projeté accéléré sur la boite |u_k| <= bound[k]
+    float tk = 1;
+    for (int it = 0; it < MPC_ITERATIONS; it++)
+    {
+        for (int i = 0; i < MPC_HORIZON; i++)
+        {
+            float g = grad[i];
+            for (int j = 0; j < MPC_HORIZON; j++)
+                g += H[i][j] * y[j];
+            uPrev[i] = u[i];
+            u[i] = constrain(y[i] - step * g, -bound[i], bound[i]);
+        }
+        float tNext = (1 + sqrt(1 + 4 * tk * tk)) / 2;
+        float momentum = (tk - 1) / tNext;
+        for (int i = 0; i < MPC_HORIZON; i++)
+            y[i] = u[i] + momentum * (u[i] - uPrev[i]);
+        tk = tNext;
+    }
+    return u[0];
+}
@@ -0,0 +1,64 @@
+/**   Ensmasteel Library - Model predictive control of one axis
+ * note : Linear model of the axis taken from DynamicModel (first order on the speed, exact discretisation)
+ *        Condensed QP : only the N future orders are unknowns, the prediction matrices are precomputed
+ *        Solved by a projected fast gradient (FISTA) with a fixed number of iterations, without any allocation
+*/
+
+#ifndef MPC_H_
+#define MPC_H_
+
+#include "Arduino.h"
+#include "DynamicModel.h"
+
+#define MPC_HORIZON 15    //Nombre de pas de prediction
+#define MPC_ITERATIONS 25 //Iterations du gradient projeté par resolution (temps de calcul fixe)
+
+//Poids du cout : sum( qPosition*(p-pRef)^2 + qSpeed*(v-vRef)^2 + qOrder*u^2 )
+#define MPC_Q_POSITION_TRANSLATION 1.0e5 // [...] = m^-2
+#define MPC_Q_SPEED_TRANSLATION 1.0e2    // [...] = (m/s)^-2
+#define MPC_Q_POSITION_ROTATION 1.0e4    // [...] = rad^-2
+#define MPC_Q_SPEED_ROTATION 1.0e1       // [...] = (rad/s)^-2
+#define MPC_Q_ORDER 1.0
+
+enum MPCAxisType
+{
+    MPC_TRANSLATION,
+    MPC_ROTATION
+};
+
+class MPCAxis
+{
+public:
+    // GOAL / Solve the tracking problem from the current state of the axis
+    // IN   / float position, speed : current state (the position can be relative, pRef must use the same origin)
+    //        const float *pRef, *vRef : reference over the horizon, at dt, 2dt ... N*dt
+    //        const float *bound : |u_k| <= bound[k] (MPC_HORIZON values)
+    //        float dt : step of the prediction (matrices are recomputed only if it changes)
+    // OUT  / float : first order of the optimal sequence (the others are kept to warm start the next call)
+    float solve(float position, float speed, const float *pRef, const float *vRef, const float *bound, float dt);
+
+    const float *getOrders(); //Sequence optimale de la derniere resolution (MPC_HORIZON ordres)
+    void reset();             //Oublie la solution precedente (pas de warm start)
+
+    MPCAxis(MPCAxisType type, DynamicModel *model);
+    MPCAxis() {}
+
+private:
+    float gain, decay;    //dv/dt = gain*u - decay*v (cf DynamicModel)
+    float qPosition, qSpeed;
+    float coeffDt;        //dt pour lequel les matrices ont été calculées
+
+    //Modele discret : p+ = p + ap*v + bp*u ; v+ = av*v + bv*u
+    float ap, bp, av, bv;
+    float hP[MPC_HORIZON], hV[MPC_HORIZON]; //Reponse impulsionnelle : effet de u_j sur p_k et v_k (k-j)
+    float H[MPC_HORIZON][MPC_HORIZON];      //Hessienne du QP condensé
+    float step;                             //1/L, L majorant de la plus grande valeur propre de H
+
+    float u[MPC_HORIZON];     //Solution courante
+    float grad[MPC_HORIZON];  //Partie lineaire du cout
+    float y[MPC_HORIZON], uPrev[MPC_HORIZON];
+
+    void computeMatrices(float dt);
+};
+
+#endif // !MPC_H_
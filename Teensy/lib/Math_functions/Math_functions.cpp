@@ -36,6 +36,18 @@ float Polynome::df(float x)
     return out;
 }
 
+float Polynome::ddf(float x)
+{
+    float out = 0.0;
+    float xn = 1.0;
+    for (int i = 2; i < DEGRE_MAX; i += 1)
+    {
+        out = out + K[i] * xn * i * (i - 1);
+        xn = xn * x;
+    }
+    return out;
+}
+
 void Polynome::set(float a0, float a1, float a2, float a3, float a4, float a5, float a6)
 {
     K[0] = a0;
@@ -51,13 +63,13 @@ void Polynome::toDebug()
 {
     for (int i = 0; i < DEGRE_MAX; i += 1)
     {
-        Logger::debug(String(K[i]));
-        Logger::debug(" x^");
-        Logger::debug(String(i));
+        LOG_DEBUG(K[i]);
+        LOG_DEBUG(" x^");
+        LOG_DEBUG(i);
         if (i < DEGRE_MAX - 1)
-            Logger::debug(" + ");
+            LOG_DEBUG(" + ");
     }
-    Logger::debug("\n");
+    LOG_DEBUG("\n");
 }
 
 Polynome init_polynome(float a0, float a1, float a2, float a3, float a4, float a5, float a6)
@@ -171,7 +183,7 @@ float Trapezoidal_Function::f(float x)
     {
         if (_triangleFunction)
         {
-            //Logger::infoln("triangle function");
+            //LOG_INFOLN("triangle function");
             if (x < _tMax)
             {
                 out = x * _upRamp;
@@ -211,14 +223,14 @@ float Trapezoidal_Function::df(float x)
     {
         if (_triangleFunction)
         {
-            //Logger::infoln("triangle function");
+            //LOG_INFOLN("triangle function");
             if (x < _tMax)
             {
                 out = _upRamp;
             }
             else if (x < _duration)
             {
-                out = _downRamp;
+                out = -_downRamp;
             }
         }
         else
@@ -233,7 +245,7 @@ float Trapezoidal_Function::df(float x)
             }
             else if (x < _duration)
             {
-                out = _downRamp;
+                out = -_downRamp;
             }
         }
     }
@@ -9,18 +9,23 @@ void Score::reset()
     this->cumulError=0;
     this->maxOvershoot=0;
     this->nbInversion=0;
+    this->peakError=0;
+    this->saturationTime=0;
 }
 
-void Score::toTelemetry(String prefix)
+void Score::toTelemetry(const char *prefix)
 {
-    Logger::toTelemetry(prefix+"cum",String(cumulError));
-    Logger::toTelemetry(prefix+"ovs",String(maxOvershoot));
-    Logger::toTelemetry(prefix+"inv",String(nbInversion));
+    LOG_TELEMETRY(prefix,"cum",cumulError);
+    LOG_TELEMETRY(prefix,"ovs",maxOvershoot);
+    LOG_TELEMETRY(prefix,"inv",nbInversion);
+    LOG_TELEMETRY(prefix,"pk",peakError);
+    LOG_TELEMETRY(prefix,"sat",saturationTime);
 }
 
-void PID::reset()
+void PID::reset(bool resetIntegral)
 {
-    this->iTerm = 0;
+    if (resetIntegral)
+        this->iTerm = 0;
     score.reset();
 }
 
@@ -29,28 +34,43 @@ Score PID::getScore(){
 }
 
 void PID::setCurrentProfile(MoveProfileName name){
-    this->currentProfile = MoveProfiles::get(name,!modulo360);
+    MoveProfile* newProfile = MoveProfiles::get(name,!modulo360);
+    if (currentProfile != 0)
+    {
+        //On part des gains appliqués a cet instant (meme si une interpolation etait en cours)
+        fromGains = getGains();
+        blendTime = 0;
+    }
+    else
+        blendTime = blendDuration; //Premier profil : pas d'interpolation
+    this->currentProfile = newProfile;
+}
+
+Gains PID::getGains(){
+    Gains out;
+    float alpha = (blendDuration > 0) ? min(blendTime / blendDuration, 1.0f) : 1.0f;
+    out.KP = fromGains.KP + alpha * (currentProfile->KP - fromGains.KP);
+    out.KI = fromGains.KI + alpha * (currentProfile->KI - fromGains.KI);
+    out.KD = fromGains.KD + alpha * (currentProfile->KD - fromGains.KD);
+    out.KA = fromGains.KA + alpha * (currentProfile->KA - fromGains.KA);
+    out.KF = fromGains.KF + alpha * (currentProfile->KF - fromGains.KF);
+    return out;
 }
 
 MoveProfile* PID::getCurrentProfile(){
     return currentProfile;
 }
 
-float PID::compute(float xTarget, float dxTarget, float x, float dx, float dt)
+float PID::computeError(float xTarget, float x)
 {
-    float error;
-    float dError;
-
     if (modulo360)
-        error = normalizeAngle(xTarget - x);
+        return normalizeAngle(xTarget - x);
     else
-        error = xTarget - x;
-
-    dxF.in(dx, dt);
-    dError = dxTarget - dxF.out();
-
-    iTerm += error * dt;
+        return xTarget - x;
+}
 
+void PID::monitor(float error, float dError, float dxTarget, float dt)
+{
     close = (abs(error) <= currentProfile->epsilon) && (abs(dError) <=currentProfile->dEpsilon);
 
     if (abs(error) > currentProfile->maxErr)
@@ -62,50 +82,213 @@ float PID::compute(float xTarget, float dxTarget, float x, float dx, float dt)
         ErrorManager::raise(PID_FAIL_ERROR);
 
     score.cumulError+=abs(error)*dt;
+    score.peakError = max(score.peakError, abs(error));
     if ((dxTarget>=0 && error<0) || (dxTarget<0 && error>0)) //Condition d'overshoot
         score.maxOvershoot = max(score.maxOvershoot, abs(error));
+}
+
+float PID::compute(float xTarget, float dxTarget, float x, float dx, float dt, float feedforward)
+{
+    float error = computeError(xTarget, x);
+    float dError;
+
+    dxF.in(dx, dt);
+    dError = dxTarget - dxF.out();
+
+    Gains gains = getGains();
+    blendTime += dt;
 
-    float out = constrain(
-        currentProfile->KP * error + currentProfile->KI * iTerm + currentProfile->KD * (currentProfile->KA*dxTarget - dxF.out()), -1.0, 1.0);
+    float pdTerm = gains.KP * error + gains.KD * (gains.KA*dxTarget - dxF.out()) + gains.KF * feedforward;
+
+    //Anti windup : on n'integre pas si l'ordre est saturé dans le sens de l'erreur, avec la limite du PWM
+    //effectivement appliquée au cycle precedent (cf recordOutput : la translation n'a que ce que laisse la rotation)
+    float unsaturated = pdTerm + iTerm;
+    if ((unsaturated < outLimit || error < 0) && (unsaturated > -outLimit || error > 0))
+        iTerm += gains.KI * error * dt;
+    iTerm = constrain(iTerm, -ITERM_MAX, ITERM_MAX);
+    if (currentProfile->KI == 0) //Le nouveau profil n'a pas d'integrateur : on le vide progressivement
+        iTerm = (blendTime >= blendDuration) ? 0 : iTerm * (1 - dt / (blendDuration - blendTime + dt));
+
+    monitor(error, dError, dxTarget, dt);
+
+    float out = constrain(pdTerm + iTerm, -1.0, 1.0);
+
+    return out;
+}
+
+void PID::recordOutput(float out, float limit, float dt)
+{
     if (lastOut*out<0 && (abs(lastOut)-abs(out))/dt > 0.01 ) //Changement de signe (1% a -1% d'output en une seconde)
         score.nbInversion = score.nbInversion + 1;
+    if (abs(out) >= limit - 1e-3)
+        score.saturationTime += dt;
+    outLimit = limit;
 
     lastOut=out;
+}
 
-    return out;
+float PID::observe(float xTarget, float dxTarget, float x, float dx, float dt)
+{
+    float error = computeError(xTarget, x);
+    dxF.in(dx, dt);
+    monitor(error, dxTarget - dxF.out(), dxTarget, dt);
+    return error;
+}
+
+float PID::computeSetpoint(float xTarget, float dxTarget, float x, float dx, float dt, float kPosition)
+{
+    return dxTarget + kPosition * observe(xTarget, dxTarget, x, dx, dt);
 }
 
 PID::PID(bool modulo360, float frequency)
 {
     this->currentProfile = 0;
-    this->dxF = Filtre(0, frequency);
+    this->dxF = Filtre(0, frequency, FIRST_ORDER);
     this->tooFar = false;
     this->close = true;
     this->modulo360 = modulo360;
     this->timeTooFar = 0;
     this->lastOut=0;
+    this->iTerm = 0;
+    this->outLimit = 1.0;
+    this->fromGains = {0, 0, 0, 0, 0};
+    this->blendTime = 0;
+    this->blendDuration = GAIN_BLEND_TIME;
 }
 
 PID::PID() {}
 
+//La loi est celle du profil de translation, pour les deux axes : MPC et Ramsete calculent les deux ordres ensemble
+//(la rotation est prioritaire, Ramsete corrige le cap avec l'erreur laterale). Le champ law de la rotation n'est pas lu
 void Asservissement::compute(float dt)
 {
+    if (pidTranslation.getCurrentProfile()->law == MPC_LAW)
+    {
+        computeMPC(dt);
+        return;
+    }
+    if (pidTranslation.getCurrentProfile()->law == RAMSETE_LAW)
+    {
+        computeRamsete(dt);
+        return;
+    }
+
     //lag behind represente l'avance du ghost sur le robot
     //C'est une avance projetée selon la direction du robot
     float lagBehind = (*cGhost - *cRobot) % (directeur(cRobot->_theta));
 
     needToGoForward = (lagBehind > 0);
-    *outRotation = pidRotation.compute(cGhost->_theta, cGhost->_w, cRobot->_theta, cRobot->_w, dt);
-    *outTranslation = constrain(pidTranslation.compute(lagBehind, cGhost->_v, 0, cRobot->_v, dt)
+
+    //Dynamique inverse : ordre qu'il faudrait pour suivre le ghost sans erreur. Le PID ne corrige que le residu
+    float ffRotation = model->rotationOrder(ghost->Get_Rotational_Acceleration(), cGhost->_w);
+    float ffTranslation = model->translationOrder(ghost->Get_Linear_Acceleration(), cGhost->_v);
+
+    *outRotation = pidRotation.compute(cGhost->_theta, cGhost->_w, cRobot->_theta, cRobot->_w, dt, ffRotation);
+    *outTranslation = constrain(pidTranslation.compute(lagBehind, cGhost->_v, 0, cRobot->_v, dt, ffTranslation)
                     , -(1 - abs(*outRotation)), 1 - abs(*outRotation)); //La rotation est prioritaire
+    pidRotation.recordOutput(*outRotation, 1, dt);
+    pidTranslation.recordOutput(*outTranslation, 1 - abs(*outRotation), dt);
     close = pidTranslation.close && pidRotation.close;
     tooFar = pidTranslation.tooFar || pidRotation.tooFar || (*cGhost - *cRobot).norm() > pidTranslation.getCurrentProfile()->epsilon;
 }
 
-void Asservissement::reset()
+void Asservissement::computeMPC(float dt)
 {
-    pidRotation.reset();
-    pidTranslation.reset();
+    float lagBehind = (*cGhost - *cRobot) % (directeur(cRobot->_theta));
+    float lagTheta = normalizeAngle(cGhost->_theta - cRobot->_theta);
+    needToGoForward = (lagBehind > 0);
+
+    //Reference sur l'horizon, relative a la position actuelle du robot (projetée sur sa direction)
+    float vRef[MPC_HORIZON], wRef[MPC_HORIZON], pRef[MPC_HORIZON], thetaRef[MPC_HORIZON], bound[MPC_HORIZON];
+    ghost->Get_Future_Speeds(dt, MPC_HORIZON, vRef, wRef);
+    float p = lagBehind, theta = lagTheta;
+    for (int k = 0; k < MPC_HORIZON; k++)
+    {
+        p += vRef[k] * dt;
+        theta += wRef[k] * dt;
+        pRef[k] = p;
+        thetaRef[k] = theta;
+        bound[k] = 1.0;
+    }
+
+    //La rotation est prioritaire : la translation dispose de ce qu'il reste a chaque pas
+    *outRotation = mpcRotation.solve(0, cRobot->_w, thetaRef, wRef, bound, dt);
+    const float *rotationOrders = mpcRotation.getOrders();
+    for (int k = 0; k < MPC_HORIZON; k++)
+        bound[k] = 1 - abs(rotationOrders[k]);
+    *outTranslation = mpcTranslation.solve(0, cRobot->_v, pRef, vRef, bound, dt);
+    pidRotation.recordOutput(*outRotation, 1, dt);
+    pidTranslation.recordOutput(*outTranslation, bound[0], dt);
+
+    bool finished = ghost->trajectoryIsFinished(); //cf computeCascade
+    pidRotation.observe(cGhost->_theta, (finished) ? 0 : cGhost->_w, cRobot->_theta, cRobot->_w, dt);
+    pidTranslation.observe(lagBehind, (finished) ? 0 : cGhost->_v, 0, cRobot->_v, dt);
+    close = pidTranslation.close && pidRotation.close;
+    tooFar = pidTranslation.tooFar || pidRotation.tooFar || (*cGhost - *cRobot).norm() > pidTranslation.getCurrentProfile()->epsilon;
+}
+
+void Asservissement::computeRamsete(float dt)
+{
+    //Erreur dans le repere du robot
+    Vector delta = *cGhost - *cRobot;
+    float ex = delta % directeur(cRobot->_theta);
+    float ey = delta % directeur(cRobot->_theta + PI / 2);
+    float eTheta = normalizeAngle(cGhost->_theta - cRobot->_theta);
+    needToGoForward = (ex > 0);
+
+    //Vitesses analytiques du ghost a t_delayed (profils de vitesse et courbure, cf Ghost::Get_Future_Speeds) plutot que derivées de sa position
+    float vGhost, wGhost;
+    ghost->Get_Future_Speeds(0, 1, &vGhost, &wGhost);
+
+    float k = 2 * RAMSETE_ZETA * sqrt(wGhost * wGhost + RAMSETE_B * vGhost * vGhost) + RAMSETE_K_MIN;
+    float sinc = (abs(eTheta) < 1e-4) ? 1.0 : sin(eTheta) / eTheta;
+    float v = vGhost * cos(eTheta) + k * ex;
+    float w = wGhost + k * eTheta + RAMSETE_B * vGhost * sinc * ey;
+
+    //Dynamique inverse pour suivre (v, w), plus une correction de l'erreur de vitesse en RAMSETE_TAU
+    *outRotation = constrain(model->rotationOrder(ghost->Get_Rotational_Acceleration() + (w - cRobot->_w) / RAMSETE_TAU, w), -1.0, 1.0);
+    *outTranslation = constrain(model->translationOrder(ghost->Get_Linear_Acceleration() + (v - cRobot->_v) / RAMSETE_TAU, v)
+                    , -(1 - abs(*outRotation)), 1 - abs(*outRotation)); //La rotation est prioritaire
+    pidRotation.recordOutput(*outRotation, 1, dt);
+    pidTranslation.recordOutput(*outTranslation, 1 - abs(*outRotation), dt);
+
+    bool finished = ghost->trajectoryIsFinished(); //cf computeCascade
+    //Ramsete tourne volontairement le cap pour rattraper l'erreur laterale : on surveille l'erreur de cap qui reste
+    //une fois cette correction comptée (celle que la loi annule, w - wGhost = k * eThetaResidual), pas le cap brut
+    float eThetaResidual = eTheta + RAMSETE_B * vGhost * sinc * ey / k;
+    pidRotation.observe(eThetaResidual, (finished) ? 0 : cGhost->_w, 0, cRobot->_w, dt);
+    pidTranslation.observe(ex, (finished) ? 0 : cGhost->_v, 0, cRobot->_v, dt);
+    close = pidTranslation.close && pidRotation.close;
+    tooFar = pidTranslation.tooFar || pidRotation.tooFar || delta.norm() > pidTranslation.getCurrentProfile()->epsilon;
+}
+
+void Asservissement::computeCascade(float dt)
+{
+    float lagBehind = (*cGhost - *cRobot) % (directeur(cRobot->_theta));
+
+    needToGoForward = (lagBehind > 0);
+    //Les vitesses du ghost sont derivées de sa position : le dernier pas (saut sur la cible) donne un pic a ne pas suivre
+    bool finished = ghost->trajectoryIsFinished();
+    float w = pidRotation.computeSetpoint(cGhost->_theta, (finished) ? 0 : cGhost->_w, cRobot->_theta, cRobot->_w, dt, CASCADE_KP_ROTATION);
+    float v = pidTranslation.computeSetpoint(lagBehind, (finished) ? 0 : cGhost->_v, 0, cRobot->_v, dt, CASCADE_KP_TRANSLATION);
+    wheelTargetLeft = v - w * model->size / 2;
+    wheelTargetRight = v + w * model->size / 2;
+    close = pidTranslation.close && pidRotation.close;
+    tooFar = pidTranslation.tooFar || pidRotation.tooFar || (*cGhost - *cRobot).norm() > pidTranslation.getCurrentProfile()->epsilon;
+}
+
+void Asservissement::reset(bool resetIntegral)
+{
+    pidRotation.reset(resetIntegral);
+    pidTranslation.reset(resetIntegral);
+    mpcRotation.reset();
+    mpcTranslation.reset();
+}
+
+void Asservissement::setBlendDuration(float duration)
+{
+    pidRotation.blendDuration = duration;
+    pidTranslation.blendDuration = duration;
 }
 
 void Asservissement::sendScoreToTelemetry()
@@ -114,7 +297,12 @@ void Asservissement::sendScoreToTelemetry()
     pidTranslation.getScore().toTelemetry("T");
 }
 
-Asservissement::Asservissement(float *outTranslation, float *outRotation, Cinetique *cRobot, Cinetique *cGhost, float frequency)
+Score Asservissement::getScore(bool translation)
+{
+    return (translation) ? pidTranslation.getScore() : pidRotation.getScore();
+}
+
+Asservissement::Asservissement(float *outTranslation, float *outRotation, Cinetique *cRobot, Cinetique *cGhost, Ghost *ghost, DynamicModel *model, float frequency)
 {
     pidRotation = PID(true, frequency);
     pidTranslation = PID(false, frequency);
@@ -122,9 +310,15 @@ Asservissement::Asservissement(float *outTranslation, float *outRotation, Cineti
     this->outRotation = outRotation;
     this->cRobot = cRobot;
     this->cGhost = cGhost;
+    this->ghost = ghost;
+    this->model = model;
+    this->mpcTranslation = MPCAxis(MPC_TRANSLATION, model);
+    this->mpcRotation = MPCAxis(MPC_ROTATION, model);
     this->tooFar = false;
     this->close = true;
     this->needToGoForward = false;
+    this->wheelTargetLeft = 0;
+    this->wheelTargetRight = 0;
 }
 
 void Asservissement::setCurrentProfile(MoveProfileName name)
@@ -139,4 +333,27 @@ float Asservissement::tweak(bool incr, bool translation, uint8_t whichOne)
         return MoveProfiles::tweak(pidTranslation.currentProfile,incr,whichOne);
     else
         return MoveProfiles::tweak(pidRotation.currentProfile,incr,whichOne);
+}
+
+float VelocityLoop::compute(float vTarget, float v, float dt)
+{
+    float error = vTarget - v;
+    float out = KV * vTarget + KP * error + iTerm;
+    //Anti windup : on n'integre pas si la sortie est saturée dans le sens de l'erreur
+    if ((out < 1.0 || error < 0) && (out > -1.0 || error > 0))
+        iTerm += KI * error * dt;
+    return constrain(out, -1.0, 1.0);
+}
+
+void VelocityLoop::reset()
+{
+    iTerm = 0;
+}
+
+VelocityLoop::VelocityLoop(float KP, float KI, float KV)
+{
+    this->KP = KP;
+    this->KI = KI;
+    this->KV = KV;
+    this->iTerm = 0;
 }
\ No newline at end of file
@@ -3,8 +3,21 @@
 #include "MoveProfile.h"
 #define NBPROFILES ((int)Pace::NB_PACE)
 #define TIMETOOFAR 0.2 //Temps qu'il faut rester trop loin pour etre considere tooFar
+#define CASCADE_KP_TRANSLATION 15.0 //Boucle de position en cascade : (m/s) de consigne par metre d'erreur
+#define CASCADE_KP_ROTATION 25.0    //Boucle de position en cascade : (rad/s) de consigne par radian d'erreur
+#define VELOCITY_KP 5.0             //Boucle de vitesse roue : ordre par (m/s) d'erreur
+#define VELOCITY_KI 100.0           //Boucle de vitesse roue : ordre par metre d'erreur cumulée
+#define RAMSETE_B 40.0    //Ramsete : poids de l'erreur laterale (rad^2/m^2)
+#define RAMSETE_ZETA 0.7  //Ramsete : amortissement
+#define RAMSETE_K_MIN 4.0 //Ramsete : gain minimal (1/s), sinon le robot ne corrige plus rien quand le ghost est a l'arret
+#define RAMSETE_TAU 0.05  //Ramsete : constante de temps de la correction de vitesse (s)
+#define GAIN_BLEND_TIME 0.15 //Duree de l'interpolation des gains lors d'un changement de profil (s)
+#define ITERM_MAX 1.0        //Borne de l'integrateur : seul, il ne peut pas demander plus que l'ordre maximal
 #include "Filtre.h"
 #include "Vector.h"
+#include "DynamicModel.h"
+#include "Ghost.h"
+#include "MPC.h"
 
 
 // La variable x définit une grandeur quelconque. dx est sa derivee.
@@ -16,28 +29,48 @@ public:
     float cumulError=0;
     float maxOvershoot=0;
     uint16_t nbInversion=0;
+    float peakError=0;      //Erreur maximale (en valeur absolue)
+    float saturationTime=0; //Temps passé avec l'ordre saturé (s)
     void reset();
-    void toTelemetry(String prefix);
+    void toTelemetry(const char *prefix);
+};
+
+//Gains effectivement appliqués (interpolés entre deux profils)
+struct Gains
+{
+    float KP, KI, KD, KA, KF;
 };
 
 class PID
 {
 private:
     MoveProfile* currentProfile; //C'est u pointeur car on veut etre sur qu'il n'y a qu'une seule version d'un profile (pas de copies !)
-    float iTerm;
+    float iTerm;      //Contribution de l'integrateur a la sortie (somme de KI*error*dt) : un changement de KI ne fait pas sauter la sortie
+    Gains fromGains;  //Gains au moment du changement de profil
+    float blendTime;  //Temps depuis le dernier changement de profil
+    float blendDuration; //Duree de l'interpolation (0 : changement instantané)
     bool modulo360;   //Permet de dire si les valeurs sont a interprété modulo 360
-    Filtre dxF;       //Filtre de la derivee
+    Filtre dxF;       //Filtre de la derivee (Butterworth d'ordre 2 par défaut)
     float timeTooFar; //Temps depuis lequel on est trop loin
     bool close;  //Est ce qu'on est proche de la target (cf epsilon et depsilon)
     bool tooFar; //Est ce qu'on est trop loin (cf errMax)
     float lastOut;
+    float outLimit;   //Limite de l'ordre appliqué au dernier cycle (cf recordOutput), pour l'anti windup
     Score score;
 
+    float computeError(float xTarget, float x);
+    void monitor(float error, float dError, float dxTarget, float dt); //Met a jour close, tooFar et le score
+    float observe(float xTarget, float dxTarget, float x, float dx, float dt); //Filtre dx, monitor, renvoie l'erreur
+    void recordOutput(float out, float limit, float dt); //Score : inversions et saturation de l'ordre finalement appliqué
+
 public:
     Score getScore();
-    void reset();
-    void setCurrentProfile(MoveProfileName pace);
-    float compute(float xTarget, float dxTarget, float x, float dx, float dt); //Renvoie un ordre entre -1 et 1
+    void reset(bool resetIntegral = true); //Sans resetIntegral, l'integrateur est transféré au mouvement suivant
+    void setCurrentProfile(MoveProfileName pace); //Les gains passent progressivement de l'ancien au nouveau profil
+    Gains getGains(); //Gains courants (interpolés)
+    float compute(float xTarget, float dxTarget, float x, float dx, float dt, float feedforward = 0); //Renvoie un ordre entre -1 et 1 (feedforward est pondéré par KF)
+    //Boucle de position externe de la cascade : renvoie une consigne de vitesse dxTarget + kPosition*erreur
+    float computeSetpoint(float xTarget, float dxTarget, float x, float dx, float dt, float kPosition);
     MoveProfile* getCurrentProfile();
     PID(bool modulo360, float frequency);
     PID();
@@ -51,23 +84,51 @@ class Asservissement
     PID pidRotation;
     Cinetique *cGhost, *cRobot;
     float *outTranslation, *outRotation;
+    DynamicModel *model; //Modele dynamique du robot pour le feedforward (le meme que celui du Simulator)
+    Ghost *ghost;        //Pour les accelerations planifiées
+    MPCAxis mpcTranslation, mpcRotation;
+
+    void computeMPC(float dt); //Meme sorties que compute, pour les profils en MPC_LAW
+    void computeRamsete(float dt); //Meme sorties que compute, pour les profils en RAMSETE_LAW
 
 public:
     bool close;           // Est ce qu'on est proche a la fois en position (projetée) ET en theta
                           //Il faut regarder la position projetée car le PID ne pourra rien y faire si on est à coté
     bool tooFar;          //Est ce qu'on est trop loin position (absolue) OU en theta
     bool needToGoForward; //Est ce qu'on va devoir avancer ? Utile pour l'évitemment
+    float wheelTargetLeft, wheelTargetRight; //Consignes de vitesse roue (m/s) en mode cascade
 
     //Place dans outTranslation et outRotation les deux ordres (entre -1 et 1)
+    //Selon la loi du profil de translation courant (pour les deux axes) : PID, commande predictive ou Ramsete
     void compute(float dt);
+    //Boucle externe de la cascade : place dans wheelTargetLeft et wheelTargetRight les consignes de vitesse des roues
+    void computeCascade(float dt);
     //void compute_dev(float dt);
     void setCurrentProfile(MoveProfileName pace);
-    void reset();
+    void setBlendDuration(float duration);
+    void reset(bool resetIntegral = true);
     void sendScoreToTelemetry();
+    Score getScore(bool translation);
 
-    Asservissement(float *outTranslation, float *outRotation, Cinetique *cRobot, Cinetique *cGhost, float frequency);
+    Asservissement(float *outTranslation, float *outRotation, Cinetique *cRobot, Cinetique *cGhost, Ghost *ghost, DynamicModel *model, float frequency);
     Asservissement() {}
     float tweak(bool incr, bool translation, uint8_t whichOne);
 };
 
+/*
+* Boucle interne de vitesse d'une roue (PI + anticipation des frottements)
+* Assez legere pour tourner a 1kHz : 3 multiplications par appel
+*/
+class VelocityLoop
+{
+    float KP, KI, KV; //KV : ordre necessaire pour maintenir 1 m/s (frottements)
+    float iTerm;
+
+public:
+    float compute(float vTarget, float v, float dt); //Renvoie un ordre entre -1 et 1
+    void reset();
+    VelocityLoop(float KP, float KI, float KV);
+    VelocityLoop() {}
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,52 @@
+#include "ScoreHistory.h"
+#include "PID.h"
+
+static_assert(sizeof(ScoreRecord) == 48, "ScoreRecord is a binary format, it must not be padded");
+
+ScoreRecord ScoreHistory::records[SCORE_HISTORY_SIZE];
+uint16_t ScoreHistory::nbRecords = 0;
+
+void ScoreHistory::record(uint8_t sequence, uint8_t action, MoveProfileName profile, float duration, bool success, Score translation, Score rotation)
+{
+    ScoreRecord *out = &records[nbRecords % SCORE_HISTORY_SIZE];
+    Score scores[2] = {translation, rotation};
+    out->duration = duration;
+    for (int i = 0; i < 2; i++)
+    {
+        out->cumulError[i] = scores[i].cumulError;
+        out->peakError[i] = scores[i].peakError;
+        out->maxOvershoot[i] = scores[i].maxOvershoot;
+        out->saturationTime[i] = scores[i].saturationTime;
+        out->nbInversion[i] = scores[i].nbInversion;
+    }
+    out->moveIndex = nbRecords;
+    out->sequence = sequence;
+    out->action = action;
+    out->profile = (uint8_t)profile;
+    out->success = success;
+    out->reserved[0] = 0;
+    out->reserved[1] = 0;
+    nbRecords++;
+}
+
+uint8_t ScoreHistory::size()
+{
+    return min(nbRecords, (uint16_t)SCORE_HISTORY_SIZE);
+}
+
+ScoreRecord ScoreHistory::get(uint8_t index)
+{
+    uint16_t first = nbRecords - size();
+    return records[(first + index) % SCORE_HISTORY_SIZE];
+}
+
+void ScoreHistory::dump(Communication *communication)
+{
+    //Le buffer est envoyé tel quel : la station sol remet les records dans l'ordre grace a moveIndex
+    communication->dump(Score_History_M, (const uint8_t *)records, size() * sizeof(ScoreRecord));
+}
+
+void ScoreHistory::reset()
+{
+    nbRecords = 0;
+}
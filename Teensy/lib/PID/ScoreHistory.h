@@ -0,0 +1,49 @@
+#ifndef SCOREHISTORY_H_
+#define SCOREHISTORY_H_
+#include "Arduino.h"
+#include "MoveProfile.h"
+#include "Communication.h"
+
+#define SCORE_HISTORY_SIZE 64 //Nombre de mouvements gardés en RAM (les plus anciens sont écrasés)
+
+class Score;
+
+/*
+* Score d'un mouvement, format binaire du dump (little endian, 48 octets, pas de padding)
+* [0] translation, [1] rotation
+*/
+struct ScoreRecord
+{
+    float duration;          //Durée du mouvement (s)
+    float cumulError[2];     //Integrale de l'erreur absolue
+    float peakError[2];      //Erreur maximale
+    float maxOvershoot[2];
+    float saturationTime[2]; //Temps passé avec l'ordre saturé (s)
+    uint16_t nbInversion[2];
+    uint16_t moveIndex;      //Numero du mouvement depuis le demarrage (pour remettre le dump dans l'ordre)
+    uint8_t sequence;        //SequenceName, 0xFF si l'action n'est pas directement dans une sequence
+    uint8_t action;          //Indice de l'action dans la sequence
+    uint8_t profile;         //MoveProfileName
+    uint8_t success;
+    uint8_t reserved[2];
+};
+
+/*
+* Historique des scores des mouvements, pour les sessions de reglage
+* Rempli a la fin de chaque Move_Action, envoyé en une seule rafale binaire a la demande (Score_History_M)
+*/
+class ScoreHistory
+{
+public:
+    static void record(uint8_t sequence, uint8_t action, MoveProfileName profile, float duration, bool success, Score translation, Score rotation);
+    static uint8_t size();
+    static ScoreRecord get(uint8_t index); //0 : le plus ancien
+    static void dump(Communication *communication);
+    static void reset();
+
+private:
+    static ScoreRecord records[SCORE_HISTORY_SIZE];
+    static uint16_t nbRecords; //Nombre total de mouvements enregistrés depuis le reset
+};
+
+#endif // !SCOREHISTORY_H_
@@ -0,0 +1,117 @@
+#include "Profiler.h"
+#include "Logger.h"
+
+#ifdef PROFILING
+#ifdef TEENSY35
+#include <cstring>
+#else
+#include <string.h>
+#endif
+
+uint32_t Profiler::histograms[__NBZONES__][PROFILE_NB_BUCKETS];
+uint32_t Profiler::minTicks[__NBZONES__];
+uint32_t Profiler::maxTicks[__NBZONES__];
+
+static inline uint16_t bucketOf(uint32_t ticks)
+{
+    if (ticks < (1 << PROFILE_SUB_BITS))
+        return ticks;
+    uint8_t msb = 31 - __builtin_clz(ticks);
+    uint8_t sub = (ticks >> (msb - PROFILE_SUB_BITS)) & ((1 << PROFILE_SUB_BITS) - 1);
+    return ((msb - PROFILE_SUB_BITS + 1) << PROFILE_SUB_BITS) + sub;
+}
+
+static inline uint32_t bucketUpperBound(uint16_t bucket)
+{
+    if (bucket < (1 << PROFILE_SUB_BITS))
+        return bucket;
+    uint8_t group = bucket >> PROFILE_SUB_BITS;
+    uint32_t sub = bucket & ((1 << PROFILE_SUB_BITS) - 1);
+    return (((1 << PROFILE_SUB_BITS) + sub + 1) << (group - 1)) - 1;
+}
+
+void Profiler::setup()
+{
+#ifdef __arm__
+    ARM_DEMCR |= ARM_DEMCR_TRCENA;
+    ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+#endif
+    reset();
+}
+
+void Profiler::reset()
+{
+    memset(histograms, 0, sizeof(histograms));
+    for (int i = 0; i < __NBZONES__; i++)
+    {
+        minTicks[i] = UINT32_MAX;
+        maxTicks[i] = 0;
+    }
+}
+
+void Profiler::add(ProfileZone zone, uint32_t ticks)
+{
+    histograms[zone][bucketOf(ticks)]++;
+    minTicks[zone] = min(minTicks[zone], ticks);
+    maxTicks[zone] = max(maxTicks[zone], ticks);
+}
+
+uint32_t Profiler::percentile(ProfileZone zone, uint32_t count, float ratio)
+{
+    uint32_t rank = ceil(ratio * count);
+    uint32_t cumul = 0;
+    for (uint16_t i = 0; i < PROFILE_NB_BUCKETS; i++)
+    {
+        cumul += histograms[zone][i];
+        if (cumul >= rank && cumul > 0)
+            return min(bucketUpperBound(i), maxTicks[zone]);
+    }
+    return 0;
+}
+
+ProfileReport Profiler::report(ProfileZone zone)
+{
+    ProfileReport out;
+    out.count = 0;
+    for (uint16_t i = 0; i < PROFILE_NB_BUCKETS; i++)
+        out.count += histograms[zone][i];
+    out.min = (out.count > 0) ? minTicks[zone] : 0;
+    out.max = maxTicks[zone];
+    out.p50 = percentile(zone, out.count, 0.50);
+    out.p99 = percentile(zone, out.count, 0.99);
+    return out;
+}
+
+static uint32_t ticksPerSecond()
+{
+#ifdef __arm__
+    return F_CPU;
+#else
+    return 1000000000;
+#endif
+}
+
+void Profiler::dump(Communication *communication)
+{
+    ProfileDump out;
+    out.ticksPerSecond = ticksPerSecond();
+    for (int i = 0; i < __NBZONES__; i++)
+        out.zones[i] = report((ProfileZone)i);
+    communication->dump(Profile_M, (const uint8_t *)&out, sizeof(out));
+}
+
+void Profiler::print()
+{
+    const char *names[__NBZONES__] = {"range", "comm", "cinetique", "ghost", "controller", "sequences", "telemetry", "inner"};
+    float usPerTick = 1e6 / ticksPerSecond();
+    for (int i = 0; i < __NBZONES__; i++)
+    {
+        ProfileReport zone = report((ProfileZone)i);
+        if (zone.count == 0)
+            continue;
+        Logger::infoln(names[i], " : n ", zone.count, " min ", zone.min * usPerTick, " p50 ", zone.p50 * usPerTick,
+                       " p99 ", zone.p99 * usPerTick, " max ", zone.max * usPerTick, " us");
+    }
+}
+
+#endif // PROFILING
@@ -0,0 +1,98 @@
+/**   Ensmasteel Library - Profiling zones
+ * note : PROFILE_ZONE(zone) mesure la durée du bloc courant (jusqu'a l'accolade fermante) et la range dans l'histogramme de la zone.
+ *        Sur la teensy on compte les cycles (DWT CYCCNT, 1 tick = 1/F_CPU s), sur PC des nanosecondes (std::chrono).
+ *        Histogrammes a buckets fixes : 4 buckets par puissance de 2 (erreur < 25% sur les percentiles), pas d'allocation.
+ *        Sans -DPROFILING (env teensy35_profiling), les macros ne compilent rien.
+*/
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include "Arduino.h"
+#include "Communication.h"
+#ifndef __arm__
+#include <chrono>
+#endif
+
+#define PROFILE_SUB_BITS 2                                  //2^PROFILE_SUB_BITS buckets par puissance de 2
+#define PROFILE_NB_BUCKETS ((32 - PROFILE_SUB_BITS + 1) << PROFILE_SUB_BITS)
+
+enum ProfileZone
+{
+    ZONE_RANGE_SENSORS, //Lecture des trames de l'ESP
+    ZONE_COMMUNICATION, //communication.update + commActionneurs.update
+    ZONE_CINETIQUE,     //Update_Cinetique + estimator
+    ZONE_GHOST,         //ghost.ActuatePosition
+    ZONE_CONTROLLER,    //controller.compute (ou computeCascade) + ILC
+    ZONE_SEQUENCES,     //Sequence::update de toutes les sequences
+    ZONE_TELEMETRY,
+    ZONE_INNER,         //Robot::UpdateInner
+    __NBZONES__
+};
+
+/*
+* Resumé d'une zone, format binaire du dump (little endian, 20 octets). Durées en ticks.
+*/
+struct ProfileReport
+{
+    uint32_t count;
+    uint32_t min, max;
+    uint32_t p50, p99; //Borne haute du bucket du percentile
+};
+
+struct ProfileDump
+{
+    uint32_t ticksPerSecond;
+    ProfileReport zones[__NBZONES__];
+};
+
+class Profiler
+{
+public:
+    static inline uint32_t now()
+    {
+#ifdef __arm__
+        return ARM_DWT_CYCCNT;
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+    static void add(ProfileZone zone, uint32_t ticks);
+    static ProfileReport report(ProfileZone zone);
+    static void dump(Communication *communication); //Envoie un ProfileDump (Profile_M)
+    static void print();                            //Tableau lisible sur Logger::info (en us)
+    static void reset();
+    static void setup(); //Active le compteur de cycles
+
+private:
+    static uint32_t histograms[__NBZONES__][PROFILE_NB_BUCKETS];
+    static uint32_t minTicks[__NBZONES__], maxTicks[__NBZONES__];
+    static uint32_t percentile(ProfileZone zone, uint32_t count, float ratio);
+};
+
+class ProfileScope
+{
+public:
+    ProfileScope(ProfileZone zone)
+    {
+        this->zone = zone;
+        start = Profiler::now();
+    }
+    ~ProfileScope() { Profiler::add(zone, Profiler::now() - start); }
+
+private:
+    ProfileZone zone;
+    uint32_t start;
+};
+
+#ifdef PROFILING
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_ZONE(zone) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(zone)
+#define PROFILE_SETUP() Profiler::setup()
+#else
+#define PROFILE_ZONE(zone)
+#define PROFILE_SETUP()
+#endif
+
+#endif // !PROFILER_H_
@@ -3,6 +3,14 @@
 #include "Actions.h"
 #include "Functions.h"
 #include "Codeuse.h"
+#include "ScoreHistory.h"
+#include "Profiler.h"
+#include "Scheduler.h"
+#include "Wakeups.h"
+#ifdef PLANNER
+#include "Planner.h"
+#include "PlannerTasks.h"
+#endif
 
 #define PIN_CODEUSE_GAUCHE_A 29
 #define PIN_CODEUSE_GAUCHE_B 28
@@ -25,12 +33,26 @@
 #define DIAMETRE_ROUE_CODEUSE_GAUCHE 0.053570956
 #define TICKS_PER_ROUND 16384
 
-#define SKIP_TELEMETRY_LONG 10000
-#define SKIP_TELEMETRY_FAST 400000
+#define TASK_INNER_PERIOD 1000            // [...] = us, boucle de vitesse des roues (si cascaded)
+#define TASK_RANGE_PERIOD 10000
+#define TASK_COMM_PERIOD 10000
+#define COMM_SETTLE_ROUNDS 4              //Actions enchainées au plus par une sequence apres un message (UpdateCommunication)
+#define TASK_LIDAR_PERIOD 100000
+#define TASK_TELEMETRY_FAST_PERIOD 100000
+#define TASK_TELEMETRY_LONG_PERIOD 1000000
+
+//Reaction differée (ErrorManager::dispatch, dans UpdateSequences) : trace ou le robot a decroché
+static void pidFailReaction(void *robot, const ErrorEvent &event)
+{
+    Cinetique &where = ((Robot *)robot)->cinetiqueCurrent;
+    LOG_INFOLN("PID fail #", event.count, " at x ", where._x, " y ", where._y);
+    LOG_TELEMETRY("PIDFail", event.count);
+}
 
 Robot::Robot(float xIni, float yIni, float thetaIni, Stream *commPort, Stream *actuPort, Stream *espPort)
 {
     this->espPort = espPort;//=====================================
+    rangeSensors = RangeSensors(espPort);
 
     MoveProfiles::setup();
     cinetiqueCurrent = Cinetique(xIni, yIni, thetaIni);
@@ -43,15 +65,21 @@ Robot::Robot(float xIni, float yIni, float thetaIni, Stream *commPort, Stream *a
     pinMode(PIN_MOTEUR_GAUCHE_BRAKE, OUTPUT);
     digitalWrite(PIN_MOTEUR_GAUCHE_BRAKE, LOW); //Adaptation ancien driver
 
+    model = DynamicModel(ROBOT_SIZE, ROBOT_MASS, ROBOT_MAX_ACCELERATION, ROBOT_MAX_SPEED);
     ghost = Ghost(cinetiqueCurrent);
-    controller = Asservissement(&translationOrderPID, &rotationOrderPID, &cinetiqueCurrent, &cinetiqueNext, filterFrequency);
+    controller = Asservissement(&translationOrderPID, &rotationOrderPID, &cinetiqueCurrent, &cinetiqueNext, &ghost, &model, filterFrequency);
+    estimator = MotorEstimator(&model);
+    ilc = ILC(&translationOrderPID, &rotationOrderPID, &cinetiqueCurrent, &cinetiqueNext);
+    ilc.load();
+    velocityLeft = VelocityLoop(VELOCITY_KP, VELOCITY_KI, model.friction / model.maxMotorForce);
+    velocityRight = VelocityLoop(VELOCITY_KP, VELOCITY_KI, model.friction / model.maxMotorForce);
     communication = Communication(commPort);
     commActionneurs = Communication(actuPort);
 
-    sequences = new Sequence*[__NBSEQUENCES__]; //On définit un array de la bonne taille
     Action::setPointer(this);
+    Wakeups::setup();
     for (int i=0;i<__NBSEQUENCES__;i++)
-        sequences[i] = new Sequence(i);
+        sequences[i] = Sequence(i);
 
     //ATTENTION, LES ACTIONS DOIVENT ETRE DEFINIE EN TANT QUE ROBOT BLEU !
     // Might be define in main.cpp->setup
@@ -82,7 +110,7 @@ Robot::Robot(float xIni, float yIni, float thetaIni, Stream *commPort, Stream *a
     TargetVector manche2 = TargetVector(0.635,0.000,false);
 
     Sequence* mainSequence = getSequenceByName(mainSequenceName);
-        Serial.println("entree dans main");
+        LOG_DEBUGLN("entree dans main");
         //TODO config recalage etc
 
         //Attend le message Tirette
@@ -149,11 +177,19 @@ Robot::Robot(float xIni, float yIni, float thetaIni, Stream *commPort, Stream *a
         mainSequence->add(new Sleep_Action(1));
         mainSequence->add(new Send_Order_Action(PinceArr_M, Actuator_Order::Destock, (float)5.0, &commActionneurs, true));
         mainSequence->add(new Sleep_Action(1000));*/
+#ifdef PLANNER
+        //Taches choisies pendant le match (cf Planner.h), données de PlannerTasks.h
+        Planner::setup(standard);
+#define PLANNER_TASK(target, score, actuator, order, actuatorTime) Planner::addTask(#target, target, score, actuator, Actuator_Order::order, actuatorTime);
+        PLANNER_TASKS
+#undef PLANNER_TASK
+        Planner::build(mainSequence, VectorE(xIni, yIni, thetaIni), PLANNER_HOME, 10);
+#endif
         mainSequence->add(new End_Action(true,false));
-        Serial.println("avant StartSequence");
+        LOG_DEBUGLN("avant StartSequence");
         mainSequence->startSelected();
     
-    Serial.println("mainpass");
+    LOG_DEBUGLN("mainpass");
         //déclenchée par timeSequence
     Sequence* goNorth = getSequenceByName(goNorthName);
         goNorth->add(new StraightTo_Action(-1,northBase,standard));
@@ -186,6 +222,7 @@ Robot::Robot(float xIni, float yIni, float thetaIni, Stream *commPort, Stream *a
         timeSequence->add(new Do_Action(startBackHomeSeq));
         timeSequence->add(new Sleep_Action(10));
         timeSequence->add(new Do_Action(shutdown));
+        timeSequence->add(new Do_Action(saveILC)); //Ce qui a été appris pendant le match sert au suivant
         timeSequence->add(new End_Action());
         timeSequence->pause(false); //La time sequence ne doit s'écouler qu'a partir du tiré de la tirette !!
 
@@ -199,76 +236,63 @@ Robot::Robot(float xIni, float yIni, float thetaIni, Stream *commPort, Stream *a
         recallageListener->add(new End_Action(true,true,false));
         recallageListener->pause(false);
 
+    ErrorManager::setReaction(PID_FAIL_ERROR, pidFailReaction, this);
+    if (ProgramLoader::loadFromEEPROM()) //Strategie televersée : remplace la sequence compilée
+        installProgram();
     ghost.Lock(false);
 }
 
 void Robot::Update_Cinetique(float dt)
 {
     odometrie.updateCinetique(dt);
-    Serial.println("odometrie : ");
-    Serial.println(odometrie.codeuseDroite.ticks);
-    Serial.println(odometrie.codeuseGauche.ticks);
+    LOG_DEBUGLN("odometrie : ");
+    LOG_DEBUGLN(odometrie.codeuseDroite.ticks);
+    LOG_DEBUGLN(odometrie.codeuseGauche.ticks);
 }
 
-void Robot::Update(float dt)
-{   
-    
-    //================= communication with esp ==========
-    while(this->espPort->available()){
-        char c= this->espPort->read();
-        if ( c != '\n')
-        {
-            readString += c;
-        }
-        else
-        {
-            if(readString[0] == 'f'){
-                readString.remove(0);
-                rangeAdversaryFoward = readString.toInt();
-            }
-            else if (readString[0] == 'b')
-            {
-                readString.remove(0);
-                rangeAdversaryBackward = readString.toInt();
-            }
-            readString = "";
-        }
+void Robot::Read_Wheel_Speeds(float dt, float *vLeft, float *vRight)
+{
+    //Les codeuses sont sur des roues folles proches des roues motrices
+    *vLeft = odometrie.codeuseGauche.readSpeed(dt);
+    *vRight = odometrie.codeuseDroite.readSpeed(dt);
+}
+
+void Robot::UpdateInner(float dt)
+{
+    if (!cascaded)
+        return;
+    PROFILE_ZONE(ZONE_INNER);
+    float vLeft, vRight;
+    Read_Wheel_Speeds(dt, &vLeft, &vRight);
+    if (stopped)
+    {
+        velocityLeft.reset();
+        velocityRight.reset();
+        return;
     }
-    //================= communication with esp ==========
+    motorLeft.setOrder(velocityLeft.compute(controller.wheelTargetLeft, vLeft, dt));
+    motorRight.setOrder(velocityRight.compute(controller.wheelTargetRight, vRight, dt));
+    motorLeft.actuate();
+    motorRight.actuate();
+}
 
-    communication.update();
-    commActionneurs.update();
+void Robot::UpdateRangeSensors()
+{
+    PROFILE_ZONE(ZONE_RANGE_SENSORS);
+    rangeSensors.update();
+    rangeAdversaryFoward = rangeSensors.getRange(FORWARD_SECTOR);
+    rangeAdversaryBackward = rangeSensors.getRange(BACKWARD_SECTOR);
 
     if(rangeAdversaryFoward<200 || rangeAdversaryBackward<150){//no mater if the robot move fowar/backard, stop if an obstacle
         motorLeft.stop();
         motorRight.stop();
         stopped = true;
     }
-    else{
-        if(stopped){
-            //if the engines where stopped by an obstacle, resume movement
-            motorLeft.resume();
-            motorRight.resume();
-            stopped = false;
-        }
-        Update_Cinetique(dt);
-        ghost.ActuatePosition(dt);
-        cinetiqueNext = ghost.Get_Controller_Cinetique();
-        controller.compute(dt);
-
-        //================= recalage ==========
-        if (odometrie.getInterGaucheContact()) {
-            motorLeft.setOrder(translationOrderPID - rotationOrderPID);
-            motorLeft.actuate();
-        }
-        if (odometrie.getInterDroiteContact()) {
-            motorRight.setOrder(translationOrderPID + rotationOrderPID);
-            motorRight.actuate();
-        }
-        //================= recalage ==========
-
-        for (int i=0;i<__NBSEQUENCES__;i++)
-            sequences[i]->update();
+    else if(stopped){
+        //if the engines where stopped by an obstacle, resume movement
+        motorLeft.resume();
+        motorRight.resume();
+        stopped = false;
     }
 
     /*
@@ -279,30 +303,151 @@ void Robot::Update(float dt)
         motorRight.stop();
         stopped = true;
     }
-    else
+    */
+}
+
+void Robot::UpdateCommunication()
+{
+    PROFILE_ZONE(ZONE_COMMUNICATION);
+    communication.update();
+    commActionneurs.update();
+    //Tous les messages reçus sont consommés ici, au rythme de la communication : la boite de reception ne se remplit pas
+    //entre deux tours des sequences et une demande de dump n'est servie qu'une fois
+    uint8_t touched = 0; //Sequences qui ont lu un message
+    while (communication.inWaitingRx() > 0)
     {
-        the code
+        Message message = communication.peekOldestMessage();
+        MessageID id = extractID(message);
+        if (ProgramLoader::handles(message))
+        {
+            if (ProgramLoader::receive(message, &communication))
+                installProgram();
+        }
+        else if (id == Score_History_M)
+            ScoreHistory::dump(&communication);
+#ifdef PROFILING
+        else if (id == Profile_M)
+            Profiler::dump(&communication);
+#endif
+        else
+            touched |= deliverMessage(id);
+        communication.popOldestMessage();
     }
-    */
-    
-    if (compteur==SKIP_TELEMETRY_LONG){
-        telemetry(false,true);
-        compteur=0;
-    } else if (compteur%SKIP_TELEMETRY_FAST==0){
-        telemetry(true,false);
+    while (commActionneurs.inWaitingRx() > 0)
+    {
+        touched |= deliverMessage(extractID(commActionneurs.peekOldestMessage()));
+        commActionneurs.popOldestMessage();
     }
 
-    if (communication.inWaitingRx() > 0)
-        communication.popOldestMessage(); //Tout le monde a eu l'occasion de le peek, on le vire.
-    if (commActionneurs.inWaitingRx() > 0)
-        commActionneurs.popOldestMessage(); //Tout le monde a eu l'occasion de le peek, on le vire.
-    if (ErrorManager::inWaiting() > 0)
-        ErrorManager::popOldestError(); //Les séquences ont eu l'occasion de le lire, on le vire
-    compteur++;
+    //Boites vides : ces sequences enchainent leurs actions (fin du Switch, End qui reboucle...) pour ne pas rater le prochain message
+    for (int round = 0; round < COMM_SETTLE_ROUNDS && touched != 0 && !stopped; round++)
+    {
+        touched = Wakeups::take(touched);
+        for (int i = 0; i < __NBSEQUENCES__; i++)
+            if (touched & (1 << i))
+                sequences[i].update();
+    }
+}
+
+uint8_t Robot::deliverMessage(MessageID id)
+{
+    uint8_t awake = Wakeups::deliver(id);
+    if (stopped) //Comme avant : le message est perdu pour les sequences tant que le robot est arreté
+        return 0;
+    for (int i = 0; i < __NBSEQUENCES__; i++)
+        if (awake & (1 << i))
+            sequences[i].update(); //Le message est encore le plus ancien de son port (peek)
+    return awake;
+}
+
+void Robot::UpdateOdometry(float dt)
+{
+    if (stopped)
+        return;
+    PROFILE_ZONE(ZONE_CINETIQUE);
+    Update_Cinetique(dt);
+    estimator.update(motorLeft.order, motorRight.order, cinetiqueCurrent, dt);
+}
+
+void Robot::UpdateControl(float dt)
+{
+    if (stopped)
+        return;
+    {
+        PROFILE_ZONE(ZONE_GHOST);
+        ghost.ActuatePosition(dt);
+        cinetiqueNext = ghost.Get_Controller_Cinetique();
+    }
+    {
+        PROFILE_ZONE(ZONE_CONTROLLER);
+        if (cascaded)
+            controller.computeCascade(dt);
+        else
+        {
+            controller.compute(dt);
+            ilc.apply(dt);
+        }
+    }
+
+    //================= recalage ==========
+    //En cascade, computeCascade n'ecrit pas translationOrderPID/rotationOrderPID : les roues en contact restent
+    //pilotées par UpdateInner (consignes de vitesse wheelTargetLeft/Right), on n'y superpose pas un ordre perimé
+    if (cascaded)
+        return;
+    if (odometrie.getInterGaucheContact()) {
+        motorLeft.setOrder(estimator.compensateOrder(translationOrderPID - rotationOrderPID, false, cinetiqueCurrent._v - cinetiqueCurrent._w * model.size / 2));
+        motorLeft.actuate();
+    }
+    if (odometrie.getInterDroiteContact()) {
+        motorRight.setOrder(estimator.compensateOrder(translationOrderPID + rotationOrderPID, true, cinetiqueCurrent._v + cinetiqueCurrent._w * model.size / 2));
+        motorRight.actuate();
+    }
+    //================= recalage ==========
+}
+
+void Robot::UpdateSequences()
+{
+    PROFILE_ZONE(ZONE_SEQUENCES);
+    //Evenements du tour : seules les sequences dont l'action attend l'un d'eux sont evaluées (cf Wakeups.h)
+    //Les messages sont routés par UpdateCommunication (deliverMessage)
+    Wakeups::collect(Clock::micros(), (ghost.trajectoryIsFinished() ? WAKE_GHOST_FINISHED : 0) | (controller.close ? WAKE_CONTROLLER_CLOSE : 0));
+    if (!stopped) //Sinon les reveils attendent le redemarrage
+        for (int8_t i = Wakeups::next(); i >= 0; i = Wakeups::next())
+            sequences[i].update();
+    ErrorManager::dispatch(); //Reactions differées aux erreurs (les Wait_Error_Action lisent le bus elles-memes)
+}
+
+//Taches du Scheduler (le contexte est le Robot)
+static void innerTask(void *robot, float dt) { ((Robot *)robot)->UpdateInner(dt); }
+static void odometryTask(void *robot, float dt) { ((Robot *)robot)->UpdateOdometry(dt); }
+static void controlTask(void *robot, float dt) { ((Robot *)robot)->UpdateControl(dt); }
+static void rangeSensorsTask(void *robot, float) { ((Robot *)robot)->UpdateRangeSensors(); }
+static void communicationTask(void *robot, float) { ((Robot *)robot)->UpdateCommunication(); }
+static void sequencesTask(void *robot, float) { ((Robot *)robot)->UpdateSequences(); }
+static void telemetryFastTask(void *robot, float) { ((Robot *)robot)->telemetry(true, false); }
+static void telemetryLongTask(void *robot, float) { ((Robot *)robot)->telemetry(false, true); }
+
+void Robot::registerTasks(uint32_t controlPeriod)
+{
+    //                                                 periode (us)         budget (us)  priorité
+    Scheduler::add("inner", innerTask, this,          TASK_INNER_PERIOD,     100,         0);
+    Scheduler::add("odometry", odometryTask, this,    controlPeriod,         300,         1);
+    Scheduler::add("control", controlTask, this,      controlPeriod,         500,         2);
+    Scheduler::add("range", rangeSensorsTask, this,   TASK_RANGE_PERIOD,     100,         3); //Arret d'urgence : jamais sautée
+    Scheduler::add("comm", communicationTask, this,   TASK_COMM_PERIOD,      200,         4);
+    Scheduler::add("sequences", sequencesTask, this,  controlPeriod,         500,         5);
+    //LIDAR : priorité 6, TASK_LIDAR_PERIOD, quand le Robot aura son LIDAR
+    Scheduler::add("telemFast", telemetryFastTask, this, TASK_TELEMETRY_FAST_PERIOD, 500, 7);
+    Scheduler::add("telemLong", telemetryLongTask, this, TASK_TELEMETRY_LONG_PERIOD, 1000, 8);
+#ifdef PLANNER
+    //Temps libre avant la prochaine tache : recherche du Planner, jamais plus de PLANNER_SLICE_BUDGET
+    Scheduler::setIdle(Planner::slice, nullptr, PLANNER_SLICE_BUDGET);
+#endif
 }
 
 void Robot::telemetry(bool odometrie, bool other)
 {
+    PROFILE_ZONE(ZONE_TELEMETRY);
     if (odometrie)
     {
         cinetiqueCurrent.toTelemetry("R");
@@ -310,19 +455,51 @@ void Robot::telemetry(bool odometrie, bool other)
     }
     if (other)
     {
-        Logger::toTelemetry("pid", String(controller.close));
-        Logger::toTelemetry("ghost", String(ghost.trajectoryIsFinished()));
+        LOG_TELEMETRY("pid", controller.close);
+        LOG_TELEMETRY("ghost", ghost.trajectoryIsFinished());
         getSequenceByName(mainSequenceName)->toTelemetry();
         communication.toTelemetry();
     }
 }
 
+void Robot::memoryReport()
+{
+    static_assert(sizeof(Robot) <= RAM_BUDGET_ROBOT, "Robot over RAM_BUDGET_ROBOT");
+    static_assert(sizeof(sequences) <= RAM_BUDGET_SEQUENCES, "Sequences over RAM_BUDGET_SEQUENCES");
+    static_assert(sizeof(communication) + sizeof(commActionneurs) <= RAM_BUDGET_COMMUNICATION, "Communication over RAM_BUDGET_COMMUNICATION");
+    static_assert(sizeof(ghost) + sizeof(controller) + sizeof(estimator) + sizeof(model) <= RAM_BUDGET_CONTROL, "Control over RAM_BUDGET_CONTROL");
+    static_assert(sizeof(ilc) <= RAM_BUDGET_ILC, "ILC over RAM_BUDGET_ILC");
+    static_assert(sizeof(odometrie) <= RAM_BUDGET_ODOMETRY, "Odometrie over RAM_BUDGET_ODOMETRY");
+    static_assert(sizeof(rangeSensors) <= RAM_BUDGET_RANGE_SENSORS, "RangeSensors over RAM_BUDGET_RANGE_SENSORS");
+
+    LOG_INFOLN("RAM robot ", sizeof(Robot), "/", RAM_BUDGET_ROBOT);
+    LOG_INFOLN("RAM sequences ", sizeof(sequences), "/", RAM_BUDGET_SEQUENCES);
+    LOG_INFOLN("RAM communication ", sizeof(communication) + sizeof(commActionneurs), "/", RAM_BUDGET_COMMUNICATION);
+    LOG_INFOLN("RAM control ", sizeof(ghost) + sizeof(controller) + sizeof(estimator) + sizeof(model), "/", RAM_BUDGET_CONTROL);
+    LOG_INFOLN("RAM ilc ", sizeof(ilc), "/", RAM_BUDGET_ILC);
+    LOG_INFOLN("RAM odometrie ", sizeof(odometrie), "/", RAM_BUDGET_ODOMETRY);
+    LOG_INFOLN("RAM range ", sizeof(rangeSensors), "/", RAM_BUDGET_RANGE_SENSORS);
+    LOG_INFOLN("RAM actions ", Action::arenaUsed(), "/", ACTION_ARENA_SIZE, " overflows ", Action::arenaOverflows());
+}
+
 Sequence* Robot::getSequenceByName(SequenceName name){
-    return sequences[(int)name];
+    return &sequences[(int)name];
+}
+
+void Robot::installProgram()
+{
+    for (int i = 0; i < __NBSEQUENCES__; i++)
+        if (sequences[i].getProgram() == &program && i != ProgramLoader::sequence())
+        {
+            sequences[i].run(nullptr); //L'ancien programme tournait ailleurs : sa sequence s'arrete
+            sequences[i].pause(false);
+        }
+    if (program.load(ProgramLoader::code(), ProgramLoader::size()) == PROGRAM_OK)
+        getSequenceByName(ProgramLoader::sequence())->run(&program);
 }
 
 float Robot::getTime(){
-    return millis()/1e3 - timeStarted;
+    return Clock::secondsSince(timeStarted);
 }
 
 void Robot::setTeamColor(TeamColor teamColor){
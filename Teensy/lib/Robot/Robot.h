@@ -6,10 +6,31 @@
 #include "Moteur.h"
 #include "PID.h"
 #include "Ghost.h"
+#include "DynamicModel.h"
+#include "ILC.h"
+#include "Estimator.h"
 #include "Communication.h"
+#include "Clock.h"
+#include "RangeSensors.h"
 #include "Sequence.h"
 #include "SequenceName.h"
-#include <vector>
+#include "Program.h"
+
+//Modele dynamique du robot (cf DynamicModel), partagé avec les outils hors ligne (mainTuner, mainStrategy, mainBench)
+#define ROBOT_SIZE 0.30
+#define ROBOT_MASS 9.0
+#define ROBOT_MAX_ACCELERATION 6.5
+#define ROBOT_MAX_SPEED 1.5
+
+//Budget RAM par sous-systeme (octets), verifié a la compilation dans Robot.cpp et affiché au boot par memoryReport
+//Tout est statique ou membre du Robot (lui meme dans .bss, cf main.cpp) : aucun malloc apres setup
+#define RAM_BUDGET_ROBOT 12288         //sizeof(Robot), tout compris
+#define RAM_BUDGET_SEQUENCES 3072      //Files de pointeurs des __NBSEQUENCES__ sequences (les actions sont dans l'arene, cf ACTION_ARENA_SIZE)
+#define RAM_BUDGET_COMMUNICATION 512   //communication + commActionneurs (MessageBox comprises)
+#define RAM_BUDGET_CONTROL 4096        //ghost + controller + estimator + model
+#define RAM_BUDGET_ILC 3072
+#define RAM_BUDGET_ODOMETRY 512
+#define RAM_BUDGET_RANGE_SENSORS 320
 
 class Robot
 {
@@ -19,32 +40,38 @@ protected:
     Cinetique cinetiqueNext;
     Motor motorLeft, motorRight;
     float translationOrderPID = 0.0, rotationOrderPID = 0.0;
-    uint8_t compteur=0;
     virtual void Update_Cinetique(float dt);
-    Sequence** sequences;
+    virtual void Read_Wheel_Speeds(float dt, float *vLeft, float *vRight); //Vitesses des roues pour la boucle interne
+    VelocityLoop velocityLeft, velocityRight;
+    Sequence sequences[__NBSEQUENCES__];
     TeamColor teamColor = BLEU;
 
 public :
     //=== Globals ===
     bool endNorth = true;
-    float timeStarted;
+    uint64_t timeStarted = 0; // [...] = us (Clock), debut du match
     float backLength = 0.15; //Longueur entre le contact arrière du robot et son CG
     float frontLength = 0.15; //Longueur entre le contact avant du robot et son CG
     float length = backLength + frontLength; //Longueur du robot
 
     Stream *espPort;
-    int rangeAdversaryFoward = -1;
-    int rangeAdversaryBackward = -1;
-    String readString;
+    RangeSensors rangeSensors; //Capteurs de distance (trames binaires de l'ESP32, cf RangeSensors.h)
+    int rangeAdversaryFoward = RANGE_NO_DATA;
+    int rangeAdversaryBackward = RANGE_NO_DATA;
     bool stopped = false;
+    bool cascaded = false; //Asservissement en cascade : position a la frequence de la tache control, vitesse des roues dans UpdateInner
     //===============
 
     //=== Composants ===
     Cinetique cinetiqueCurrent;
+    DynamicModel model; //Masse, inertie et frottements (partagé par le controller et le Simulator)
     Ghost ghost;
     Asservissement controller;
+    MotorEstimator estimator; //Gain et frottements de chaque moteur identifiés en ligne
+    ILC ilc;             //Correction apprise des trajectoires répétées (ajoutée aux ordres du controller)
     Communication communication;
     Communication commActionneurs;
+    Program program;     //Interpreteur du programme televersé (cf Program.h), executé par une des sequences
     //==================
     
     // GOAL / Constructor : Setup all reference to variables of other classes
@@ -53,15 +80,23 @@ public :
     //        Stream* commPort : pointer to current serial port (bluetooth or USB)
     Robot(float xIni = 0.0, float yIni = 0.0, float thetaIni = 0.0, Stream *commPort = &Serial, Stream *actuPort = &Serial,Stream *espPort = &Serial4);
     
-    // GOAL / Update informations about real position, Ghost's position, compute output and send order to motors
+    // GOAL / Register the stages of the loop (UpdateInner, odometry, control, telemetry...) as Scheduler tasks with their own periods and priorities
+    // IN   / uint32_t controlPeriod : us, period of odometry, control and sequences
+    void registerTasks(uint32_t controlPeriod);
+
+    void UpdateRangeSensors();        //Trames de l'ESP + arret si obstacle
+    void UpdateCommunication();       //Reception / emission, chaque message reçu est consommé (loader, dumps, sequences abonnées)
+    void UpdateOdometry(float dt);    //cinetiqueCurrent + estimation des moteurs
+    void UpdateControl(float dt);     //Ghost + Asservissement
+    void UpdateSequences();           //Sequences reveillées (cf Wakeups.h), puis suppression des erreurs lues
+    uint8_t deliverMessage(MessageID id); //Met a jour tout de suite les sequences qui attendent ce message (Wakeups::deliver), renvoie lesquelles
+
+    // GOAL / Inner wheel velocity loop of the cascaded controller (does nothing if !cascaded)
+    //        Cheap enough to be called at 1kHz
     // IN   / float dt : time since last call
-    //        odometrie
-    //        ghost
-    //        cinetiqueNext
-    //        cinetiqueCurrent
-    //        controller
+    //        controller.wheelTargetLeft, controller.wheelTargetRight
     // OUT  / Motor motorLeft, motorRight : orders send
-    void Update(float dt);
+    void UpdateInner(float dt);
 
     // GOAL / Send current robot state on telemtry serial
     // IN   / cinetiqueCurrent
@@ -73,6 +108,9 @@ public :
 
     Sequence* getSequenceByName(SequenceName name);
 
+    // GOAL / Run the program of ProgramLoader (just uploaded or read from EEPROM) in its sequence, instead of its actions
+    void installProgram();
+
     float getTime();
 
     void setTeamColor(TeamColor teamColor);
@@ -84,6 +122,9 @@ public :
 
     // GOAL / Teleport Ghost on Robot's position
     void recalibrateGhost();
+
+    // GOAL / Print the RAM used by each subsystem against its budget (RAM_BUDGET_*), and the use of the action arena
+    void memoryReport();
 };
 
 #endif
\ No newline at end of file
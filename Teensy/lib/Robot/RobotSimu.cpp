@@ -1,10 +1,17 @@
 #include "RobotSimu.h"
 
 RobotSimu::RobotSimu(float xIni ,float yIni ,float thetaIni, Stream* commPortStream, Stream* actuPort) : Robot(xIni,yIni,thetaIni,commPortStream,actuPort){
-    simu = Simulator(0.30, 9.0, 6.5, 1.5, &cinetiqueCurrent, &motorLeft.order, &motorRight.order);
-    Logger::infoln("SIMULATOR MODE");
+    simu = Simulator(model, &cinetiqueCurrent, &motorLeft.order, &motorRight.order);
+    LOG_INFOLN("SIMULATOR MODE");
 }
 
 void RobotSimu::Update_Cinetique(float dt){
+    if (!cascaded)
+        simu.updateCinetique(dt);
+}
+
+void RobotSimu::Read_Wheel_Speeds(float dt, float *vLeft, float *vRight){
     simu.updateCinetique(dt);
+    *vLeft = cinetiqueCurrent._v - cinetiqueCurrent._w * model.size / 2;
+    *vRight = cinetiqueCurrent._v + cinetiqueCurrent._w * model.size / 2;
 }
\ No newline at end of file
@@ -8,6 +8,7 @@ class RobotSimu : public Robot
 private:
     Simulator simu;
     void Update_Cinetique(float dt) override;
+    void Read_Wheel_Speeds(float dt, float *vLeft, float *vRight) override; //En cascade, la simulation avance au rythme de la boucle interne
 
 public:
     RobotSimu(float xIni=0.0,float yIni=0.0,float thetaIni=0.0, Stream* commPortStream = &Serial, Stream *actuPort = &Serial);
@@ -0,0 +1,148 @@
+#include "Scheduler.h"
+#include "Logger.h"
+
+Task Scheduler::tasks[SCHEDULER_MAX_TASKS];
+uint8_t Scheduler::nbTasks = 0;
+uint8_t Scheduler::order[SCHEDULER_MAX_TASKS];
+IdleFunction Scheduler::idleFunction = nullptr;
+void *Scheduler::idleContext = nullptr;
+uint32_t Scheduler::idleBudget = 0;
+uint32_t Scheduler::idleRuns = 0;
+uint32_t Scheduler::idleOverruns = 0;
+uint32_t Scheduler::idleMaxExecution = 0;
+
+int8_t Scheduler::add(const char *name, TaskFunction function, void *context, uint32_t period, uint32_t budget, uint8_t priority)
+{
+    if (nbTasks >= SCHEDULER_MAX_TASKS)
+    {
+        LOG_INFOLN("Scheduler full, task ", name, " ignored");
+        return -1;
+    }
+    Task *task = &tasks[nbTasks];
+    task->name = name;
+    task->function = function;
+    task->context = context;
+    task->period = max(period, (uint32_t)1);
+    task->budget = budget;
+    task->priority = priority;
+    task->nextRelease = Clock::micros();
+    task->lastRun = task->nextRelease;
+
+    //Insertion triée par priorité (a priorité egale : ordre d'enregistrement)
+    uint8_t i = nbTasks;
+    while (i > 0 && tasks[order[i - 1]].priority > priority)
+    {
+        order[i] = order[i - 1];
+        i--;
+    }
+    order[i] = nbTasks;
+    nbTasks++;
+    resetStats();
+    return nbTasks - 1;
+}
+
+uint8_t Scheduler::run()
+{
+    uint64_t frameStart = Clock::micros();
+    uint8_t executed = 0;
+    for (uint8_t k = 0; k < nbTasks; k++)
+    {
+        Task *task = &tasks[order[k]];
+        uint64_t now = Clock::micros();
+        if (now < task->nextRelease)
+            continue;
+
+        if (task->priority >= SCHEDULER_SHED_PRIORITY && now - frameStart > SCHEDULER_FRAME)
+        {
+            task->sheds++; //Reportée au prochain tour (toujours prete) : si elle est reportée toute une periode, c'est un deadline miss
+            continue;
+        }
+
+        if (now - task->nextRelease >= task->period)
+        {
+            task->deadlineMisses++;
+            task->nextRelease = now + task->period; //On se recale plutot que d'enchainer les executions en retard
+        }
+        else
+            task->nextRelease += task->period; //Sans derive
+
+        task->function(task->context, (now - task->lastRun) / (float)CLOCK_US_PER_S);
+        task->lastRun = now;
+        uint32_t execution = Clock::micros() - now;
+        task->maxExecution = max(task->maxExecution, execution);
+        if (execution > task->budget)
+            task->overruns++;
+        task->runs++;
+        executed++;
+    }
+
+    //Temps libre jusqu'au prochain reveil : tranche de la fonction de fond
+    if (idleFunction != nullptr && nbTasks > 0)
+    {
+        uint64_t now = Clock::micros();
+        uint64_t nextRelease = tasks[0].nextRelease;
+        for (uint8_t i = 1; i < nbTasks; i++)
+            nextRelease = min(nextRelease, tasks[i].nextRelease);
+        if (nextRelease > now + SCHEDULER_IDLE_GUARD + SCHEDULER_IDLE_MIN)
+        {
+            uint32_t slice = min((uint64_t)idleBudget, nextRelease - now - SCHEDULER_IDLE_GUARD);
+            idleFunction(idleContext, slice);
+            uint32_t execution = Clock::micros() - now;
+            idleMaxExecution = max(idleMaxExecution, execution);
+            if (execution > slice)
+                idleOverruns++;
+            idleRuns++;
+        }
+    }
+    return executed;
+}
+
+void Scheduler::setIdle(IdleFunction function, void *context, uint32_t budget)
+{
+    idleFunction = function;
+    idleContext = context;
+    idleBudget = budget;
+}
+
+void Scheduler::setPeriod(int8_t task, uint32_t period)
+{
+    if (task >= 0 && task < nbTasks)
+        tasks[task].period = max(period, (uint32_t)1);
+}
+
+const Task &Scheduler::get(int8_t task)
+{
+    return tasks[constrain(task, 0, SCHEDULER_MAX_TASKS - 1)];
+}
+
+uint8_t Scheduler::size()
+{
+    return nbTasks;
+}
+
+void Scheduler::resetStats()
+{
+    for (uint8_t i = 0; i < nbTasks; i++)
+    {
+        tasks[i].runs = 0;
+        tasks[i].deadlineMisses = 0;
+        tasks[i].overruns = 0;
+        tasks[i].sheds = 0;
+        tasks[i].maxExecution = 0;
+    }
+    idleRuns = 0;
+    idleOverruns = 0;
+    idleMaxExecution = 0;
+}
+
+void Scheduler::print()
+{
+    for (uint8_t k = 0; k < nbTasks; k++)
+    {
+        const Task &task = tasks[order[k]];
+        Logger::infoln(task.name, " : runs ", task.runs, " misses ", task.deadlineMisses, " overruns ", task.overruns,
+                       " sheds ", task.sheds, " max ", task.maxExecution, "us");
+    }
+    if (idleFunction != nullptr)
+        Logger::infoln("idle : runs ", idleRuns, " overruns ", idleOverruns, " max ", idleMaxExecution, "us / ", idleBudget, "us");
+}
@@ -0,0 +1,83 @@
+/**   Ensmasteel Library - Cooperative task scheduler
+ * note : Table statique de taches periodiques (pas d'allocation), chacune avec sa periode, sa priorité et son budget de temps.
+ *        Scheduler::run est appelé en boucle par loop() : les taches dont la date de reveil est passée sont executées
+ *        par priorité croissante (0 = la plus prioritaire, rate monotonic : periode courte => priorité haute).
+ *        Une tache qui demarre plus d'une periode en retard compte un deadline miss et se recale (pas de rattrapage en rafale).
+ *        Quand un tour depasse SCHEDULER_FRAME, les taches de priorité >= SCHEDULER_SHED_PRIORITY encore pretes sont reportées
+ *        (shed) au tour suivant : la boucle de controle reste a l'heure, les taches non critiques prennent du retard.
+ *        Le temps qui reste avant le prochain reveil est donné a une fonction de fond (setIdle, planificateur...) :
+ *        elle recoit un budget strict (jamais plus que ce qui reste avant le reveil suivant, moins SCHEDULER_IDLE_GUARD)
+ *        et doit rendre la main avant, les taches ne sont donc jamais retardées.
+ *        Le temps vient de Clock (simulable avec une VirtualClock).
+*/
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include "Arduino.h"
+#include "Clock.h"
+
+#define SCHEDULER_MAX_TASKS 12
+#define SCHEDULER_FRAME 1000         // [...] = us, duree maximale d'un tour avant de sauter les taches non critiques
+#define SCHEDULER_SHED_PRIORITY 6    //Taches de priorité >= (LIDAR, telemetrie) : peuvent etre reportées
+#define SCHEDULER_IDLE_GUARD 50      // [...] = us, marge laissée avant le prochain reveil
+#define SCHEDULER_IDLE_MIN 20        // [...] = us, pas de tranche de fond plus courte
+
+typedef void (*TaskFunction)(void *context, float dt); //dt : temps reel depuis la derniere execution (s)
+typedef void (*IdleFunction)(void *context, uint32_t budget); //budget : us, a ne pas depasser
+
+struct Task
+{
+    const char *name;
+    TaskFunction function;
+    void *context;
+    uint32_t period;   // [...] = us
+    uint32_t budget;   // [...] = us, temps d'execution prevu
+    uint8_t priority;
+    uint64_t nextRelease;
+    uint64_t lastRun;
+    //Statistiques
+    uint32_t runs;
+    uint32_t deadlineMisses; //Demarrée plus d'une periode en retard
+    uint32_t overruns;       //Execution plus longue que le budget
+    uint32_t sheds;          //Reportée parce que le tour avait deja depassé SCHEDULER_FRAME
+    uint32_t maxExecution;   // [...] = us
+};
+
+class Scheduler
+{
+public:
+    // GOAL / Register a periodic task (to be called before the first run)
+    // IN   / const char *name : static string
+    //        TaskFunction function, void *context : called as function(context, dt)
+    //        uint32_t period, budget : us
+    //        uint8_t priority : 0 is the highest
+    // OUT  / int8_t : index of the task, -1 if the table is full
+    static int8_t add(const char *name, TaskFunction function, void *context, uint32_t period, uint32_t budget, uint8_t priority);
+
+    // GOAL / Run the tasks which are due, by priority. Non blocking : returns immediately if nothing is due
+    // OUT  / uint8_t : number of tasks executed
+    static uint8_t run();
+
+    // GOAL / Background function run in the spare time of run (only one, nullptr to remove it)
+    // IN   / uint32_t budget : us, longest slice given to the function
+    static void setIdle(IdleFunction function, void *context, uint32_t budget);
+
+    static void setPeriod(int8_t task, uint32_t period);
+    static const Task &get(int8_t task);
+    static uint8_t size();
+    static void resetStats();
+    static void print(); //Statistiques des taches sur Logger::info
+
+private:
+    static Task tasks[SCHEDULER_MAX_TASKS];
+    static uint8_t nbTasks;
+    static uint8_t order[SCHEDULER_MAX_TASKS]; //Indices des taches triés par priorité
+
+    static IdleFunction idleFunction;
+    static void *idleContext;
+    static uint32_t idleBudget;
+    static uint32_t idleRuns, idleOverruns, idleMaxExecution; //Statistiques de la fonction de fond
+};
+
+#endif // !SCHEDULER_H_
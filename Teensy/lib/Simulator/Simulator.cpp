@@ -2,12 +2,11 @@
 #define MAX_PERCENT_DEFECT 50
 
 Simulator::Simulator(float size, float mass, float maxAcceleration, float maxSpeed
-            , Cinetique * cinetique, float * orderMotorLeft, float * orderMotorRight, float health) {
-    this->size=size;
-    this->mass=mass;
-    this->maxMotorForce=maxAcceleration*mass;
-    this->J=mass*size*size/6.0;
-    this->friction=maxMotorForce/maxSpeed;
+            , Cinetique * cinetique, float * orderMotorLeft, float * orderMotorRight, float health)
+    : Simulator(DynamicModel(size, mass, maxAcceleration, maxSpeed), cinetique, orderMotorLeft, orderMotorRight, health) {}
+
+Simulator::Simulator(DynamicModel model, Cinetique * cinetique, float * orderMotorLeft, float * orderMotorRight, float health) {
+    this->model=model;
     this->health=health;
     this->cinetique=cinetique;
     this->orderMotorLeft=orderMotorLeft;
@@ -35,9 +34,11 @@ bool outOfBound(Vector v, Vector* out){ //Dit si le vector est out of bound et d
         out->_x=0;out->_y=2.0 - v._y;
         return true;
     }
+    return false;
 }
 
 void Simulator::computeCollision(){
+    float size=model.size;
     Vector coins[4];
     coins[AVG] = (Vector)*cinetique + Vector(-size/2.0,size/2.0).rotate(cinetique->_theta);
     coins[AVD] = (Vector)*cinetique + Vector(size/2.0,size/2.0).rotate(cinetique->_theta);
@@ -56,19 +57,21 @@ void Simulator::computeCollision(){
 }
 
 void Simulator::updateCinetique( float dt) {
+    float size=model.size;
     float vLeft,vRight;
     vLeft=cinetique->_v - cinetique->_w*size/2;
     vRight=cinetique->_v + cinetique->_w*size/2;
     
     float forceLeft,forceRight;
-    forceLeft=(*orderMotorLeft)*maxMotorForce - friction*(1 + (1-health)*random(-MAX_PERCENT_DEFECT,MAX_PERCENT_DEFECT)/100)*vLeft;
-    forceRight=(*orderMotorRight)*maxMotorForce - friction*(1 + (1-health)*random(-MAX_PERCENT_DEFECT,MAX_PERCENT_DEFECT)/100)*vRight;
+    //Un moteur usé (health<1) donne moins de force et subit des frottements bruités
+    forceLeft=(*orderMotorLeft)*model.maxMotorForce*health - model.friction*(1 + (1-health)*random(-MAX_PERCENT_DEFECT,MAX_PERCENT_DEFECT)/100.0)*vLeft;
+    forceRight=(*orderMotorRight)*model.maxMotorForce*health - model.friction*(1 + (1-health)*random(-MAX_PERCENT_DEFECT,MAX_PERCENT_DEFECT)/100.0)*vRight;
 
     float force = (forceLeft + forceRight);
     float moment = (forceRight-forceLeft)*size/2;
 
-    cinetique->_v+=force*dt/mass;
-    cinetique->_w+=moment*dt/J;
+    cinetique->_v+=force*dt/model.mass;
+    cinetique->_w+=moment*dt/model.J;
 
     cinetique->_theta+=cinetique->_w*dt;
     (*cinetique)+=directeur(cinetique->_theta)*cinetique->_v*dt;
@@ -1,14 +1,11 @@
 #ifndef SIMULATOR_H_
 #define SIMULATOR_H_
 #include "Vector.h"
+#include "DynamicModel.h"
 
 class Simulator
 {
-    float mass; //Mass
-    float J;    //Rotational Inertie
-    float maxMotorForce;    //Newton
-    float size; //Size of one side of the robot, considering its template is a square. We also consider that the motors are at the extremity
-    float friction;  //friction  frictionForce=friction*(-V)
+    DynamicModel model; //mass, J, maxMotorForce, size, friction (cf DynamicModel.h)
     float health;
     Cinetique * cinetique;
     float * orderMotorLeft;
@@ -19,6 +16,7 @@ class Simulator
 public:
     Simulator(float size, float mass, float maxAcc, float maxSpeed
             , Cinetique * cinetique, float * orderMotorLeft, float * orderMotorRight, float health=1);
+    Simulator(DynamicModel model, Cinetique * cinetique, float * orderMotorLeft, float * orderMotorRight, float health=1);
     Simulator(){}
     void updateCinetique(float dt);
 };
@@ -1,3 +1,4 @@
+#if !defined(TUNER) && !defined(BENCH) && !defined(STRATEGY)
 // =============================
 // ===       Libraries       ===
 // =============================
@@ -13,17 +14,24 @@
 #include "Sequence.h"
 #include "RobotSimu.h"
 #include "ErrorManager.h"
+#include "Profiler.h"
+#include "Clock.h"
+#include "Scheduler.h"
+#include "Memory.h"
+#include <new>
 
-#define FREQUENCY 1.0
+#define FREQUENCY 1.0 //Odometrie, asservissement et sequences (les autres taches ont leur propre periode, cf Robot::registerTasks)
+#define TASK_LOGS_PERIOD 1000 // [...] = us, vidage de l'anneau des logs sur l'USB
 
 Robot *bender;
-uint32_t currentMillis = 0, lastMillis = 0;
+static uint8_t benderStorage[sizeof(Robot)] __attribute__((aligned(8))); //Le robot est construit dans .bss (placement new) : pas de tas
 #ifdef STM32BOTH
 HardwareSerial Serial1(PA10, PA9);
 #endif
 uint32_t topWarn;
-uint32_t moy;
-uint32_t compteur=0;
+LogBuffer usbLog(&Serial); //Logs et telemetrie : la boucle de controle n'attend jamais le port serie
+
+static void drainLogs(void *buffer, float dt) { ((LogBuffer *)buffer)->drain(); }
 
 void setup()
 {
@@ -34,33 +42,41 @@ void setup()
   Serial4.begin(115200);  //esp 32
   
   delay(500);
-  Logger::setup(&Serial, &Serial, &Serial, true, true, true  );
+  Logger::setup(&usbLog, &usbLog, &usbLog, true, true, true  );
+  Logger::setPolicy(INFO_LOG, BLOCK); //Rien ne se perd pendant le boot
   ErrorManager::setup();
+  PROFILE_SETUP();
   delay(10000);
-  Logger::infoln("REBOOT%"); //Le caractère % permet de faire sauter le parsing en cours sur la station sol
-  Logger::infoln("Bender's booting up");
-  bender = new Robot(0.22,1.20,0,&Serial,&Serial2,&Serial4);
+  LOG_INFOLN("REBOOT%"); //Le caractère % permet de faire sauter le parsing en cours sur la station sol
+  LOG_INFOLN("Bender's booting up");
+  Memory::print("boot");
+  bender = new (benderStorage) Robot(0.22,1.20,0,&Serial,&Serial2,&Serial4);
   //bender=new RobotSimu(0.22,1.20,0,&Serial,&Serial2);
   bender->setTeamColor(TeamColor::BLEU);
-  Logger::infoln("Hello, I'm bender");
-  topWarn=millis();
+  bender->registerTasks(1000000 / FREQUENCY);
+  Scheduler::add("logs", drainLogs, &usbLog, TASK_LOGS_PERIOD, 200, 9);
+  bender->memoryReport();
+  Memory::print("setup");
+  Logger::setPolicy(INFO_LOG, DROP_NEWEST); //Pendant le match, un message qui ne rentre pas est compté et abandonné
+  LOG_INFOLN("Hello, I'm bender");
+  topWarn=Clock::millis();
 }
 
 void loop()
 {
-  currentMillis = millis();
+  Scheduler::run();
 
-  if (currentMillis-topWarn>25000) //Affichage toute les 25 seconde de la freq moyenne
+  if (Clock::millis()-topWarn>25000) //Affichage toute les 25 seconde des statistiques des taches et de la RAM (doit rester celle de setup)
   {
-    Logger::infoln("Actual Frequency: "+String(1000.0/moy*compteur)+" Hz");
-    topWarn=millis();
+    Scheduler::print();
+    Memory::print("match");
+    ErrorManager::print();
+    Logger::infoln("logs : dropped T ", usbLog.droppedMessages[TELEMETRY_LOG], " I ", usbLog.droppedMessages[INFO_LOG], " D ", usbLog.droppedMessages[DEBUG_LOG],
+                   " evicted ", usbLog.evictedMessages, " high water ", usbLog.highWater, "/", LOG_BUFFER_SIZE);
+    usbLog.resetStats();
+    Scheduler::resetStats();
+    topWarn=Clock::millis();
   }
+}
 
-  if ((currentMillis - lastMillis) / 1e3 >= 1.0 / FREQUENCY)
-  {
-    moy+=(currentMillis - lastMillis);
-    compteur++;
-    bender->Update(1.0 / FREQUENCY);
-    lastMillis = currentMillis;
-  }
-}
\ No newline at end of file
+#endif
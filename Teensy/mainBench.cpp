@@ -0,0 +1,716 @@
+#ifdef BENCH
+/**   Main bot teensy 3.5 - controller bench
+ *
+ *  Compare the tracking error (and compute time) of the single position loop, the cascaded controller
+ *  and the predictive controller on the simulator
+ *  Then compare the reconvergence of the PID and of the Ramsete law when the robot starts away from the ghost
+ *  Then repeat moves on a robot heavier than its model, with iterative learning control
+ *  Then check that the online motor identification converges on worn motors (health < 1)
+ *  Then compare the throughput of the binary range sensor parser with the former String parser
+ *  Then measure the cost of the debug logs of a tick when debug is disabled (runtime check vs LOG_ macros)
+ *  Then compare the String formatting of the logs with the Logger parts (time, heap allocations, and heap state on the teensy)
+ *  Then check that the logs never wait on a saturated port through a LogBuffer (drops, whole lines)
+ *  Then compare the bytes and time of the text logs of a tick with the binary frames (-DLOG_BINARY)
+ *  Then measure the error bus : raise cost, subscribers reading at their own pace, deferred reactions, bursts
+ *  Then compare a strategy stored as arena actions and as bytecode, and the cost of checking an uploaded program
+ *  Then run the same sequences polled at every tick and woken on events only (same actions done, fewer updates)
+ *  Finally measure the update of 6 full sequences built in an ActionPool
+ *  Build with the env teensy35_bench (platformio.ini)
+*/
+// =============================
+// ===       Libraries       ===
+// =============================
+#include "Arduino.h"
+#include "Logger.h"
+#include "ErrorManager.h"
+#include "MoveProfile.h"
+#include "HeadlessSim.h"
+#include "Robot.h"
+#include "RangeSensors.h"
+#include "BufferStream.h"
+#include "Memory.h"
+#include "Program.h"
+#include "Functions.h"
+#include "Sequence.h"
+#include "Wakeups.h"
+#include "Communication.h"
+#include <initializer_list>
+
+#define NB_BENCH_MOVES 5
+#define NB_OFFSET_MOVES 3
+#define NB_INNER_CALLS 10000
+#define NB_ILC_ITERATIONS 8
+#define NB_RANGE_FRAMES 400 //Tient dans BUFFER_STREAM_SIZE
+#define NB_RANGE_ROUNDS 50
+#define NB_LOG_TICKS 10000
+#define NB_ERROR_RAISES 10000
+#define NB_PROGRAM_CHECKS 1000
+#define NB_WAKE_TICKS 9000 //90 s de match a 10 ms
+#define NB_POOL_TICKS 3000
+#define BENCH_POOL_SIZE 32768 // [...] = octets, 6 sequences pleines (l'arene du robot n'y suffirait pas)
+
+HeadlessSim sim(DynamicModel(ROBOT_SIZE, ROBOT_MASS, ROBOT_MAX_ACCELERATION, ROBOT_MAX_SPEED));
+
+BenchMove moves[NB_BENCH_MOVES] = {
+    {VectorE(0.5, 1.0, 0.0), VectorE(1.0, 1.0, 0.0), 0.3, false, false},     //Petit pas
+    {VectorE(0.5, 1.0, 0.0), VectorE(2.0, 1.0, 0.0), 0.3, false, false},     //Grande ligne droite
+    {VectorE(1.5, 1.0, 0.0), VectorE(1.2, 1.0, 0.0), 0.3, false, true},      //Marche arriere
+    {VectorE(0.5, 0.5, 0.0), VectorE(1.5, 1.5, PI / 2), 0.5, false, false}, //Courbe
+    {VectorE(1.5, 1.0, 0.0), VectorE(1.5, 1.0, PI / 2), 0.0, true, false}};  //Rotation
+
+BenchMove offsetMoves[NB_OFFSET_MOVES] = {
+    {VectorE(0.5, 1.0, 0.0), VectorE(1.5, 1.0, 0.0), 0.3, false, false, VectorE(0.0, 0.05, 0.0)},         //Poussé sur le coté
+    {VectorE(0.5, 1.0, 0.0), VectorE(1.5, 1.0, 0.0), 0.3, false, false, VectorE(-0.03, -0.03, 0.15)},     //Recalage raté
+    {VectorE(0.5, 0.5, 0.0), VectorE(1.5, 1.5, PI / 2), 0.5, false, false, VectorE(0.0, 0.04, -0.1)}};   //Courbe
+
+void printResult(const char *name, BenchResult result)
+{
+    Logger::infoln(String(name) + " : errT " + String(result.translation.cumulError, 5) + " errR " + String(result.rotation.cumulError, 5)
+                   + " max " + String(result.maxTrackingError, 4) + " end " + String(result.finalError, 4) + " t " + String(result.duration, 2)
+                   + " cpu " + String(result.meanComputeTime, 1) + "us (max " + String(result.maxComputeTime) + "us)" + ((result.finished) ? "" : " NOT FINISHED") + ((result.pidFail) ? " PID_FAIL" : ""));
+}
+
+// Ancien parseur de Robot::Update (texte "f<int>\n" / "b<int>\n" accumulé dans une String)
+String readString;
+int legacyForward = -1, legacyBackward = -1;
+void legacyParse(Stream *port)
+{
+  while (port->available())
+  {
+    char c = port->read();
+    if (c != '\n')
+      readString += c;
+    else
+    {
+      if (readString[0] == 'f')
+      {
+        readString.remove(0, 1);
+        legacyForward = readString.toInt();
+      }
+      else if (readString[0] == 'b')
+      {
+        readString.remove(0, 1);
+        legacyBackward = readString.toInt();
+      }
+      readString = "";
+    }
+  }
+}
+
+void benchRangeSensors()
+{
+  BufferStream text, binary;
+  RangeSensors sensors(&binary);
+  uint8_t frame[RANGE_FRAME_SIZE];
+  for (int i = 0; i < NB_RANGE_FRAMES; i++)
+  {
+    uint16_t distance = 100 + (i * 37) % 1900;
+    text.print((i % 2 == 0) ? 'f' : 'b');
+    text.print(distance);
+    text.print('\n');
+    encodeRangeFrame(frame, i % 2, distance, i * 10);
+    binary.write(frame, RANGE_FRAME_SIZE);
+  }
+
+  uint32_t start = micros();
+  for (int round = 0; round < NB_RANGE_ROUNDS; round++)
+  {
+    text.rewind();
+    legacyParse(&text);
+  }
+  float legacyTime = (micros() - start) * 1000.0 / (NB_RANGE_ROUNDS * NB_RANGE_FRAMES);
+
+  start = micros();
+  for (int round = 0; round < NB_RANGE_ROUNDS; round++)
+  {
+    binary.rewind();
+    while (binary.available() > 0)
+      sensors.update();
+  }
+  float binaryTime = (micros() - start) * 1000.0 / (NB_RANGE_ROUNDS * NB_RANGE_FRAMES);
+  Logger::infoln("Range link : String " + String(legacyTime, 1) + " ns/frame, binary " + String(binaryTime, 1) + " ns/frame ("
+                 + String(sensors.nbFrames) + " frames, forward " + String(sensors.getRange(FORWARD_SECTOR)) + "/" + String(legacyForward) + ")");
+
+  //Liaison bruitée : un octet parasite toutes les 3 trames, un octet inversé toutes les 5 trames
+  binary.clear();
+  RangeSensors noisy(&binary);
+  int nbCorrupted = 0;
+  for (int i = 0; i < NB_RANGE_FRAMES; i++)
+  {
+    encodeRangeFrame(frame, i % RANGE_NB_SENSORS, 500, i);
+    if (i % 5 == 0)
+    {
+      frame[2 + i % (RANGE_FRAME_SIZE - 2)] ^= 0xFF;
+      nbCorrupted++;
+    }
+    binary.write(frame, RANGE_FRAME_SIZE);
+    if (i % 3 == 0)
+      binary.write((i % 2 == 0) ? RANGE_SYNC_0 : 0x42);
+  }
+  while (binary.available() > 0)
+    noisy.update();
+  Logger::infoln("Range link with noise : " + String(noisy.nbFrames) + "/" + String(NB_RANGE_FRAMES - nbCorrupted) + " valid frames, "
+                 + String(noisy.nbChecksumErrors) + " rejected");
+}
+
+// Logs de debug d'un tick ou un message arrive et une action se termine (Communication::update x2, Sequence::update)
+void benchLogs()
+{
+  volatile int available = 6, id = 3, index = 2;
+  uint32_t start = micros();
+  for (int i = 0; i < NB_LOG_TICKS; i++)
+  {
+    Logger::debugln(String(available) + " bytes available");
+    Logger::debugln("received ID " + String(id));
+    Logger::debugln("Action " + String(index) + " succeded !");
+  }
+  float runtimeTime = (micros() - start) * 1000.0 / NB_LOG_TICKS;
+
+  start = micros();
+  for (int i = 0; i < NB_LOG_TICKS; i++)
+  {
+    LOG_DEBUGLN(available, " bytes available");
+    LOG_DEBUGLN("received ID ", id);
+    LOG_DEBUGLN("Action ", index, " succeded !");
+  }
+  float macroTime = (micros() - start) * 1000.0 / NB_LOG_TICKS;
+  Logger::infoln("Debug logs disabled : runtime check ", decimals(runtimeTime, 1), " ns/tick, LOG_DEBUGLN ", decimals(macroTime, 1), " ns/tick");
+}
+
+static uint32_t nbAllocations = 0; //Compté sur PC seulement (la String de host/ alloue comme celle d'Arduino)
+#ifndef __arm__
+#include <new>
+#include <cstdlib>
+void *operator new(size_t size)
+{
+  nbAllocations++;
+  void *out = malloc(size);
+  if (out == nullptr)
+    throw std::bad_alloc();
+  return out;
+}
+void operator delete(void *pointer) noexcept { free(pointer); }
+void operator delete(void *pointer, size_t) noexcept { free(pointer); }
+#endif
+
+// Telemetrie d'un tick (Cinetique::toTelemetry du robot) avec les logs actifs, vers un port qui jette tout
+void benchTelemetryFormatting()
+{
+  BufferStream sink;
+  Logger::setup(&sink, &sink, &sink, true, true, false);
+  Cinetique robot(1.2345, 0.6789, 1.5708, 0.4321, -0.1234);
+  volatile uint32_t allocationsStart = nbAllocations;
+#ifdef MEMORY_MEASURED
+  MemoryStatus before = Memory::status();
+#endif
+  uint32_t start = micros();
+  for (int i = 0; i < NB_LOG_TICKS; i++)
+  {
+    sink.clear();
+    String prefix = "R";
+    Logger::toTelemetry((prefix + "x").c_str(), String(robot._x, 3)); //Ancien Cinetique::toTelemetry
+    Logger::toTelemetry((prefix + "y").c_str(), String(robot._y, 3));
+    Logger::toTelemetry((prefix + "Th").c_str(), String(robot._theta, 3));
+    Logger::toTelemetry((prefix + "v").c_str(), String(robot._v, 3));
+    Logger::toTelemetry((prefix + "w").c_str(), String(robot._w, 3));
+  }
+  float stringTime = (micros() - start) * 1000.0 / NB_LOG_TICKS;
+  uint32_t stringAllocations = nbAllocations - allocationsStart;
+#ifdef MEMORY_MEASURED
+  MemoryStatus afterString = Memory::status();
+#endif
+
+  allocationsStart = nbAllocations;
+  start = micros();
+  for (int i = 0; i < NB_LOG_TICKS; i++)
+  {
+    sink.clear();
+    robot.toTelemetry("R");
+  }
+  float partsTime = (micros() - start) * 1000.0 / NB_LOG_TICKS;
+  uint32_t partsAllocations = nbAllocations - allocationsStart;
+#ifdef MEMORY_MEASURED
+  MemoryStatus afterParts = Memory::status();
+#endif
+
+  Logger::setup(&Serial, &Serial, &Serial, false, true, false);
+  Logger::infoln("Telemetry tick : String ", decimals(stringTime, 1), " ns (", stringAllocations / (float)NB_LOG_TICKS, " allocations), parts ",
+                 decimals(partsTime, 1), " ns (", partsAllocations / (float)NB_LOG_TICKS, " allocations)");
+#ifdef MEMORY_MEASURED //Le tas du PC ne dit rien de celui de la teensy
+  Logger::infoln("Heap used/holes : before ", before.heapUsed, "/", before.heapFree, ", after String ", afterString.heapUsed, "/", afterString.heapFree,
+                 ", after parts ", afterParts.heapUsed, "/", afterParts.heapFree);
+#endif
+}
+
+// Telemetrie d'un tick a travers un LogBuffer dont le port n'accepte plus rien, puis vidage par paquets de 20 octets
+void benchLogBuffer()
+{
+  BufferStream port;
+  LogBuffer ring(&port);
+  Logger::setup(&ring, &ring, &ring, true, true, false);
+  Cinetique robot(1.2345, 0.6789, 1.5708, 0.4321, -0.1234);
+  port.setRoom(0); //USB deconnecté ou HC05 saturé
+  uint32_t start = micros();
+  uint32_t worst = 0;
+  for (int i = 0; i < NB_LOG_TICKS; i++)
+  {
+    uint32_t tick = micros();
+    robot.toTelemetry("R");
+    Logger::infoln("tick ", i);
+    ring.drain();
+    worst = max(worst, (uint32_t)(micros() - tick));
+  }
+  float saturatedTime = (micros() - start) * 1000.0 / NB_LOG_TICKS;
+  uint32_t dropped = ring.droppedMessages[INFO_LOG], evicted = ring.evictedMessages;
+
+  //Le port revient : chaque drain ne doit envoyer que des lignes entieres
+  port.setRoom(20);
+  int nbDrains = 0, nbCut = 0;
+  while (ring.pending() > 0 && nbDrains < 10000)
+  {
+    uint16_t before = port.available();
+    uint16_t sent = ring.drain();
+    nbDrains++;
+    if (sent > 0)
+    {
+      for (uint16_t i = 0; i < before; i++)
+        port.read();
+      int last = -1;
+      while (port.available() > 0)
+        last = port.read();
+      if (last != '\n')
+        nbCut++;
+    }
+    port.clear();
+  }
+  //Trames binaires (LOG_BINARY) de 6 octets pleines de '\n' : drain ne doit envoyer que des trames entieres
+  LogBuffer frames(&port);
+  const uint8_t frame[6] = {0xA5, '\n', '\n', 0x00, '\n', 0x5A};
+  port.setRoom(0);
+  for (int i = 0; i < 100; i++)
+  {
+    frames.beginMessage(TELEMETRY_LOG, DROP_OLDEST);
+    frames.write(frame, sizeof(frame));
+    frames.endMessage();
+  }
+  port.setRoom(10);
+  int nbFramesCut = 0;
+  while (frames.pending() > 0 && nbDrains < 20000)
+  {
+    nbDrains++;
+    if (frames.drain() % sizeof(frame) != 0)
+      nbFramesCut++;
+    port.clear();
+  }
+
+  Logger::setup(&Serial, &Serial, &Serial, false, true, false);
+  Logger::infoln("LogBuffer on a saturated port : ", decimals(saturatedTime, 1), " ns/tick (worst ", worst, " us), info dropped ", dropped,
+                 ", telemetry evicted ", evicted, ", high water ", ring.highWater, "/", LOG_BUFFER_SIZE);
+  Logger::infoln("LogBuffer drained in ", nbDrains, " calls of 20 bytes, ", nbCut, " lines cut, ", nbFramesCut, " binary frames cut");
+}
+
+// Meme tick (telemetrie du robot + une info) en texte puis en trames binaires (ce que font les macros avec -DLOG_BINARY) : octets et temps
+void benchBinaryLogs()
+{
+  BufferStream sink;
+  Logger::setup(&sink, &sink, &sink, true, true, false);
+  Cinetique robot(1.2345, 0.6789, 1.5708, 0.4321, -0.1234);
+  const char *prefix = "R";
+  volatile int index = 2;
+  uint32_t textBytes = 0, binaryBytes = 0;
+  uint32_t start = micros();
+  for (int i = 0; i < NB_LOG_TICKS; i++)
+  {
+    sink.clear();
+    Logger::toTelemetry(prefix, "x", decimals(robot._x, 3));
+    Logger::toTelemetry(prefix, "y", decimals(robot._y, 3));
+    Logger::toTelemetry(prefix, "Th", decimals(robot._theta, 3));
+    Logger::toTelemetry(prefix, "v", decimals(robot._v, 3));
+    Logger::toTelemetry(prefix, "w", decimals(robot._w, 3));
+    Logger::infoln("Action ", index, " succeded !");
+    textBytes = sink.available();
+  }
+  float textTime = (micros() - start) * 1000.0 / NB_LOG_TICKS;
+
+  //Identifiants calculés a la compilation, comme dans les macros
+  constexpr uint32_t states[6] = {logFnv("toTelemetry:prefix,\"x\",decimals(_x,3)"), logFnv("toTelemetry:prefix,\"y\",decimals(_y,3)"),
+                                  logFnv("toTelemetry:prefix,\"Th\",decimals(_theta,3)"), logFnv("toTelemetry:prefix,\"v\",decimals(_v,3)"),
+                                  logFnv("toTelemetry:prefix,\"w\",decimals(_w,3)"), logFnv("infoln:\"Action \", index, \" succeded !\"")};
+  start = micros();
+  for (int i = 0; i < NB_LOG_TICKS; i++)
+  {
+    sink.clear();
+    Logger::binary(TELEMETRY_LOG, states[0], prefix, "x", decimals(robot._x, 3));
+    Logger::binary(TELEMETRY_LOG, states[1], prefix, "y", decimals(robot._y, 3));
+    Logger::binary(TELEMETRY_LOG, states[2], prefix, "Th", decimals(robot._theta, 3));
+    Logger::binary(TELEMETRY_LOG, states[3], prefix, "v", decimals(robot._v, 3));
+    Logger::binary(TELEMETRY_LOG, states[4], prefix, "w", decimals(robot._w, 3));
+    Logger::binary(INFO_LOG, states[5], "Action ", index, " succeded !");
+    binaryBytes = sink.available();
+  }
+  float binaryTime = (micros() - start) * 1000.0 / NB_LOG_TICKS;
+
+  Logger::setup(&Serial, &Serial, &Serial, false, true, false);
+  Logger::infoln("Logs of a tick : text ", textBytes, " bytes ", decimals(textTime, 1), " ns, binary ", binaryBytes, " bytes ",
+                 decimals(binaryTime, 1), " ns (", decimals(100.0 * (1.0 - binaryBytes / (float)textBytes), 0), "% less bytes)");
+}
+
+// Bus des erreurs : cout d'un raise, deux abonnés qui lisent tout (dont un en retard), reaction differée, rafale d'une meme erreur
+static uint32_t nbReactions = 0;
+static void countReaction(void *counter, const ErrorEvent &event) { (*(uint32_t *)counter)++; }
+
+void benchErrors()
+{
+  VirtualClock clock;
+  Clock *previousClock = Clock::get();
+  Clock::use(&clock);
+  ErrorManager::setup();
+  ErrorManager::setReaction(PID_FAIL_ERROR, countReaction, &nbReactions);
+  ErrorSubscriber fast, slow;
+  uint32_t fastSeen = 0, slowSeen = 0;
+  ErrorEvent event;
+
+  uint32_t start = micros();
+  for (int i = 0; i < NB_ERROR_RAISES; i++)
+  {
+    clock.advance(ERROR_MIN_INTERVAL); //Chaque occurrence est publiée
+    ErrorManager::raise(PID_FAIL_ERROR);
+    while (fast.poll(event))
+      fastSeen++;
+    if (i % 8 == 0) //Moins de ERROR_LOG_SIZE evenements entre deux appels : aucune reaction perdue
+      ErrorManager::dispatch();
+  }
+  float raiseTime = (micros() - start) * 1000.0 / NB_ERROR_RAISES;
+  ErrorManager::dispatch();
+  while (slow.poll(event))
+    slowSeen++;
+  Logger::infoln("Error bus : raise+poll ", decimals(raiseTime, 1), " ns, fast subscriber ", fastSeen, "/", NB_ERROR_RAISES, " (lost ", fast.lost,
+                 "), slow subscriber ", slowSeen, " (lost ", slow.lost, "), reactions ", nbReactions);
+
+  ErrorManager::reset();
+  for (int i = 0; i < 1000; i++) //Une erreur a chaque tour de 1 ms pendant 1 s
+  {
+    clock.advance(1000);
+    ErrorManager::raise(PID_FAIL_ERROR);
+  }
+  uint32_t published = 0;
+  while (fast.poll(event))
+    published++;
+  ErrorStats stats = ErrorManager::stats(PID_FAIL_ERROR);
+  Logger::infoln("Error burst : count ", stats.count, ", published ", published, ", first ", stats.first, "us last ", stats.last, "us");
+  ErrorManager::setup();
+  Clock::use(previousClock);
+}
+
+// Meme strategie (4 avances/rotations, goto, bras, attente, fonction, spin, fin) en actions dans l'arene et en bytecode,
+// puis cout de la validation et du CRC d'un programme de taille maximale (televersement)
+static uint16_t emit(uint8_t *code, uint16_t at, std::initializer_list<uint8_t> bytes)
+{
+  for (uint8_t byte : bytes)
+    code[at++] = byte;
+  return at;
+}
+
+void benchProgram()
+{
+  size_t arenaStart = Action::arenaUsed();
+  uint8_t nbActions = 0;
+  for (int i = 0; i < 4; i++)
+  {
+    new Forward_Action(5, 0.3, standard);
+    new Rotate_Action(5, PI / 2, standard);
+    nbActions += 2;
+  }
+  new Goto_Action(5, TargetVectorE(1.2, 1.7, 0, true), 0.5, standard);
+  new Send_Order_Action(BrasD_M, Sortir, 5, nullptr, true);
+  new Sleep_Action(0.5);
+  new Do_Action(setNorth);
+  new Spin_Action(10, TargetVectorE(0, 0, PI, true), fast);
+  new End_Action(false, true, true);
+  nbActions += 6;
+  size_t arenaBytes = Action::arenaUsed() - arenaStart;
+
+  static uint8_t code[PROGRAM_MAX_SIZE];
+  uint16_t size = 0;
+  for (int i = 0; i < 4; i++)
+  {
+    size = emit(code, size, {OP_FORWARD, 0x2C, 0x01, standard, 50});         //0.3 m, 5 s
+    size = emit(code, size, {OP_ROTATE, 0x22, 0x06, standard, 50});          //1570 mrad
+  }
+  size = emit(code, size, {OP_GOTO, 0xB0, 0x04, 0xA4, 0x06, 0, 0, 50, standard, PROGRAM_MIRROR, 50});
+  size = emit(code, size, {OP_SEND, 1, BrasD_M, 0, Sortir, 0, 0, 0});
+  size = emit(code, size, {OP_WAIT_MESSAGE, 1, BrasD_M, 0, 50});
+  size = emit(code, size, {OP_SLEEP, 50, 0});
+  size = emit(code, size, {OP_CALL, 5});                                     //setNorth
+  size = emit(code, size, {OP_SPIN, 0x44, 0x0C, fast, PROGRAM_MIRROR, 100});
+  size = emit(code, size, {OP_END, PROGRAM_LOCK_GHOST});
+  ProgramStatus status = Program::validate(code, size);
+  Logger::infoln("Strategy of ", nbActions, " actions : arena ", (uint32_t)arenaBytes, " bytes, bytecode ", size, " bytes (", status == PROGRAM_OK ? "valid" : "INVALID", ")");
+
+  uint16_t full = 0;
+  while (full + 11 <= PROGRAM_MAX_SIZE)
+    full = emit(code, full, {OP_GOTO, 0xB0, 0x04, 0xA4, 0x06, 0, 0, 50, standard, PROGRAM_MIRROR, 50});
+  volatile uint32_t crc = 0;
+  volatile uint16_t where = 0;
+  uint32_t start = micros();
+  for (int i = 0; i < NB_PROGRAM_CHECKS; i++)
+  {
+    code[full - 1] = i & 0x7F; //Timeout du dernier goto : empeche de sortir la validation de la boucle
+    uint16_t faulty;
+    status = Program::validate(code, full, &faulty);
+    where = where + faulty + status;
+  }
+  float validateTime = (micros() - start) / (float)NB_PROGRAM_CHECKS;
+  start = micros();
+  for (int i = 0; i < NB_PROGRAM_CHECKS; i++)
+    crc = Program::crc32(code, full);
+  float crcTime = (micros() - start) / (float)NB_PROGRAM_CHECKS;
+  Logger::infoln("Program of ", full, " bytes : validate ", decimals(validateTime, 1), " us, crc32 ", decimals(crcTime, 1), " us, upload ",
+                 (full + 2) / 3 + 2, " messages");
+}
+
+// Memes sequences (attentes, erreur, message, deux sequences en pause) evaluées a chaque tour comme avant,
+// puis seulement sur evenement (Wakeups) : les actions doivent s'enchainer pareil pour beaucoup moins d'evaluations
+static uint32_t nbDone[4];
+static void countDone0(Robot *robot) { nbDone[0]++; }
+static void countDone1(Robot *robot) { nbDone[1]++; }
+static void countDone2(Robot *robot) { nbDone[2]++; }
+static void countDone3(Robot *robot) { nbDone[3]++; }
+
+static void runSequences(bool events, Communication &communication, BufferStream &inbox, VirtualClock &clock, uint32_t &evaluations, float &tickTime)
+{
+  static Sequence sequences[__NBSEQUENCES__];
+  Wakeups::setup();
+  ErrorManager::setup();
+  memset(nbDone, 0, sizeof(nbDone));
+  for (int i = 0; i < __NBSEQUENCES__; i++)
+    sequences[i] = Sequence(i);
+  sequences[0].add(new Sleep_Action(0.5));
+  sequences[0].add(new Sleep_Action(1.5));
+  sequences[0].add(new Do_Action(countDone0));
+  sequences[1].add(new Wait_Error_Action(PID_FAIL_ERROR, 3.0));
+  sequences[1].add(new Do_Action(countDone1));
+  sequences[2].add(new Sleep_Action(20));
+  sequences[2].add(new Do_Action(countDone2));
+  sequences[3].add(new Wait_Message_Action(North_M, 4.0, &communication));
+  sequences[3].add(new Do_Action(countDone3));
+  for (int i = 0; i < __NBSEQUENCES__; i++)
+  {
+    sequences[i].add(new End_Action(true, false));
+    if (i < 4)
+      sequences[i].startSelected();
+    else
+      sequences[i].pause(false); //Comme goNorth, goSouth : attendent un resume
+  }
+
+  evaluations = 0;
+  uint32_t start = micros(); //Tour complet (stimuli identiques dans les deux cas) : un tour dure moins d'une us
+  for (int tick = 0; tick < NB_WAKE_TICKS; tick++)
+  {
+    clock.advance(10000);
+    if (tick % 700 == 350)
+      ErrorManager::raise(PID_FAIL_ERROR);
+    if (tick % 900 == 450)
+    {
+      Message north = newMessage(North_M);
+      inbox.write((const uint8_t *)&north, 6);
+    }
+    communication.update();
+
+    if (events)
+    {
+      Wakeups::collect(Clock::micros(), 0);
+      if (communication.inWaitingRx() > 0)
+        Wakeups::message(extractID(communication.peekOldestMessage()));
+      for (int8_t i = Wakeups::next(); i >= 0; i = Wakeups::next(), evaluations++)
+        sequences[i].update();
+    }
+    else
+      for (int i = 0; i < __NBSEQUENCES__; i++, evaluations++)
+        sequences[i].update();
+
+    if (communication.inWaitingRx() > 0)
+      communication.popOldestMessage();
+  }
+  tickTime = (micros() - start) * 1000.0 / NB_WAKE_TICKS;
+}
+
+void benchWakeups()
+{
+  VirtualClock clock;
+  Clock *previousClock = Clock::get();
+  Clock::use(&clock);
+  BufferStream inbox, sink;
+  Communication communication(&inbox);
+  Logger::setup(&sink, &sink, &sink, false, false, false); //"Action failed" (timeouts) dans les deux cas : hors mesure
+  uint32_t done[2][4], evaluations[2];
+  float tickTime[2];
+  for (int events = 0; events < 2; events++)
+  {
+    runSequences(events, communication, inbox, clock, evaluations[events], tickTime[events]);
+    memcpy(done[events], nbDone, sizeof(nbDone));
+  }
+  Clock::use(previousClock);
+  ErrorManager::setup();
+  Logger::setup(&Serial, &Serial, &Serial, false, true, false);
+  Logger::infoln("Sequences polled : ", evaluations[0], " updates, ", decimals(tickTime[0], 1), " ns/tick, done ", done[0][0], "/", done[0][1], "/",
+                 done[0][2], "/", done[0][3]);
+  Logger::infoln("Sequences woken  : ", evaluations[1], " updates, ", decimals(tickTime[1], 1), " ns/tick, done ", done[1][0], "/", done[1][1], "/",
+                 done[1][2], "/", done[1][3]);
+}
+
+// 6 sequences de TAILLESEQUENCE actions courantes construites dans une ActionPool : place occupée et cout d'un tour ou chaque sequence
+// evalue son action
+static uint32_t nbDoActions = 0;
+static void countDoAction(Robot *robot) { nbDoActions++; }
+
+void benchActionPool()
+{
+  static uint8_t storage[BENCH_POOL_SIZE] __attribute__((aligned(8)));
+  ActionPool pool(storage, BENCH_POOL_SIZE);
+  static Sequence sequences[__NBSEQUENCES__];
+  VirtualClock clock;
+  Clock *previousClock = Clock::get();
+  Clock::use(&clock);
+  BufferStream port, sink;
+  Communication communication(&port);
+  Logger::setup(&sink, &sink, &sink, false, false, false);
+  Wakeups::setup();
+  ErrorManager::setup();
+
+  for (int i = 0; i < __NBSEQUENCES__; i++)
+  {
+    sequences[i] = Sequence(i);
+    for (int j = 0; j < TAILLESEQUENCE - 1; j++)
+    {
+      Action *action;
+      switch ((i + j) % 5)
+      {
+      case 0:
+        action = pool.make<Sleep_Action>(0.02);
+        break;
+      case 1:
+        action = pool.make<Do_Action>(countDoAction);
+        break;
+      case 2:
+        action = pool.make<Send_Action>(newMessage(BrasD_M, Sortir, 0, 0, 0), &communication);
+        break;
+      case 3:
+        action = pool.make<Wait_Message_Action>(North_M, 0.03, &communication);
+        break;
+      default:
+        action = pool.make<Wait_Error_Action>(PID_FAIL_ERROR, 0.03);
+        break;
+      }
+      sequences[i].add(action);
+    }
+    sequences[i].add(pool.make<End_Action>(true, false));
+    sequences[i].startSelected();
+  }
+
+  uint32_t start = micros();
+  for (int tick = 0; tick < NB_POOL_TICKS; tick++)
+  {
+    clock.advance(10000);
+    for (int i = 0; i < __NBSEQUENCES__; i++)
+      sequences[i].update();
+    communication.update();
+    port.clear();
+  }
+  float updateTime = (micros() - start) * 1000.0 / NB_POOL_TICKS;
+
+  Clock::use(previousClock);
+  ErrorManager::setup();
+  Logger::setup(&Serial, &Serial, &Serial, false, true, false);
+  Logger::infoln(__NBSEQUENCES__, "x", TAILLESEQUENCE, " actions : pool ", (uint32_t)pool.used(), " bytes, update of the sequences ",
+                 decimals(updateTime, 1), " ns/tick, ", nbDoActions, " Do_Action done");
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(2000);
+  Logger::setup(&Serial, &Serial, &Serial, false, true, false);
+  ErrorManager::setup();
+  MoveProfiles::setup();
+
+  for (int i = 0; i < NB_BENCH_MOVES; i++)
+  {
+    MoveProfileName profile = (moves[i].pureRotation) ? standard : accurate;
+    Logger::infoln("Move " + String(i));
+    sim.setCascaded(false);
+    printResult("  single  ", sim.run(moves[i], profile));
+    sim.setCascaded(true);
+    printResult("  cascaded", sim.run(moves[i], profile));
+    sim.setCascaded(false);
+    MoveProfiles::setLaw(profile, MPC_LAW);
+    printResult("  mpc     ", sim.run(moves[i], profile));
+    MoveProfiles::setLaw(profile, PID_LAW);
+  }
+
+  for (int i = 0; i < NB_OFFSET_MOVES; i++)
+  {
+    Logger::infoln("Offset move " + String(i));
+    printResult("  pid     ", sim.run(offsetMoves[i], standard));
+    MoveProfiles::setLaw(standard, RAMSETE_LAW);
+    printResult("  ramsete ", sim.run(offsetMoves[i], standard));
+    MoveProfiles::setLaw(standard, PID_LAW);
+  }
+
+  sim.setPlantModel(DynamicModel(ROBOT_SIZE, 12.0, 5.0, 1.3)); //Plus lourd, moteurs plus faibles que le modele
+  for (int i = 0; i < 4; i++)
+  {
+    Logger::infoln("ILC move " + String(i));
+    MoveProfileName profile = (moves[i].pureRotation) ? standard : accurate;
+    for (int iteration = 0; iteration < NB_ILC_ITERATIONS; iteration++)
+      printResult(("  iteration " + String(iteration)).c_str(), sim.run(moves[i], profile, i));
+  }
+  sim.setPlantModel(DynamicModel(ROBOT_SIZE, ROBOT_MASS, ROBOT_MAX_ACCELERATION, ROBOT_MAX_SPEED));
+
+  sim.setHealth(0.7);
+  sim.setEstimation(true, false);
+  for (int iteration = 0; iteration < NB_ILC_ITERATIONS; iteration++)
+  {
+    BenchResult result = sim.run(moves[iteration % 4], accurate);
+    Logger::infoln("Estimation " + String(iteration) + " : gain " + String(sim.estimator.getGain(false)) + "/" + String(sim.estimator.getGain(true))
+                   + " (true " + String(0.7 * 6.5 * 9.0) + ") friction " + String(sim.estimator.getFriction(false)) + "/" + String(sim.estimator.getFriction(true))
+                   + " (true " + String(6.5 * 9.0 / 1.5) + ") errT " + String(result.translation.cumulError, 5));
+  }
+  sim.setEstimation(true, true);
+  for (int i = 0; i < 4; i++)
+  {
+    sim.setEstimation(false, false);
+    printResult(("  worn motors " + String(i)).c_str(), sim.run(moves[i], accurate));
+    sim.setEstimation(true, true);
+    printResult(("  compensated " + String(i)).c_str(), sim.run(moves[i], accurate));
+  }
+  sim.setEstimation(false, false);
+  sim.setHealth(1.0);
+
+  //Cout de la boucle interne (doit tenir largement dans 1ms)
+  VelocityLoop loop(VELOCITY_KP, VELOCITY_KI, 1 / 1.5);
+  volatile float out = 0;
+  uint32_t start = micros();
+  for (int i = 0; i < NB_INNER_CALLS; i++)
+    out = loop.compute(0.5, out, 0.001);
+  Logger::infoln("VelocityLoop::compute : " + String((micros() - start) * 1000.0 / NB_INNER_CALLS, 1) + " ns");
+
+  benchRangeSensors();
+  benchLogs();
+  benchTelemetryFormatting();
+  benchLogBuffer();
+  benchBinaryLogs();
+  benchErrors();
+  benchProgram();
+  benchWakeups();
+  benchActionPool();
+#ifdef MEMORY_MEASURED
+  Memory::print("bench");
+#endif
+}
+
+void loop()
+{
+}
+
+#endif
@@ -0,0 +1,75 @@
+#ifdef STRATEGY
+/**   Main bot teensy 3.5 - offline match strategy optimizer
+ *
+ *  Search the order of the tasks of the match (cf Strategy.h), validate the best ones on the simulator,
+ *  then print the best one for Robot::Robot and for tools/sequence_asm.py
+ *  Build with the env teensy35_strategy (platformio.ini), or on the PC with tools/host_build.py STRATEGY :
+ *  the best orders are then replayed in parallel, one process each (cf HostJobs.h)
+*/
+// =============================
+// ===       Libraries       ===
+// =============================
+#include "Arduino.h"
+#include "Logger.h"
+#include "ErrorManager.h"
+#include "MoveProfile.h"
+#include "HeadlessSim.h"
+#include "Robot.h"
+#include "Strategy.h"
+
+#define ACTUATOR(id, order) id, Actuator_Order::order, #id, #order
+#define NO_ACTUATOR __NBMESSAGES__, Actuator_Order::Sortir, "", ""
+
+//Cibles de Robot::Robot (robot bleu). Scores et temps d'actionneur estimés, a ajuster
+const StrategyTask TASKS[] = {
+    {"gobeletR1", Vector(0.300, 1.600), 2, 0.5, ACTUATOR(PinceAvD_M, Fermer)},
+    {"gobeletV1", Vector(0.445, 1.485), 2, 0.5, ACTUATOR(PinceAvG_M, Fermer)},
+    {"gobeletR2", Vector(0.445, 0.915), 2, 0.5, ACTUATOR(PinceAvD_M, Fermer)},
+    {"gobeletV2", Vector(0.300, 0.800), 2, 0.5, ACTUATOR(PinceAvG_M, Fermer)},
+    {"gobeletR3", Vector(0.670, 1.900), 2, 0.5, ACTUATOR(PinceAvD_M, Fermer)},
+    {"gobeletV3", Vector(0.965, 1.600), 2, 0.5, ACTUATOR(PinceAvG_M, Fermer)},
+    {"gobeletR4", Vector(1.100, 1.200), 2, 0.5, ACTUATOR(PinceAvD_M, Fermer)},
+    {"gobeletV4", Vector(1.270, 0.800), 2, 0.5, ACTUATOR(PinceAvG_M, Fermer)},
+    {"gobeletR5", Vector(1.605, 0.045), 2, 0.5, ACTUATOR(PinceAvD_M, Fermer)},
+    {"gobeletV5", Vector(1.665, 0.345), 2, 0.5, ACTUATOR(PinceAvG_M, Fermer)},
+    {"gobeletR6", Vector(1.935, 0.345), 2, 0.5, ACTUATOR(PinceAvD_M, Fermer)},
+    {"gobeletV6", Vector(1.995, 0.045), 2, 0.5, ACTUATOR(PinceAvG_M, Fermer)},
+    {"rack1", Vector(0.000, 1.600), 5, 2.0, ACTUATOR(PinceArr_M, Fermer)},
+    {"rack2", Vector(0.850, 2.000), 5, 2.0, ACTUATOR(PinceArr_M, Fermer)},
+    {"manche1", Vector(0.230, 0.000), 7, 1.0, ACTUATOR(BrasD_M, Sortir)}, //15 points les deux
+    {"manche2", Vector(0.635, 0.000), 7, 1.0, ACTUATOR(BrasD_M, Sortir)}};
+#define NB_TASKS (sizeof(TASKS) / sizeof(TASKS[0]))
+
+HeadlessSim sim(DynamicModel(ROBOT_SIZE, ROBOT_MASS, ROBOT_MAX_ACCELERATION, ROBOT_MAX_SPEED));
+Strategy strategy(TASKS, NB_TASKS, VectorE(0.22, 1.20, 0), Vector(0.22, 1.65), "northBase");
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(2000);
+  Logger::setup(&Serial, &Serial, &Serial, false, true, false);
+  ErrorManager::setup();
+  MoveProfiles::setup();
+
+  strategy.estimate();
+  uint32_t startSearch = micros();
+  uint32_t nbCandidates = strategy.search();
+  float searchTime = (micros() - startSearch) / 1e6;
+  Logger::infoln("Search : ", nbCandidates, " candidates in ", decimals(searchTime, 3), "s (", (uint32_t)(nbCandidates / max(searchTime, 1e-6f)), " /s)");
+
+  uint32_t startValidation = micros();
+  strategy.validate(&sim);
+
+  const StrategyResult &best = strategy.best();
+  Logger::infoln("Validation : ", decimals((micros() - startValidation) / 1e6, 2), "s on ", HostJobs::nbWorkers(), " workers, best : ", best.score, " points (", best.nbDone, "/", best.plan.size,
+                 " tasks), estimated ", best.plan.score, " points in ", decimals(best.plan.total, 1), "s, simulated ", decimals(best.time, 1), "s",
+                 best.home ? "" : " (NOT HOME)", ", program ", best.size, " bytes");
+  strategy.printCpp(best.plan);
+  strategy.printAsm(best.plan);
+}
+
+void loop()
+{
+}
+
+#endif
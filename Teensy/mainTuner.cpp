@@ -0,0 +1,45 @@
+#ifdef TUNER
+/**   Main bot teensy 3.5 - offline PID tuner
+ *
+ *  Optimise the gains of every moving profile on the simulator (cf Tuner.h)
+ *  then print the profile table to paste in MoveProfiles::setup
+ *  Build with the env teensy35_tuner (platformio.ini), or on the PC with tools/host_build.py TUNER :
+ *  the profiles are then tuned in parallel, one process per profile and axis (cf HostJobs.h)
+*/
+// =============================
+// ===       Libraries       ===
+// =============================
+#include "Arduino.h"
+#include "Logger.h"
+#include "ErrorManager.h"
+#include "MoveProfile.h"
+#include "HeadlessSim.h"
+#include "Robot.h"
+#include "Tuner.h"
+
+HeadlessSim sim(DynamicModel(ROBOT_SIZE, ROBOT_MASS, ROBOT_MAX_ACCELERATION, ROBOT_MAX_SPEED));
+Tuner tuner(&sim);
+
+const MoveProfileName PROFILES_TO_TUNE[] = {accurate, standard, fast};
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(2000);
+  Logger::setup(&Serial, &Serial, &Serial, false, true, false);
+  ErrorManager::setup();
+  MoveProfiles::setup();
+
+  for (MoveProfileName profile : PROFILES_TO_TUNE)
+    Logger::infoln("Tuning ", Tuner::profileName(profile), " (cost before : T ", decimals(tuner.evaluate(profile, true), 4), " R ", decimals(tuner.evaluate(profile, false), 4), ")");
+  uint32_t start = millis();
+  float cost = tuner.tuneAll(PROFILES_TO_TUNE, sizeof(PROFILES_TO_TUNE) / sizeof(PROFILES_TO_TUNE[0]));
+  Logger::infoln("Total cost ", decimals(cost, 4), " in ", (millis() - start) / 1000.0, "s on ", HostJobs::nbWorkers(), " workers");
+  Tuner::printProfiles();
+}
+
+void loop()
+{
+}
+
+#endif
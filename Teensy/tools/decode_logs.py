@@ -0,0 +1,117 @@
+"""Decoder of the binary logs (-DLOG_BINARY, cf Logger.h)
+
+Reads the USB stream of the teensy (or a capture), copies the text as is and replaces each binary frame
+[0xF5][id lo][id hi][length][arguments]['\n'] by the message rebuilt from the dictionary of extract_logs.py.
+Output identical to the text logs : "#..." for the infos, "@name|value" for the telemetry.
+
+python tools/decode_logs.py .pio/build/teensy35_binlog/logs_dictionary.json /dev/ttyACM0
+python tools/decode_logs.py logs_dictionary.json capture.bin > capture.txt
+"""
+
+import json
+import struct
+import sys
+
+LOG_FRAME_START = 0xF5
+LOG_FRAME_HEADER = 4
+
+
+def read_argument(payload, i):
+    """(text, next index) of the argument at payload[i], None if the payload is cut"""
+    tag = chr(payload[i])
+    if tag == "b" and i + 2 <= len(payload):
+        return str(struct.unpack_from("<b", payload, i + 1)[0]), i + 2
+    if tag == "h" and i + 3 <= len(payload):
+        return str(struct.unpack_from("<h", payload, i + 1)[0]), i + 3
+    if "A" <= tag <= "J" and i + 3 <= len(payload):
+        digits = ord(tag) - ord("A")
+        return "%.*f" % (digits, struct.unpack_from("<h", payload, i + 1)[0] / 10.0 ** digits), i + 3
+    if tag in "iuf" and i + 5 <= len(payload):
+        value = struct.unpack_from({"i": "<i", "u": "<I", "f": "<f"}[tag], payload, i + 1)[0]
+        return ("%.2f" % value if tag == "f" else str(value)), i + 5
+    if tag.isdigit() and i + 5 <= len(payload):
+        return "%.*f" % (int(tag), struct.unpack_from("<f", payload, i + 1)[0]), i + 5
+    if tag == "c" and i + 2 <= len(payload):
+        return chr(payload[i + 1]), i + 2
+    if tag == "s" and i + 2 <= len(payload) and i + 2 + payload[i + 1] <= len(payload):
+        return payload[i + 2:i + 2 + payload[i + 1]].decode("utf-8", "replace"), i + 2 + payload[i + 1]
+    return None
+
+
+def decode_frame(dictionary, identifier, payload):
+    arguments = []
+    i = 0
+    while i < len(payload):
+        argument = read_argument(payload, i)
+        if argument is None:
+            break
+        arguments.append(argument[0])
+        i = argument[1]
+
+    entry = dictionary.get("%04x" % identifier)
+    if entry is None:
+        return "#<log %04x inconnu : %s>\n" % (identifier, " ".join(arguments))
+    parts = []
+    for item in entry["items"]:
+        parts.append(item["text"] if "text" in item else (arguments.pop(0) if arguments else "?"))
+    if entry["kind"] == "infoln":
+        return "#" + "".join(parts) + "\n"
+    if entry["kind"] == "debugln":
+        return "".join(parts) + "\n"
+    if entry["kind"] == "toTelemetry":
+        return "@" + "".join(parts[:-1]) + "|" + (parts[-1] if parts else "") + "\n"
+    return "".join(parts)
+
+
+def decode(dictionary, read, write):
+    """read(n) -> bytes (b"" : end), write(str)"""
+    pending = b""
+    while True:
+        chunk = read(256)
+        if not chunk:
+            break
+        pending += chunk
+        while pending:
+            start = pending.find(bytes([LOG_FRAME_START]))
+            if start < 0:
+                write(pending.decode("utf-8", "replace"))
+                pending = b""
+                break
+            if start > 0:
+                write(pending[:start].decode("utf-8", "replace"))
+                pending = pending[start:]
+            if len(pending) < LOG_FRAME_HEADER or len(pending) < LOG_FRAME_HEADER + pending[3] + 1:
+                break  #Trame incomplete, on attend la suite
+            end = LOG_FRAME_HEADER + pending[3]
+            if pending[end] != ord("\n"):
+                write("\ufffd")  #Pas une trame (debut perdu) : on se recale sur le prochain 0xF5
+                pending = pending[1:]
+                continue
+            write(decode_frame(dictionary, pending[1] | (pending[2] << 8), pending[LOG_FRAME_HEADER:end]))
+            pending = pending[end + 1:]
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+    with open(sys.argv[1], encoding="utf-8") as file:
+        dictionary = json.load(file)
+
+    def write(text):
+        sys.stdout.write(text)
+        sys.stdout.flush()
+
+    source = sys.argv[2] if len(sys.argv) > 2 else "-"
+    if source == "-":
+        decode(dictionary, sys.stdin.buffer.read1, write)
+    elif source.startswith("/dev/") or source.upper().startswith("COM"):
+        import serial  # pyserial, deja installé avec PlatformIO
+        port = serial.Serial(source, 115200, timeout=None)
+        decode(dictionary, lambda n: port.read(max(1, min(n, port.in_waiting))), write)
+    else:
+        with open(source, "rb") as file:
+            decode(dictionary, file.read, write)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,209 @@
+"""Dictionary of the binary logs (-DLOG_BINARY, cf Logger.h)
+
+Finds every LOG_DEBUG / LOG_DEBUGLN / LOG_INFOLN / LOG_TELEMETRY of the firmware, computes its 16 bit identifier
+exactly like the logHash of Logger.h (FNV-1a of "function:" + raw text of the arguments, as stringified by the
+preprocessor) and writes identifier -> format in a JSON file read by decode_logs.py.
+A LOG_TELEMETRY whose name starts with a parameter (Vector::toTelemetry(prefix)) gets one entry per prefix : the firmware
+hashes the prefix into the identifier (text + LOG_NAME_SEPARATOR + prefix). The prefixes are the literals passed to the
+toTelemetry("R") methods of the sources.
+Two different messages with the same identifier stop the build : reword one of them.
+
+PlatformIO : extra_scripts = pre:tools/extract_logs.py (writes $BUILD_DIR/logs_dictionary.json)
+By hand    : python tools/extract_logs.py logs_dictionary.json . ../Libraries_shared
+"""
+
+import json
+import os
+import re
+import sys
+
+MACROS = {"LOG_DEBUGLN": "debugln", "LOG_DEBUG": "debug", "LOG_INFOLN": "infoln", "LOG_TELEMETRY": "toTelemetry"}
+MACRO_REGEX = re.compile(r"\b(LOG_DEBUGLN|LOG_DEBUG|LOG_INFOLN|LOG_TELEMETRY)\s*\(")
+LITERALS_REGEX = re.compile(r'^(\s*"(?:[^"\\]|\\.)*"\s*)+$')
+PREFIX_REGEX = re.compile(r'\btoTelemetry\s*\(\s*("(?:[^"\\]|\\.)*")\s*\)')
+NAME_SEPARATOR = "@"  # LOG_NAME_SEPARATOR of Logger.h
+ESCAPES = {"n": "\n", "t": "\t", "r": "\r", "0": "\0", "\\": "\\", '"': '"', "'": "'"}
+
+
+def strip_comments(source):
+    """Comments become a space, like in the preprocessor (strings and chars are kept)"""
+    out = []
+    i = 0
+    while i < len(source):
+        c = source[i]
+        if c in "\"'":
+            j = i + 1
+            while j < len(source) and source[j] != c:
+                j += 2 if source[j] == "\\" else 1
+            out.append(source[i:j + 1])
+            i = j + 1
+        elif source.startswith("//", i):
+            j = source.find("\n", i)
+            i = len(source) if j < 0 else j
+            out.append(" ")
+        elif source.startswith("/*", i):
+            j = source.find("*/", i + 2)
+            i = len(source) if j < 0 else j + 2
+            out.append(" ")
+        else:
+            out.append(c)
+            i += 1
+    return "".join(out)
+
+
+def scan(text, start, stop_chars):
+    """Index of the first character of stop_chars at depth 0 from start (strings and chars skipped)"""
+    depth = 0
+    i = start
+    while i < len(text):
+        c = text[i]
+        if c in "\"'":
+            j = i + 1
+            while j < len(text) and text[j] != c:
+                j += 2 if text[j] == "\\" else 1
+            i = j + 1
+            continue
+        if depth == 0 and c in stop_chars:
+            return i
+        if c in "([{":
+            depth += 1
+        elif c in ")]}":
+            depth -= 1
+        i += 1
+    return len(text)
+
+
+def stringify(arguments):
+    """Text of #__VA_ARGS__ : each run of white space between tokens becomes one space, none at the ends"""
+    out = []
+    i = 0
+    while i < len(arguments):
+        c = arguments[i]
+        if c in "\"'":
+            j = i + 1
+            while j < len(arguments) and arguments[j] != c:
+                j += 2 if arguments[j] == "\\" else 1
+            out.append(arguments[i:j + 1])
+            i = j + 1
+        elif c.isspace():
+            while i < len(arguments) and arguments[i].isspace():
+                i += 1
+            out.append(" ")
+        else:
+            out.append(c)
+            i += 1
+    return "".join(out).strip()
+
+
+def log_hash(text):
+    value = 2166136261
+    for byte in text.encode("utf-8"):
+        value = ((value ^ byte) * 16777619) & 0xFFFFFFFF
+    return (value ^ (value >> 16)) & 0xFFFF
+
+
+def unescape(literals):
+    out = []
+    for literal in re.findall(r'"((?:[^"\\]|\\.)*)"', literals):
+        i = 0
+        while i < len(literal):
+            if literal[i] == "\\" and i + 1 < len(literal):
+                out.append(ESCAPES.get(literal[i + 1], literal[i + 1]))
+                i += 2
+            else:
+                out.append(literal[i])
+                i += 1
+    return "".join(out)
+
+
+def split_items(arguments):
+    items = []
+    start = 0
+    while start < len(arguments):
+        end = scan(arguments, start, ",")
+        items.append(arguments[start:end].strip())
+        start = end + 1
+    out = []
+    for item in items:
+        name_value = re.match(r"^nameValue\s*\((.*)\)$", item)
+        if name_value:
+            out.append({"text": name_value.group(1).strip() + "= "})
+            out.append({"arg": name_value.group(1).strip()})
+        elif LITERALS_REGEX.match(item):
+            out.append({"text": unescape(item)})
+        else:
+            out.append({"arg": item})
+    return out
+
+
+def add_entry(dictionary, identifier, entry):
+    if identifier in dictionary:
+        if dictionary[identifier]["source"] != entry["source"]:
+            raise ValueError("log id %s collision : %s (%s) and %s" % (identifier, entry["source"], entry["where"], dictionary[identifier]["source"]))
+        return
+    dictionary[identifier] = entry
+
+
+def extract(directories):
+    dictionary = {}
+    messages = []
+    prefixes = set()
+    for directory in directories:
+        for root, _, files in os.walk(directory):
+            if ".pio" in root:
+                continue
+            for name in sorted(files):
+                if not name.endswith((".cpp", ".h", ".ino")):
+                    continue
+                path = os.path.join(root, name)
+                with open(path, encoding="utf-8", errors="replace") as file:
+                    source = strip_comments(file.read().replace("\\\n", ""))
+                prefixes.update(unescape(literal) for literal in PREFIX_REGEX.findall(source))
+                for match in MACRO_REGEX.finditer(source):
+                    line_start = source.rfind("\n", 0, match.start()) + 1
+                    if source[line_start:match.start()].lstrip().startswith("#"):
+                        continue  # Definition de la macro
+                    end = scan(source, match.end(), ")")
+                    arguments = stringify(source[match.end():end])
+                    kind = MACROS[match.group(1)]
+                    where = "%s:%d" % (os.path.relpath(path), source.count("\n", 0, match.start()) + 1)
+                    messages.append((kind, arguments, where))
+
+    for kind, arguments, where in messages:
+        text = kind + ":" + arguments
+        items = split_items(arguments)
+        if kind == "toTelemetry" and items and "arg" in items[0]:
+            for prefix in sorted(prefixes):
+                named = text + NAME_SEPARATOR + prefix
+                add_entry(dictionary, "%04x" % log_hash(named), {"kind": kind, "items": [{"text": prefix}] + items[1:], "source": named, "where": where})
+        else:
+            add_entry(dictionary, "%04x" % log_hash(text), {"kind": kind, "items": items, "source": text, "where": where})
+    return dictionary
+
+
+def write(path, directories):
+    dictionary = extract(directories)
+    directory = os.path.dirname(path)
+    if directory and not os.path.isdir(directory):
+        os.makedirs(directory)
+    with open(path, "w", encoding="utf-8") as file:
+        json.dump(dictionary, file, indent=1, ensure_ascii=False, sort_keys=True)
+    print("extract_logs : %d messages -> %s" % (len(dictionary), path))
+
+
+try:
+    Import("env")  # noqa: F821 (PlatformIO)
+    project = env.subst("$PROJECT_DIR")  # noqa: F821
+    try:
+        write(os.path.join(env.subst("$BUILD_DIR"), "logs_dictionary.json"), [project, os.path.join(project, "..", "Libraries_shared")])  # noqa: F821
+    except ValueError as error:
+        sys.stderr.write("extract_logs : %s\n" % error)
+        env.Exit(1)  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        if len(sys.argv) < 3:
+            sys.exit(__doc__)
+        try:
+            write(sys.argv[1], sys.argv[2:])
+        except ValueError as error:
+            sys.exit("extract_logs : %s" % error)
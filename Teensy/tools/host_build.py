@@ -0,0 +1,57 @@
+"""Host build of the offline tools (mainTuner.cpp, mainStrategy.cpp, mainBench.cpp)
+
+Compiles the libs of Teensy/lib and Libraries_shared for the PC against the minimal Arduino core of host/
+(-DTEENSY35 -DHOST : same code paths as the Teensy, plus the multi-process jobs of HostJobs.h).
+The hardware-only libs (lidars, Encoder) are left out : the simulator does not use them.
+
+python tools/host_build.py TUNER -o tuner && ./tuner
+python tools/host_build.py STRATEGY -o strategy --run
+python tools/host_build.py BENCH -o bench --run -- -fsanitize=address
+"""
+
+import argparse
+import glob
+import os
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+TEENSY = os.path.dirname(HERE)
+SHARED = os.path.normpath(os.path.join(TEENSY, "..", "Libraries_shared"))
+HOST = os.path.join(TEENSY, "host")
+
+MAINS = {"TUNER": "mainTuner.cpp", "STRATEGY": "mainStrategy.cpp", "BENCH": "mainBench.cpp"}
+HARDWARE_ONLY = ["LIDAR.cpp", "RPLidar.cpp", "Encoder.cpp"]
+
+
+def sources():
+    files = sorted(glob.glob(os.path.join(SHARED, "*", "*.cpp")) + glob.glob(os.path.join(TEENSY, "lib", "*", "*.cpp")))
+    return [path for path in files if os.path.basename(path) not in HARDWARE_ONLY]
+
+
+def includes():
+    dirs = [HOST] + sorted(glob.glob(os.path.join(SHARED, "*"))) + sorted(glob.glob(os.path.join(TEENSY, "lib", "*")))
+    return ["-I" + path for path in dirs if os.path.isdir(path)]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Host build of the offline tools")
+    parser.add_argument("tool", choices=sorted(MAINS))
+    parser.add_argument("-o", "--output", default=None, help="binary (default : the tool name in lower case)")
+    parser.add_argument("--run", action="store_true", help="run the binary once built")
+    args, flags = parser.parse_known_args()  # Extra compiler flags, after --
+    if flags[:1] == ["--"]:
+        flags = flags[1:]
+
+    output = args.output or args.tool.lower()
+    command = [os.environ.get("CXX", "g++"), "-std=gnu++14", "-O2", "-DTEENSY35", "-DHOST", "-D" + args.tool]
+    command += includes() + sources() + [os.path.join(TEENSY, MAINS[args.tool]), os.path.join(HOST, "host.cpp")]
+    command += flags + ["-o", output]
+    if subprocess.call(command) != 0:
+        sys.exit("host_build : compilation failed")
+    if args.run:
+        sys.exit(subprocess.call([os.path.abspath(output)]))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,243 @@
+"""Assembler and uploader of the sequence programs (cf lib/LesInseparables/Program.h)
+
+One instruction per line, '#' starts a comment, "name:" defines a label. Distances in m, angles in rad (or "90deg"),
+durations in s. Names (profiles, messages, orders, sequences, errors, functions) are read from the firmware sources.
+
+    end [lock]
+    goto X Y THETA PROFILE [curve=0.1] [timeout=5] [backward] [mirror]
+    spin THETA PROFILE [timeout=5] [mirror]
+    forward|backward DIST PROFILE [timeout=5]
+    rotate DTHETA PROFILE [timeout=5]
+    brake [timeout=5]
+    sleep SECONDS
+    send comm|actu MESSAGE [DATA|ORDER]
+    wait_message comm|actu MESSAGE [timeout=5]
+    wait_error ERROR [timeout=5]
+    wait_tirette PIN
+    call FUNCTION
+    pause SEQUENCE [lock]
+    resume SEQUENCE
+    set|add VARIABLE VALUE
+    jump LABEL
+    jump_if VARIABLE ==|!=|<|<=|>|>= VALUE LABEL
+    jump_failed LABEL
+
+python tools/sequence_asm.py strategy.txt -o strategy.bin
+python tools/sequence_asm.py strategy.txt --upload /dev/ttyACM0 --sequence mainSequenceName --store --run
+"""
+
+import argparse
+import math
+import os
+import re
+import struct
+import sys
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+TEENSY = os.path.dirname(HERE)
+SHARED = os.path.join(TEENSY, "..", "Libraries_shared")
+PROGRAM_H = os.path.join(TEENSY, "lib", "LesInseparables", "Program.h")
+PROGRAM_CPP = os.path.join(TEENSY, "lib", "LesInseparables", "Program.cpp")
+
+COMPARES = ["==", "!=", "<", "<=", ">", ">="]
+STATUS = ["OK", "TOO_BIG", "BAD_OPCODE", "TRUNCATED", "BAD_JUMP", "BAD_OPERAND", "BAD_CRC", "LOST_CHUNK", "NO_UPLOAD"]
+FLAGS = {"mirror": 0x01, "backward": 0x02, "lock": 0x01}
+
+
+def read(path):
+    with open(path, encoding="utf-8") as file:
+        return re.sub(r"//[^\n]*", "", file.read())
+
+
+def enum(path, name):
+    """Values of an enum of the firmware : {name: value}"""
+    body = re.search(r"enum\s+" + name + r"\b[^{]*\{([^}]*)\}", read(path)).group(1)
+    out = {}
+    value = 0
+    for item in body.split(","):
+        item = item.strip()
+        if not item:
+            continue
+        if "=" in item:
+            item, value = item.split("=")[0].strip(), int(item.split("=")[1], 0)
+        out[item] = value
+        value += 1
+    return out
+
+
+class Assembler:
+    def __init__(self):
+        self.opcodes = enum(PROGRAM_H, "Opcode")
+        source = read(PROGRAM_CPP)
+        sizes = re.search(r"operandSizes\[[^\]]*\]\s*=\s*\{([^}]*)\}", source).group(1)
+        self.sizes = [int(size) for size in sizes.split(",")]
+        functions = re.search(r"programFunctions\[\]\s*=\s*\{([^}]*)\}", source).group(1)
+        self.functions = {name.strip(): i for i, name in enumerate(functions.split(","))}
+        self.profiles = enum(os.path.join(SHARED, "Enums", "MoveProfile.h"), "MoveProfileName")
+        self.messages = enum(os.path.join(SHARED, "Enums", "MessageID.h"), "MessageID")
+        self.orders = enum(os.path.join(SHARED, "Enums", "MessageID.h"), "Actuator_Order")
+        self.sequences = enum(os.path.join(SHARED, "Enums", "SequenceName.h"), "SequenceName")
+        self.errors = enum(os.path.join(TEENSY, "lib", "ErrorManager", "ErrorManager.h"), "Error")
+
+    @staticmethod
+    def name(table, word, what):
+        if word in table:
+            return table[word]
+        if re.match(r"^-?\d+$", word):
+            return int(word)
+        raise ValueError("unknown %s '%s'" % (what, word))
+
+    @staticmethod
+    def angle(word):
+        return math.radians(float(word[:-3])) if word.endswith("deg") else float(word)
+
+    def instruction(self, words, labels):
+        """(opcode name, operand bytes) of a line. labels : None during the first pass"""
+        keys = dict(word.split("=") for word in words[1:] if "=" in word)
+        flags = sum(FLAGS[word] for word in words[1:] if word in FLAGS)
+        args = [word for word in words[1:] if "=" not in word and word not in FLAGS]
+        timeout = min(255, int(round(float(keys.get("timeout", 0)) * 10)))
+        mm = lambda word: struct.pack("<h", int(round(float(word) * 1000)))
+        mrad = lambda word: struct.pack("<h", int(round(self.angle(word) * 1000)))
+        profile = lambda word: self.name(self.profiles, word, "profile")
+        port = lambda word: {"comm": 0, "actu": 1}[word]
+        target = lambda word: struct.pack("<H", labels[word] if labels is not None else 0)
+        op = words[0]
+
+        if op == "end":
+            return "OP_END", bytes([flags])
+        if op == "goto":
+            curve = int(round(float(keys.get("curve", 0.1)) * 100))
+            return "OP_GOTO", mm(args[0]) + mm(args[1]) + mrad(args[2]) + bytes([curve, profile(args[3]), flags, timeout])
+        if op == "spin":
+            return "OP_SPIN", mrad(args[0]) + bytes([profile(args[1]), flags, timeout])
+        if op in ("forward", "backward"):
+            return "OP_" + op.upper(), mm(args[0]) + bytes([profile(args[1]), timeout])
+        if op == "rotate":
+            return "OP_ROTATE", mrad(args[0]) + bytes([profile(args[1]), timeout])
+        if op == "brake":
+            return "OP_BRAKE", bytes([timeout])
+        if op == "sleep":
+            return "OP_SLEEP", struct.pack("<H", int(round(float(args[0]) * 100)))
+        if op == "send":
+            data = 0
+            if len(args) > 2:
+                data = self.orders[args[2]] if args[2] in self.orders else int(args[2], 0)
+            return "OP_SEND", bytes([port(args[0])]) + struct.pack("<Hi", self.name(self.messages, args[1], "message"), data)
+        if op == "wait_message":
+            return "OP_WAIT_MESSAGE", bytes([port(args[0])]) + struct.pack("<H", self.name(self.messages, args[1], "message")) + bytes([timeout])
+        if op == "wait_error":
+            return "OP_WAIT_ERROR", bytes([self.name(self.errors, args[0], "error"), timeout])
+        if op == "wait_tirette":
+            return "OP_WAIT_TIRETTE", bytes([int(args[0])])
+        if op == "call":
+            return "OP_CALL", bytes([self.name(self.functions, args[0], "function")])
+        if op == "pause":
+            return "OP_PAUSE_SEQ", bytes([self.name(self.sequences, args[0], "sequence"), flags])
+        if op == "resume":
+            return "OP_RESUME_SEQ", bytes([self.name(self.sequences, args[0], "sequence")])
+        if op in ("set", "add"):
+            return "OP_" + op.upper(), bytes([int(args[0])]) + struct.pack("<h", int(args[1]))
+        if op == "jump":
+            return "OP_JUMP", target(args[0])
+        if op == "jump_if":
+            return "OP_JUMP_IF", bytes([int(args[0]), COMPARES.index(args[1])]) + struct.pack("<h", int(args[2])) + target(args[3])
+        if op == "jump_failed":
+            return "OP_JUMP_FAILED", target(args[0])
+        raise ValueError("unknown instruction '%s'" % op)
+
+    def assemble(self, text):
+        lines = []
+        for number, line in enumerate(text.splitlines(), 1):
+            line = line.split("#")[0].strip()
+            while re.match(r"^\w+:", line):
+                label, line = line.split(":", 1)
+                lines.append((number, label, None))
+                line = line.strip()
+            if line:
+                lines.append((number, None, line.split()))
+
+        labels, address = {}, 0
+        for number, label, words in lines:  #1er passage : adresses des etiquettes
+            if label is not None:
+                labels[label] = address
+            else:
+                address += 1 + len(self.instruction(words, None)[1])
+        out = bytearray()
+        for number, label, words in lines:
+            if words is None:
+                continue
+            try:
+                opcode, operands = self.instruction(words, labels)
+            except (ValueError, IndexError, KeyError) as error:
+                raise ValueError("line %d : %s (%s)" % (number, " ".join(words), error))
+            if len(operands) != self.sizes[self.opcodes[opcode]]:
+                raise ValueError("line %d : %s has %d operand bytes, the firmware expects %d" % (number, opcode, len(operands), self.sizes[self.opcodes[opcode]]))
+            out += bytes([self.opcodes[opcode]]) + operands
+        return bytes(out)
+
+
+def crc32(data):
+    crc = 0xFFFFFFFF
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1))
+    return crc ^ 0xFFFFFFFF
+
+
+def messages(assembler, code, sequence, flags):
+    """Messages of the upload (6 bytes : data int32 then id uint16, cf Communication)"""
+    message = lambda name, data: struct.pack("<4sH", data, assembler.messages[name])
+    out = [message("Program_Begin_M", struct.pack("<BHB", sequence, len(code), flags))]
+    for chunk, start in enumerate(range(0, len(code), 3)):
+        out.append(message("Program_Chunk_M", bytes([chunk & 0xFF]) + code[start:start + 3].ljust(3, b"\0")))
+    out.append(message("Program_End_M", struct.pack("<I", crc32(code))))
+    return out
+
+
+def upload(assembler, port_name, code, sequence, flags):
+    import serial  # pyserial, deja installé avec PlatformIO
+    port = serial.Serial(port_name, 115200, timeout=0.05)
+    for message in messages(assembler, code, sequence, flags):
+        port.write(message)
+        time.sleep(0.015)  #Une lecture de message par tache comm (10 ms)
+    ack = struct.pack("<H", assembler.messages["Program_Ack_M"])
+    stream, deadline = b"", time.time() + 3
+    while time.time() < deadline:
+        stream += port.read(256)
+        index = stream.find(ack)
+        if index >= 4:
+            status, where = stream[index - 4], stream[index - 3] | (stream[index - 2] << 8)
+            return "%s (instruction at %d)" % (STATUS[status], where) if status else "OK"
+    return "no acknowledgement (the logs of the USB port may hide it)"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("source")
+    parser.add_argument("-o", "--output", help="binary program")
+    parser.add_argument("--upload", metavar="PORT", help="serial port of the teensy (Communication)")
+    parser.add_argument("--sequence", default="mainSequenceName")
+    parser.add_argument("--store", action="store_true", help="keep the program in EEPROM")
+    parser.add_argument("--run", action="store_true", help="run it now")
+    args = parser.parse_args()
+
+    assembler = Assembler()
+    with open(args.source, encoding="utf-8") as file:
+        try:
+            code = assembler.assemble(file.read())
+        except ValueError as error:
+            sys.exit("sequence_asm : %s" % error)
+    print("%d bytes, CRC32 %08x" % (len(code), crc32(code)))
+    if args.output:
+        with open(args.output, "wb") as file:
+            file.write(code)
+    if args.upload:
+        sequence = assembler.name(assembler.sequences, args.sequence, "sequence")
+        print(upload(assembler, args.upload, code, sequence, (1 if args.store else 0) | (2 if args.run else 0)))
+
+
+if __name__ == "__main__":
+    main()